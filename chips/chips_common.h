@@ -83,6 +83,10 @@ void chips_audio_callback_snapshot_onload(chips_audio_callback_t* snapshot, chip
 void chips_debug_snapshot_onsave(chips_debug_t* snapshot);
 // fixup chips_debug_t snapshot after loading
 void chips_debug_snapshot_onload(chips_debug_t* snapshot, chips_debug_t* sys);
+// FNV-1a hash over a memory range (e.g. to identify ROM images), start with CHIPS_HASH_INIT
+uint32_t chips_hash(uint32_t hash, const void* ptr, size_t size);
+
+#define CHIPS_HASH_INIT (0x811C9DC5)
 
 #ifdef __cplusplus
 } // extern "C"
@@ -113,4 +117,12 @@ void chips_debug_snapshot_onload(chips_debug_t* snapshot, chips_debug_t* sys) {
     snapshot->stopped = sys->stopped;
 }
 
+uint32_t chips_hash(uint32_t hash, const void* ptr, size_t size) {
+    const uint8_t* p = (const uint8_t*) ptr;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ p[i]) * 0x01000193;
+    }
+    return hash;
+}
+
 #endif // CHIPS_IMPL
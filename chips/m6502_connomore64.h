@@ -8,6 +8,9 @@
     Part of the https://github.com/c1570/Connomore64 project
     Based on https://github.com/floooh/chips/ but modified for speed.
 
+    NOTE: this file is code-generated from m6502_connomore64.template.h and
+    m6502_gen.py in the 'codegen' directory.
+
     The original m6502.h is zlib/libpng licensed;
     m6502_connomore64.h is AGPL 3 licensed, i.e., in case you use
     this in any project, you have to make the complete sources
@@ -86,6 +86,21 @@
     m6522_reset(&sys->via);
     ~~~
 
+    The timers are event driven, a VIA which is not accessed and whose
+    input pins don't change may skip ticks entirely: if m6522_idle()
+    returns true for the input pins of the next tick, only increment
+    the tick counter instead of calling m6522_tick() (the output pins
+    stay the same):
+
+    ~~~C
+    if (m6522_idle(&sys->via, pins)) {
+        sys->via.ticks++;
+    }
+    else {
+        pins = m6522_tick(&sys->via, pins);
+    }
+    ~~~
+
     ## LINKS
 
     On timer behaviour when hitting zero:
@@ -118,6 +133,8 @@
 extern "C" {
 #endif
 
+#define HAVE_FAST_M6522H
+
 // register select same as lower 4 shared address bus bits
 #define M6522_PIN_RS0       (0)
 #define M6522_PIN_RS1       (1)
@@ -283,8 +300,6 @@ extern "C" {
 #define M6522_IRQ_ANY      (1<<7)
 
 // delay-pipeline bit offsets
-#define M6522_PIP_TIMER_COUNT   (0)
-#define M6522_PIP_TIMER_LOAD    (8)
 #define M6522_PIP_IRQ           (0)
 
 // I/O port state
@@ -302,17 +317,16 @@ typedef struct {
     bool c2_triggered;
 } m6522_port_t;
 
-// timer state
+// timer state, the counter isn't decremented each tick but computed from
+// the tick it was loaded at, see _m6522_timer_counter()
 typedef struct {
     uint16_t latch;     /* 16-bit initial value latch, NOTE: T2 only has an 8-bit latch */
-    uint16_t counter;   /* 16-bit counter */
+    uint16_t counter;   /* 16-bit counter value at tick 'base' */
+    uint32_t base;      /* tick at which the counter had the value 'counter' */
+    uint32_t event;     /* tick of the next underflow (or T1 reload) */
+    bool armed;         /* event is pending (false while T2 counts PB6 pulses) */
+    bool reload;        /* pending event is the T1 reload after underflow */
     bool t_bit;         /* toggles between true and false when counter underflows */
-    bool t_out;         /* true for 1 cycle when counter underflow */
-    /* merged delay-pipelines:
-        2-cycle 'counter active':   bits 0..7
-        1-cycle 'force load':       bits 8..16
-    */
-    uint16_t pip;
 } m6522_timer_t;
 
 // interrupt state (same as m6522_int_t)
@@ -327,11 +341,15 @@ typedef struct {
     m6522_port_t pa;
     m6522_port_t pb;
     m6522_timer_t t1;
-    // m6522_timer_t t2;
+    m6522_timer_t t2;
     m6522_int_t intr;
     uint8_t acr;        /* auxilary control register */
     uint8_t pcr;        /* peripheral control register */
     uint64_t pins;
+    uint32_t ticks;         /* number of ticks since init */
+    uint32_t count_start;   /* first tick the timers count after init/reset */
+    bool counting;          /* count_start has been reached */
+    uint32_t next_event;    /* tick of the next timer event */
     char *chip_name;
 } m6522_t;
 
@@ -356,6 +374,8 @@ void m6522_init(m6522_t* m6522);
 void m6522_reset(m6522_t* m6522);
 // tick the m6522
 uint64_t m6522_tick(m6522_t* m6522, uint64_t pins);
+// true if a tick with these input pins would only advance the tick counter
+bool m6522_idle(const m6522_t* m6522, uint64_t pins);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -382,15 +402,22 @@ static void _m6522_init_port(m6522_port_t* p) {
     p->c2_triggered = false;
 }
 
-static void _m6522_init_timer(m6522_timer_t* t, bool is_reset) {
+static uint16_t _m6522_timer_counter(const m6522_t* c, const m6522_timer_t* t);
+static void _m6522_timer_load(m6522_t* c, m6522_timer_t* t, uint16_t value, uint32_t delay);
+static void _m6522_schedule(m6522_t* c);
+
+static void _m6522_init_timer(m6522_t* c, m6522_timer_t* t, bool is_reset) {
     /* counters and latches are not initialized at reset */
     if (!is_reset) {
         t->latch = 0xFFFF;
         t->counter = 0;
         t->t_bit = false;
     }
-    t->t_out = false;
-    t->pip = 0;
+    else {
+        t->counter = _m6522_timer_counter(c, t);
+    }
+    /* counting starts 2 ticks after reset */
+    _m6522_timer_load(c, t, t->counter, 0);
 }
 
 static void _m6522_init_interrupt(m6522_int_t* intr) {
@@ -404,13 +431,16 @@ void m6522_init(m6522_t* c) {
     memset(c, 0, sizeof(*c));
     _m6522_init_port(&c->pa);
     _m6522_init_port(&c->pb);
-    _m6522_init_timer(&c->t1, false);
-    // _m6522_init_timer(&c->t2, false);
+    c->count_start = 2;
+    c->counting = false;
+    _m6522_init_timer(c, &c->t1, false);
+    _m6522_init_timer(c, &c->t2, false);
+    _m6522_schedule(c);
     _m6522_init_interrupt(&c->intr);
     c->acr = 0;
     c->pcr = 0;
     c->t1.latch = 0xFFFF;
-    // c->t2.latch = 0xFFFF;
+    c->t2.latch = 0xFFFF;
 }
 
 /*
@@ -423,10 +453,13 @@ void m6522_reset(m6522_t* c) {
     CHIPS_ASSERT(c);
     _m6522_init_port(&c->pa);
     _m6522_init_port(&c->pb);
-    _m6522_init_timer(&c->t1, true);
-    // _m6522_init_timer(&c->t2, true);
-    _m6522_init_interrupt(&c->intr);
     c->acr = 0;
+    c->count_start = c->ticks + 2;
+    c->counting = false;
+    _m6522_init_timer(c, &c->t1, true);
+    _m6522_init_timer(c, &c->t2, true);
+    _m6522_schedule(c);
+    _m6522_init_interrupt(&c->intr);
     c->pcr = 0;
     c->pins = 0;
 }
@@ -714,84 +747,179 @@ static inline void _m6522_write_ifr(m6522_t* c, uint8_t data) {
 
     (essentially: T1 is always reloaded from latch, both in continuous
     and oneshot mode, while T2 is never reloaded)
+
+    The timers are event driven: a load stores the counter value together
+    with the current tick, register reads compute the current value from
+    that, and underflows (and the T1 reload one tick later) are scheduled
+    as events. The only per-tick work is comparing the tick counter with
+    the next event, and counting PB6 pulses when T2 is in pulse mode.
+    This behaves the same as decrementing the counters in each tick
+    (with the 2-tick count delay after reset and the T1 reload delay).
 */
-static void _m6522_tick_t1(m6522_t* c) {
-    m6522_timer_t* t = &c->t1;
+static uint16_t _m6522_timer_counter_at(const m6522_timer_t* t, uint32_t tick) {
+    if (!t->armed) {
+        /* T2 counting PB6 pulses */
+        return t->counter;
+    }
+    const int32_t elapsed = (int32_t)(tick - t->base);
+    if (elapsed <= 0) {
+        return t->counter;
+    }
+    return t->counter - (uint16_t)elapsed;
+}
+
+static uint16_t _m6522_timer_counter(const m6522_t* c, const m6522_timer_t* t) {
+    return _m6522_timer_counter_at(t, c->ticks);
+}
 
-    /* decrement counter? */
-    if (_M6522_PIP_TEST(t->pip, M6522_PIP_TIMER_COUNT, 0)) {
-        t->counter--;
+static void _m6522_schedule(m6522_t* c) {
+    uint32_t dist = c->t1.event - c->ticks;
+    if (c->t2.armed && ((c->t2.event - c->ticks) < dist)) {
+        dist = c->t2.event - c->ticks;
     }
+    c->next_event = c->ticks + dist;
+}
 
-    /* timer underflow? */
-    t->t_out = (0xFFFF == t->counter);
-    if (t->t_out) {
-        /* continuous or oneshot mode? */
-        if (M6522_ACR_T1_CONTINUOUS(c)) {
-            t->t_bit = !t->t_bit;
-            /* trigger T1 interrupt on each underflow */
-            _m6522_set_intr(c, M6522_IRQ_T1);
+/* schedule the next underflow at or after tick 'from', a counter which
+   is paused at 0xFFFF (before counting starts) underflows in each paused tick
+*/
+static void _m6522_timer_schedule(m6522_timer_t* t, uint32_t from) {
+    if ((0xFFFF == t->counter) && ((int32_t)(t->base - from) > 0)) {
+        t->event = from;
+    }
+    else {
+        t->event = t->base + t->counter;
+    }
+}
+
+/* set the counter base, counting never starts before count_start
+   (NOTE: the wrapping tick counter is only compared with count_start
+   until it is reached, T1 reloads at least every 64K ticks)
+*/
+static void _m6522_timer_rebase(m6522_t* c, m6522_timer_t* t, uint16_t value, uint32_t base) {
+    t->counter = value;
+    t->base = base;
+    if (!c->counting) {
+        if ((int32_t)(c->ticks - c->count_start) >= 0) {
+            c->counting = true;
         }
-        else {
-            if (!t->t_bit) {
-                /* trigger T1 only once */
-                _m6522_set_intr(c, M6522_IRQ_T1);
-                t->t_bit = true;
-            }
+        else if ((int32_t)(t->base - c->count_start) < 0) {
+            t->base = c->count_start;
         }
-        /* reload T1 from latch on each underflow,
-           this happens both in oneshot and continous mode
+    }
+}
+
+/* load a counter which decrements starting 'delay' ticks from now */
+static void _m6522_timer_load(m6522_t* c, m6522_timer_t* t, uint16_t value, uint32_t delay) {
+    _m6522_timer_rebase(c, t, value, c->ticks + delay);
+    _m6522_timer_schedule(t, c->ticks);
+    t->armed = true;
+    t->reload = false;
+}
+
+static void _m6522_t1_underflow(m6522_t* c) {
+    m6522_timer_t* t = &c->t1;
+    /* continuous or oneshot mode? */
+    if (M6522_ACR_T1_CONTINUOUS(c)) {
+        t->t_bit = !t->t_bit;
+        /* trigger T1 interrupt on each underflow */
+        _m6522_set_intr(c, M6522_IRQ_T1);
+    }
+    else {
+        if (!t->t_bit) {
+            /* trigger T1 only once */
+            _m6522_set_intr(c, M6522_IRQ_T1);
+            t->t_bit = true;
+        }
+    }
+    /* reload T1 from latch on each underflow,
+       this happens both in oneshot and continous mode
+    */
+    t->event = c->ticks + 1;
+    t->reload = true;
+}
+
+static void _m6522_t1_event(m6522_t* c) {
+    m6522_timer_t* t = &c->t1;
+    if (t->reload) {
+        /* reload T1 from latch one tick after underflow, if the counter
+           was set to 0 in this tick (or is paused at 0xFFFF) it underflows
+           again right away
         */
-        _M6522_PIP_SET(t->pip, M6522_PIP_TIMER_LOAD, 1);
+        const bool underflow = (0xFFFF == _m6522_timer_counter_at(t, c->ticks + 1));
+        _m6522_timer_rebase(c, t, t->latch, c->ticks + 1);
+        _m6522_timer_schedule(t, c->ticks + 1);
+        t->reload = false;
+        if (underflow) {
+            _m6522_t1_underflow(c);
+        }
+    }
+    else {
+        _m6522_t1_underflow(c);
     }
+}
 
-    /* reload timer from latch? */
-    if (_M6522_PIP_TEST(t->pip, M6522_PIP_TIMER_LOAD, 0)) {
-        t->counter = t->latch;
+static void _m6522_t2_underflow(m6522_t* c) {
+    /* t2 is always oneshot */
+    if (!c->t2.t_bit) {
+        /* FIXME: 6526-style "Timer B Bug"? */
+        _m6522_set_intr(c, M6522_IRQ_T2);
+        c->t2.t_bit = true;
     }
 }
 
+static void _m6522_t2_event(m6522_t* c) {
+    m6522_timer_t* t = &c->t2;
+    _m6522_t2_underflow(c);
+    /* NOTE: T2 never reloads from latch on hitting zero, it wraps around
+       (rebase so that the elapsed ticks never overflow)
+    */
+    _m6522_timer_rebase(c, t, 0xFFFF, c->ticks + 1);
+    _m6522_timer_schedule(t, c->ticks + 1);
+}
 
-// static void _m6522_tick_t2(m6522_t* c, uint64_t pins) {
-//     m6522_timer_t* t = &c->t2;
-//
-//     /* either decrement on PB6, or on tick */
-//     if (M6522_ACR_T2_COUNT_PB6(c)) {
-//         /* count falling edge of PB6 */
-//         if (M6522_PB6 & (~pins & (pins ^ c->pins))) {
-//             t->counter--;
-//         }
-//     }
-//     else if (_M6522_PIP_TEST(t->pip, M6522_PIP_TIMER_COUNT, 0)) {
-//         t->counter--;
-//     }
-//
-//     /* underflow? */
-//     t->t_out = (0xFFFF == t->counter);
-//     if (t->t_out) {
-//         /* t2 is always oneshot */
-//         if (!t->t_bit) {
-//             /* FIXME: 6526-style "Timer B Bug"? */
-//             _m6522_set_intr(c, M6522_IRQ_T2);
-//             t->t_bit = true;
-//         }
-//         /* NOTE: T2 never reloads from latch on hitting zero */
-//     }
-// }
+static void _m6522_tick_timers(m6522_t* c) {
+    if (c->t1.event == c->ticks) {
+        _m6522_t1_event(c);
+    }
+    if (c->t2.armed && (c->t2.event == c->ticks)) {
+        _m6522_t2_event(c);
+    }
+    _m6522_schedule(c);
+}
 
-static void _m6522_tick_pipeline(m6522_t* c) {
-    /* feed counter pipelines, both counters are always counting */
-    _M6522_PIP_SET(c->t1.pip, M6522_PIP_TIMER_COUNT, 2);
-    // _M6522_PIP_SET(c->t2.pip, M6522_PIP_TIMER_COUNT, 2);
+static void _m6522_tick_t2_pb6(m6522_t* c, uint64_t pins) {
+    /* count falling edge of PB6 */
+    if (M6522_PB6 & (~pins & (pins ^ c->pins))) {
+        c->t2.counter--;
+    }
+    if (0xFFFF == c->t2.counter) {
+        _m6522_t2_underflow(c);
+    }
+}
 
+/* switch T2 between counting ticks and counting PB6 pulses */
+static void _m6522_t2_set_mode(m6522_t* c, bool count_pb6) {
+    m6522_timer_t* t = &c->t2;
+    const uint16_t counter = _m6522_timer_counter(c, t);
+    if (count_pb6) {
+        t->counter = counter;
+        t->armed = false;
+    }
+    else {
+        /* counting pauses in the tick of any ACR write which selects clock mode */
+        _m6522_timer_load(c, t, counter, 1);
+    }
+    _m6522_schedule(c);
+}
+
+static void _m6522_tick_pipeline(m6522_t* c) {
     /* interrupt pipeline */
     if (c->intr.ifr & c->intr.ier) {
         _M6522_PIP_SET(c->intr.pip, M6522_PIP_IRQ, 1);
     }
 
-    /* tick pipelines forward */
-    c->t1.pip = (c->t1.pip >> 1) & 0x7F7F;
-    // c->t2.pip = (c->t2.pip >> 1) & 0x7F7F;
+    /* tick pipeline forward */
     c->intr.pip = (c->intr.pip >> 1) & 0x7F7F;
 }
 
@@ -845,11 +973,16 @@ static uint64_t _m6522_tick(m6522_t* c, uint64_t pins) {
      _m6522_read_port_pins(c, pins);
 #endif
     _m6522_update_cab(c);
-    _m6522_tick_t1(c);
-    // _m6522_tick_t2(c, pins);
+    if (c->ticks == c->next_event) {
+        _m6522_tick_timers(c);
+    }
+    if (M6522_ACR_T2_COUNT_PB6(c)) {
+        _m6522_tick_t2_pb6(c, pins);
+    }
     pins = _m6522_update_irq(c, pins);
     pins = _m6522_write_port_pins(c, pins);
     _m6522_tick_pipeline(c);
+    c->ticks++;
     return pins;
 }
 
@@ -892,12 +1025,12 @@ static uint8_t _m6522_read(m6522_t* c, uint8_t addr) {
             break;
 
         case M6522_REG_T1CL:
-            data = c->t1.counter & 0xFF;
+            data = _m6522_timer_counter(c, &c->t1) & 0xFF;
             _m6522_clear_intr(c, M6522_IRQ_T1);
             break;
 
         case M6522_REG_T1CH:
-            data = c->t1.counter >> 8;
+            data = _m6522_timer_counter(c, &c->t1) >> 8;
             break;
 
         case M6522_REG_T1LL:
@@ -909,12 +1042,12 @@ static uint8_t _m6522_read(m6522_t* c, uint8_t addr) {
             break;
 
         case M6522_REG_T2CL:
-            data = 0; //c->t2.counter & 0xFF;
+            data = _m6522_timer_counter(c, &c->t2) & 0xFF;
             _m6522_clear_intr(c, M6522_IRQ_T2);
             break;
 
         case M6522_REG_T2CH:
-            data = 0; //c->t2.counter >> 8;
+            data = _m6522_timer_counter(c, &c->t2) >> 8;
             break;
 
         case M6522_REG_SR:
@@ -988,7 +1121,14 @@ static void _m6522_write(m6522_t* c, uint8_t addr, uint8_t data) {
             c->t1.latch = (data << 8) | (c->t1.latch & 0x00FF);
             _m6522_clear_intr(c, M6522_IRQ_T1);
             c->t1.t_bit = false;
-            c->t1.counter = c->t1.latch;
+            if (c->t1.reload && (c->t1.event == c->ticks)) {
+                /* the pending reload in this tick overrides the counter */
+                _m6522_timer_rebase(c, &c->t1, c->t1.latch, c->ticks);
+            }
+            else {
+                _m6522_timer_load(c, &c->t1, c->t1.latch, 0);
+                _m6522_schedule(c);
+            }
             break;
 
         case M6522_REG_T1LH:
@@ -997,14 +1137,20 @@ static void _m6522_write(m6522_t* c, uint8_t addr, uint8_t data) {
             break;
 
         case M6522_REG_T2CL:
-            // c->t2.latch = (c->t2.latch & 0xFF00) | data;
+            c->t2.latch = (c->t2.latch & 0xFF00) | data;
             break;
 
         case M6522_REG_T2CH:
-            // c->t2.latch = (data << 8) | (c->t2.latch & 0x00FF);
+            c->t2.latch = (data << 8) | (c->t2.latch & 0x00FF);
             _m6522_clear_intr(c, M6522_IRQ_T2);
-            // c->t2.t_bit = false;
-            // c->t2.counter = c->t2.latch;
+            c->t2.t_bit = false;
+            if (M6522_ACR_T2_COUNT_PB6(c)) {
+                c->t2.counter = c->t2.latch;
+            }
+            else {
+                _m6522_timer_load(c, &c->t2, c->t2.latch, 0);
+                _m6522_schedule(c);
+            }
             break;
 
         case M6522_REG_SR:
@@ -1014,17 +1160,8 @@ static void _m6522_write(m6522_t* c, uint8_t addr, uint8_t data) {
         case M6522_REG_ACR:
             c->acr = data;
             /* FIXME: shift timer */
-            /*
-            if (M6522_ACR_T1_CONTINUOUS(c)) {
-                // FIXME: continuous counter delay?
-                _M6522_PIP_CLR(c->t1.pip, M6522_PIP_TIMER_COUNT, 0);
-                _M6522_PIP_CLR(c->t1.pip, M6522_PIP_TIMER_COUNT, 1);
-            }
-            */
-            /* FIXME(?) this properly transitions T2 from counting PB6 to clock counter mode */
-            // if (!M6522_ACR_T2_COUNT_PB6(c)) {
-            //     _M6522_PIP_CLR(c->t2.pip, M6522_PIP_TIMER_COUNT, 0)
-            // }
+            /* FIXME: continuous counter delay? */
+            _m6522_t2_set_mode(c, M6522_ACR_T2_COUNT_PB6(c));
             break;
 
         case M6522_REG_PCR:
@@ -1072,4 +1209,33 @@ uint64_t m6522_tick(m6522_t* c, uint64_t pins) {
     return pins;
 }
 
+bool m6522_idle(const m6522_t* c, uint64_t pins) {
+    /* timer event or T2 counting PB6 pulses */
+    if ((c->ticks == c->next_event) || M6522_ACR_T2_COUNT_PB6(c)) {
+        return false;
+    }
+    /* control line edges (NOTE: _m6522_read_port_pins() stores CB2 in pa.c2_in) */
+    const bool ca1 = 0 != (pins & M6522_CA1);
+    const bool ca2 = 0 != (pins & M6522_CA2);
+    const bool cb1 = 0 != (pins & M6522_CB1);
+    const bool cb2 = 0 != (pins & M6522_CB2);
+    if ((c->pa.c1_in != ca1) || (c->pa.c2_in != ca2) || (c->pa.c2_in != cb2) ||
+        (c->pb.c1_in != cb1) || (c->pb.c2_in != cb2))
+    {
+        return false;
+    }
+    /* input registers */
+    if (!M6522_ACR_PA_LATCH_ENABLE(c) && (c->pa.inpr != M6522_GET_PA(pins))) {
+        return false;
+    }
+    if (!M6522_ACR_PB_LATCH_ENABLE(c) && (c->pb.inpr != M6522_GET_PB(pins))) {
+        return false;
+    }
+    /* interrupt pipeline, a pending interrupt keeps the pipeline at 1 */
+    if (c->intr.ifr & c->intr.ier & 0x7F) {
+        return (0 != (c->intr.ifr & (1<<7))) && (1 == c->intr.pip);
+    }
+    return 0 == c->intr.pip;
+}
+
 #endif /* CHIPS_IMPL */
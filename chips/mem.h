@@ -178,6 +178,8 @@ void mem_layer_wr(mem_t* mem, size_t layer, uint16_t addr, uint8_t data);
 
 /* convert any internal pointers to offsets (helper function for serialization) */
 void mem_snapshot_onsave(mem_t* snapshot, void* base);
+/* same, but pointers outside [base, base+size) are shared (e.g. ROM images), these are unmapped after loading and must be mapped again */
+void mem_snapshot_onsave_shared(mem_t* snapshot, void* base, size_t size);
 /* ...and the reverse */
 void mem_snapshot_onload(mem_t* snapshot, void* base);
 
@@ -350,8 +352,9 @@ void mem_layer_wr(mem_t* mem, size_t layer, uint16_t addr, uint8_t data) {
 #define MEM_SPECIAL_OFFSET_NULLPTR (-1)
 #define MEM_SPECIAL_OFFSET_UNMAPPED_PAGE (-2)
 #define MEM_SPECIAL_OFFSET_JUNK_PAGE (-3)
+#define MEM_SPECIAL_OFFSET_SHARED (-4)
 
-static void mem_ptr_to_offset(uint8_t** ptr_ptr, uint8_t* base) {
+static void mem_ptr_to_offset(uint8_t** ptr_ptr, uint8_t* base, size_t size) {
     uint8_t* ptr = *ptr_ptr;
     if (ptr == 0) {
         *ptr_ptr = (uint8_t*)(intptr_t)MEM_SPECIAL_OFFSET_NULLPTR;
@@ -362,6 +365,9 @@ static void mem_ptr_to_offset(uint8_t** ptr_ptr, uint8_t* base) {
     else if (ptr == _mem_junk_page) {
         *ptr_ptr = (uint8_t*)(intptr_t)MEM_SPECIAL_OFFSET_JUNK_PAGE;
     }
+    else if ((size > 0) && ((ptr < base) || (ptr >= (base + size)))) {
+        *ptr_ptr = (uint8_t*)(intptr_t)MEM_SPECIAL_OFFSET_SHARED;
+    }
     else {
         CHIPS_ASSERT(base <= *ptr_ptr);
         *ptr_ptr = (uint8_t*) (*ptr_ptr - base);
@@ -380,26 +386,33 @@ static void mem_offset_to_ptr(uint8_t** ptr_ptr, uint8_t* base) {
         case MEM_SPECIAL_OFFSET_JUNK_PAGE:
             *ptr_ptr = _mem_junk_page;
             break;
+        case MEM_SPECIAL_OFFSET_SHARED:
+            *ptr_ptr = _mem_unmapped_page;
+            break;
         default:
             *ptr_ptr = (base + offset);
             break;
     }
 }
 
-void mem_snapshot_onsave(mem_t* snapshot, void* base) {
+void mem_snapshot_onsave_shared(mem_t* snapshot, void* base, size_t size) {
     uint8_t* base8 = (uint8_t*)base;
     for (size_t page = 0; page < MEM_NUM_PAGES; page++) {
-        mem_ptr_to_offset(&snapshot->page_table[page].read_ptr, base8);
-        mem_ptr_to_offset(&snapshot->page_table[page].write_ptr, base8);
+        mem_ptr_to_offset(&snapshot->page_table[page].read_ptr, base8, size);
+        mem_ptr_to_offset(&snapshot->page_table[page].write_ptr, base8, size);
     }
     for (size_t layer = 0; layer < MEM_NUM_LAYERS; layer++) {
         for (size_t page = 0; page < MEM_NUM_PAGES; page++) {
-            mem_ptr_to_offset(&snapshot->layers[layer][page].read_ptr, base8);
-            mem_ptr_to_offset(&snapshot->layers[layer][page].write_ptr, base8);
+            mem_ptr_to_offset(&snapshot->layers[layer][page].read_ptr, base8, size);
+            mem_ptr_to_offset(&snapshot->layers[layer][page].write_ptr, base8, size);
         }
     }
 }
 
+void mem_snapshot_onsave(mem_t* snapshot, void* base) {
+    mem_snapshot_onsave_shared(snapshot, base, 0);
+}
+
 void mem_snapshot_onload(mem_t* snapshot, void* base) {
     uint8_t* base8 = (uint8_t*)base;
     for (size_t page = 0; page < MEM_NUM_PAGES; page++) {
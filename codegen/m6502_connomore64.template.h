@@ -0,0 +1,453 @@
+#pragma once
+/*#
+    # ${header_name}
+
+    MOS Technology 6502 CPU emulator.
+${variant_doc}
+    Work in progress!
+    Part of the https://github.com/c1570/Connomore64 project
+    Based on https://github.com/floooh/chips/ but modified for speed.
+
+    NOTE: this file is code-generated from m6502_connomore64.template.h and
+    m6502_gen.py in the 'codegen' directory.
+
+    The original m6502.h is zlib/libpng licensed;
+    m6502_connomore64.h is AGPL 3 licensed, i.e., in case you use
+    this in any project, you have to make the complete sources
+    of that project available under the AGPL.
+
+    Copyright (c) 2022-2026 https://github.com/c1570
+    https://www.gnu.org/licenses/agpl-3.0.html
+
+    ## zlib/libpng license
+    Copyright (c) 2018 Andre Weissflog
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HAVE_CONNOMORE_M6502H
+${variant_defines}
+// control pins
+#define M6502_PIN_RW    (0)      // out: memory read or write access
+#define M6502_PIN_SYNC  (1)      // out: start of a new instruction
+#define M6502_PIN_IRQ   (2)      // in: maskable interrupt requested
+#define M6502_PIN_NMI   (3)      // in: non-maskable interrupt requested
+#define M6502_PIN_RDY   (4)      // in: freeze execution at next read cycle
+#define M6510_PIN_AEC   (5)      // in, m6510 only, put bus lines into tristate mode, not implemented
+#define M6502_PIN_RES   (6)      // request RESET
+${variant_pins}
+// pin bit masks
+#define M6502_RW    (1UL<<M6502_PIN_RW)
+#define M6502_SYNC  (1UL<<M6502_PIN_SYNC)
+#define M6502_IRQ   (1UL<<M6502_PIN_IRQ)
+#define M6502_NMI   (1UL<<M6502_PIN_NMI)
+#define M6502_RDY   (1UL<<M6502_PIN_RDY)
+#define M6510_AEC   (1UL<<M6510_PIN_AEC)
+#define M6502_RES   (1UL<<M6502_PIN_RES)
+${variant_pin_masks}
+/* bit mask for all CPU pins (up to bit pos 25) */
+#define M6502_PIN_MASK ((1UL<<25)-1)
+
+/* status indicator flags */
+#define M6502_CF    (1<<0)  /* carry */
+#define M6502_ZF    (1<<1)  /* zero */
+#define M6502_IF    (1<<2)  /* IRQ disable */
+#define M6502_DF    (1<<3)  /* decimal mode */
+#define M6502_BF    (1<<4)  /* BRK command */
+#define M6502_XF    (1<<5)  /* unused */
+#define M6502_VF    (1<<6)  /* overflow */
+#define M6502_NF    (1<<7)  /* negative */
+
+/* internal BRK state flags */
+#define M6502_BRK_IRQ   (1<<0)  /* IRQ was triggered */
+#define M6502_BRK_NMI   (1<<1)  /* NMI was triggered */
+#define M6502_BRK_RESET (1<<2)  /* RES was triggered */
+
+${variant_desc}/* CPU state */
+typedef struct {
+    uint16_t IR;        /* internal instruction register */
+    uint16_t PC;        /* internal program counter register */
+    uint16_t AD;        /* ADL/ADH internal register */
+    uint8_t A,X,Y,S,P;  /* regular registers */
+    uint32_t PINS;      /* last stored pin state (do NOT modify) */
+    uint32_t int_pip;   /* combined nmi (upper 16 bits) and irq (lower 16 bits) pipeline */
+    uint8_t brk_flags;  /* M6502_BRK_* */
+    uint8_t bcd_enabled;
+${variant_state}    uint16_t bus_addr;
+    uint8_t bus_data;
+} m6502_t;
+
+/* initialize a new m6502 instance and return initial pin mask */
+uint32_t m6502_init(m6502_t* cpu, const m6502_desc_t* desc);
+/* execute one tick */
+uint32_t m6502_tick(m6502_t* cpu, uint32_t pins);
+${variant_protos}// prepare m6502_t snapshot for saving
+void m6502_snapshot_onsave(m6502_t* snapshot);
+// fixup m6502_t snapshot after loading
+void m6502_snapshot_onload(m6502_t* snapshot, m6502_t* sys);
+
+/* register access functions */
+void m6502_set_a(m6502_t* cpu, uint8_t v);
+void m6502_set_x(m6502_t* cpu, uint8_t v);
+void m6502_set_y(m6502_t* cpu, uint8_t v);
+void m6502_set_s(m6502_t* cpu, uint8_t v);
+void m6502_set_p(m6502_t* cpu, uint8_t v);
+void m6502_set_pc(m6502_t* cpu, uint16_t v);
+uint8_t m6502_a(m6502_t* cpu);
+uint8_t m6502_x(m6502_t* cpu);
+uint8_t m6502_y(m6502_t* cpu);
+uint8_t m6502_s(m6502_t* cpu);
+uint8_t m6502_p(m6502_t* cpu);
+uint16_t m6502_pc(m6502_t* cpu);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_IMPL
+#include <string.h>
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+/* register access functions */
+void m6502_set_a(m6502_t* cpu, uint8_t v) { cpu->A = v; }
+void m6502_set_x(m6502_t* cpu, uint8_t v) { cpu->X = v; }
+void m6502_set_y(m6502_t* cpu, uint8_t v) { cpu->Y = v; }
+void m6502_set_s(m6502_t* cpu, uint8_t v) { cpu->S = v; }
+void m6502_set_p(m6502_t* cpu, uint8_t v) { cpu->P = v; }
+void m6502_set_pc(m6502_t* cpu, uint16_t v) { cpu->PC = v; }
+uint8_t m6502_a(m6502_t* cpu) { return cpu->A; }
+uint8_t m6502_x(m6502_t* cpu) { return cpu->X; }
+uint8_t m6502_y(m6502_t* cpu) { return cpu->Y; }
+uint8_t m6502_s(m6502_t* cpu) { return cpu->S; }
+uint8_t m6502_p(m6502_t* cpu) { return cpu->P; }
+uint16_t m6502_pc(m6502_t* cpu) { return cpu->PC; }
+
+/* helper macros and functions for code-generated instruction decoder */
+#define _M6502_NZ(p,v) ((p&~(M6502_NF|M6502_ZF))|((v&0xFF)?(v&M6502_NF):M6502_ZF))
+
+static inline void __attribute__((always_inline)) _m6502_adc(m6502_t* cpu, uint8_t val) {
+    if (/*cpu->bcd_enabled && */(cpu->P & M6502_DF)) {
+        /* decimal mode (credit goes to MAME) */
+        uint8_t c = cpu->P & M6502_CF ? 1 : 0;
+        cpu->P &= ~(M6502_NF|M6502_VF|M6502_ZF|M6502_CF);
+        uint8_t al = (cpu->A & 0x0F) + (val & 0x0F) + c;
+        if (al > 9) {
+            al += 6;
+        }
+        uint8_t ah = (cpu->A >> 4) + (val >> 4) + (al > 0x0F);
+        if (0 == (uint8_t)(cpu->A + val + c)) {
+            cpu->P |= M6502_ZF;
+        }
+        else if (ah & 0x08) {
+            cpu->P |= M6502_NF;
+        }
+        if (~(cpu->A^val) & (cpu->A^(ah<<4)) & 0x80) {
+            cpu->P |= M6502_VF;
+        }
+        if (ah > 9) {
+            ah += 6;
+        }
+        if (ah > 15) {
+            cpu->P |= M6502_CF;
+        }
+        cpu->A = (ah<<4) | (al & 0x0F);
+    }
+    else {
+        /* default mode */
+        register uint16_t sum = cpu->A + val + (cpu->P & M6502_CF ? 1:0);
+        register uint8_t P = cpu->P;
+        P &= ~(M6502_VF|M6502_CF);
+        P = _M6502_NZ(P,sum);
+        if(likely(~(cpu->A^val) & (cpu->A^sum) & 0x80)) {
+            P |= M6502_VF;
+        }
+        if(likely(sum & 0xFF00)) {
+            P |= M6502_CF;
+        }
+        cpu->A = sum & 0xFF;
+        cpu->P = P;
+    }
+}
+
+static inline void __attribute__((always_inline)) _m6502_sbc(m6502_t* cpu, uint8_t val) {
+    if (/*cpu->bcd_enabled && */(cpu->P & M6502_DF)) {
+        /* decimal mode (credit goes to MAME) */
+        uint8_t c = cpu->P & M6502_CF ? 0 : 1;
+        cpu->P &= ~(M6502_NF|M6502_VF|M6502_ZF|M6502_CF);
+        uint16_t diff = cpu->A - val - c;
+        uint8_t al = (cpu->A & 0x0F) - (val & 0x0F) - c;
+        if ((int8_t)al < 0) {
+            al -= 6;
+        }
+        uint8_t ah = (cpu->A>>4) - (val>>4) - ((int8_t)al < 0);
+        if (0 == (uint8_t)diff) {
+            cpu->P |= M6502_ZF;
+        }
+        else if (diff & 0x80) {
+            cpu->P |= M6502_NF;
+        }
+        if ((cpu->A^val) & (cpu->A^diff) & 0x80) {
+            cpu->P |= M6502_VF;
+        }
+        if (!(diff & 0xFF00)) {
+            cpu->P |= M6502_CF;
+        }
+        if (ah & 0x80) {
+            ah -= 6;
+        }
+        cpu->A = (ah<<4) | (al & 0x0F);
+    }
+    else {
+        /* default mode */
+        register uint16_t diff = cpu->A - val - (cpu->P & M6502_CF ? 0 : 1);
+        register uint8_t P = cpu->P;
+        P &= ~(M6502_VF|M6502_CF);
+        P = _M6502_NZ(P, (uint8_t)diff);
+        if(likely((cpu->A^val) & (cpu->A^diff) & 0x80)) {
+            P |= M6502_VF;
+        }
+        if(likely(!(diff & 0xFF00))) {
+            P |= M6502_CF;
+        }
+        cpu->A = diff & 0xFF;
+        cpu->P = P;
+    }
+}
+
+static inline void _m6502_cmp(m6502_t* cpu, uint8_t r, uint8_t v) {
+    uint16_t t = r - v;
+    cpu->P = (_M6502_NZ(cpu->P, (uint8_t)t) & ~M6502_CF) | ((t & 0xFF00) ? 0:M6502_CF);
+}
+
+static inline uint8_t _m6502_asl(m6502_t* cpu, uint8_t v) {
+    cpu->P = (_M6502_NZ(cpu->P, v<<1) & ~M6502_CF) | ((v & 0x80) ? M6502_CF:0);
+    return v<<1;
+}
+
+static inline uint8_t _m6502_lsr(m6502_t* cpu, uint8_t v) {
+    cpu->P = (_M6502_NZ(cpu->P, v>>1) & ~M6502_CF) | ((v & 0x01) ? M6502_CF:0);
+    return v>>1;
+}
+
+static inline uint8_t __attribute__((always_inline)) _m6502_rol(m6502_t* cpu, uint8_t v) {
+    bool carry = cpu->P & M6502_CF;
+    cpu->P &= ~(M6502_NF|M6502_ZF|M6502_CF);
+    if (v & 0x80) {
+        cpu->P |= M6502_CF;
+    }
+    v <<= 1;
+    if (carry) {
+        v |= 1;
+    }
+    cpu->P = _M6502_NZ(cpu->P, v);
+    return v;
+}
+
+static inline uint8_t __attribute__((always_inline)) _m6502_ror(m6502_t* cpu, uint8_t v) {
+    bool carry = cpu->P & M6502_CF;
+    cpu->P &= ~(M6502_NF|M6502_ZF|M6502_CF);
+    if (v & 1) {
+        cpu->P |= M6502_CF;
+    }
+    v >>= 1;
+    if (carry) {
+        v |= 0x80;
+    }
+    cpu->P = _M6502_NZ(cpu->P, v);
+    return v;
+}
+
+static inline void __attribute__((always_inline)) _m6502_bit(m6502_t* cpu, uint8_t v) {
+    uint8_t t = cpu->A & v;
+    cpu->P &= ~(M6502_NF|M6502_VF|M6502_ZF);
+    if (!t) {
+        cpu->P |= M6502_ZF;
+    }
+    cpu->P |= v & (M6502_NF|M6502_VF);
+}
+
+static inline void __attribute__((always_inline)) _m6502_arr(m6502_t* cpu) {
+    /* undocumented, unreliable ARR instruction, but this is tested
+       by the Wolfgang Lorenz C64 test suite
+       implementation taken from MAME
+    */
+    if (/*cpu->bcd_enabled && */(cpu->P & M6502_DF)) {
+        bool c = cpu->P & M6502_CF;
+        cpu->P &= ~(M6502_NF|M6502_VF|M6502_ZF|M6502_CF);
+        uint8_t a = cpu->A>>1;
+        if (c) {
+            a |= 0x80;
+        }
+        cpu->P = _M6502_NZ(cpu->P,a);
+        if ((a ^ cpu->A) & 0x40) {
+            cpu->P |= M6502_VF;
+        }
+        if ((cpu->A & 0xF) >= 5) {
+            a = ((a + 6) & 0xF) | (a & 0xF0);
+        }
+        if ((cpu->A & 0xF0) >= 0x50) {
+            a += 0x60;
+            cpu->P |= M6502_CF;
+        }
+        cpu->A = a;
+    }
+    else {
+        bool c = cpu->P & M6502_CF;
+        cpu->P &= ~(M6502_NF|M6502_VF|M6502_ZF|M6502_CF);
+        cpu->A >>= 1;
+        if (c) {
+            cpu->A |= 0x80;
+        }
+        cpu->P = _M6502_NZ(cpu->P,cpu->A);
+        if (cpu->A & 0x40) {
+            cpu->P |= M6502_VF|M6502_CF;
+        }
+        if (cpu->A & 0x20) {
+            cpu->P ^= M6502_VF;
+        }
+    }
+}
+
+/* undocumented SBX instruction:
+    AND X register with accumulator and store result in X register, then
+    subtract byte from X register (without borrow) where the
+    subtract works like a CMP instruction
+*/
+static inline void __attribute__((always_inline)) _m6502_sbx(m6502_t* cpu, uint8_t v) {
+    uint16_t t = (cpu->A & cpu->X) - v;
+    cpu->P = _M6502_NZ(cpu->P, t) & ~M6502_CF;
+    if (!(t & 0xFF00)) {
+        cpu->P |= M6502_CF;
+    }
+    cpu->X = (uint8_t)t;
+}
+#undef _M6502_NZ
+
+uint32_t m6502_init(m6502_t* c, const m6502_desc_t* desc) {
+    CHIPS_ASSERT(c && desc);
+    memset(c, 0, sizeof(*c));
+    c->P = M6502_ZF;
+    c->bcd_enabled = !desc->bcd_disabled;
+    c->PINS = M6502_RW | M6502_SYNC | M6502_RES;
+${variant_init}    return c->PINS;
+}
+
+${variant_impl}/* set 16-bit address */
+#define _SA(addr) c->bus_addr=addr
+/* get 16-bit address */
+#define _GA() c->bus_addr
+/* set 16-bit address and 8-bit data */
+#define _SAD(addr,data) {c->bus_addr=addr;c->bus_data=data;}
+/* fetch next opcode byte */
+#define _FETCH() _SA(c->PC);_ON(M6502_SYNC);
+/* set 8-bit data */
+#define _SD(data) c->bus_data=data
+/* get 8-bit bus data */
+#define _GD() (c->bus_data)
+/* enable control pins */
+#define _ON(m) pins|=(m)
+/* disable control pins */
+#define _OFF(m) pins&=~(m)
+/* a memory read tick */
+#define _RD() _ON(M6502_RW);
+/* a memory write tick */
+#define _WR() _OFF(M6502_RW);
+/* set N and Z flags depending on value */
+#define _NZ(v) c->P=((c->P&~(M6502_NF|M6502_ZF))|((v&0xFF)?(v&M6502_NF):M6502_ZF))
+/* ignore data */
+#define _ID()
+/* ignore address */
+#define _IA()
+${variant_access_macros}
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4244)   /* conversion from 'uint16_t' to 'uint8_t', possible loss of data */
+#endif
+
+uint32_t m6502_tick(m6502_t* c, uint32_t pins) {
+${tick_interrupts}        if (pins & M6502_SYNC) {
+            _OFF(M6502_SYNC);
+            // check IRQ, NMI and RES state
+            //  - IRQ is level-triggered and must be active in the full cycle
+            //    before SYNC
+            //  - NMI is edge-triggered, and the change must have happened in
+            //    any cycle before SYNC
+            //  - RES behaves slightly different than on a real 6502, we go
+            //    into RES state as soon as the pin goes active, from there
+            //    on, behaviour is 'standard'
+            if (0 != (c->int_pip & 0x400)) {
+                c->brk_flags |= M6502_BRK_IRQ;
+            }
+            if (0 != (c->int_pip & 0xFFC00000)) {
+                c->brk_flags |= M6502_BRK_NMI;
+            }
+${tick_reset}            c->int_pip &= 0x003F03FF;
+            c->int_pip <<= 1;
+
+            // if interrupt or reset was requested, force a BRK instruction
+            // otherwise, load new instruction into 'instruction register' and restart tick counter
+            if (c->brk_flags) {
+                c->IR = 0;
+                c->P &= ~M6502_BF;
+                pins &= ~M6502_RES;
+                _ID();
+            }
+            else {
+                c->PC++;
+                c->IR = _GD()<<3;
+            }
+        } else {
+            c->int_pip &= 0xffff7fff;
+            c->int_pip <<= 1;
+        }
+    } else {
+        c->int_pip &= 0xffff7fff;
+        c->int_pip <<= 1;
+    }
+${tick_pre_decode}    // reads are default, writes are special
+    _RD();
+    switch (c->IR++) {
+$decode_block
+    }
+    c->PINS = pins;
+    return pins;
+}
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#undef _SA
+#undef _SAD
+#undef _FETCH
+#undef _SD
+#undef _GD
+#undef _ON
+#undef _OFF
+#undef _RD
+#undef _WR
+#undef _NZ
+#undef _ID
+#undef _IA
+${variant_access_undefs}#endif /* CHIPS_IMPL */
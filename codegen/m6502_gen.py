@@ -3,9 +3,12 @@
 #   Generate instruction decoder for m6502.h emulator.
 #-------------------------------------------------------------------------------
 from string import Template
+import re
 
 InpPath = 'm6502.template.h'
 OutPath = '../chips/m6502.h'
+FastInpPath = 'm6502_connomore64.template.h'
+FastOutPath = '../chips/m6502_connomore64.h'
 
 # flag bits
 CF = (1<<0)
@@ -133,13 +136,15 @@ def l(s) :
     out_lines += s + '\n'
 
 #-------------------------------------------------------------------------------
-def write_op(op):
+def write_op(op, tick_func=None):
+    ctx = {}
     if not op.cmt:
         op.cmt = '???'
     l('    /* {} */'.format(op.cmt if op.cmt else '???'))
     for t in range(0, 8):
         if t < op.i:
-            l('        case (0x{:02X}<<3)|{}: {}break;'.format(op.code, t, op.src[t]))
+            src = op.src[t] if tick_func is None else tick_func(op.src[t], t, ctx)
+            l('        case (0x{:02X}<<3)|{}: {}break;'.format(op.code, t, src))
         else:
             l('        case (0x{:02X}<<3)|{}: assert(false);break;'.format(op.code, t))
 
@@ -847,14 +852,388 @@ def enc_op(op):
         o.t('_FETCH();')
     return o
 
+#-------------------------------------------------------------------------------
+#   m6502_connomore64.h flavour of the decoder: separate bus_addr/bus_data,
+#   RMW instructions do the dummy write of the unmodified value, branches
+#   only put the address on the bus which is actually read, ticks which don't
+#   consume the data bus are tagged with _ID()
+#
+def connomore_tick(src, t, ctx):
+    s = src.replace('c->irq_pip>>=1;c->nmi_pip>>=1;', 'c->int_pip>>=1;')
+    m = re.match(r'_SA\(c->PC\);c->AD=c->PC\+\(int8_t\)_GD\(\);if\((.*)\)\{_FETCH\(\);\};$', s)
+    if m:
+        s = 'c->AD=c->PC+(int8_t)_GD();if('+m.group(1)+'){_FETCH();}else{_SA(c->PC);};'
+    s = s.replace('_SA((c->PC&0xFF00)|(c->AD&0x00FF));if((c->AD&0xFF00)==(c->PC&0xFF00)){c->PC=c->AD;c->int_pip>>=1;_FETCH();};',
+                  'if((c->AD&0xFF00)==(c->PC&0xFF00)){c->PC=c->AD;c->int_pip>>=1;_FETCH();}else{_SA((c->PC&0xFF00)|(c->AD&0x00FF));};')
+    s = s.replace('c->AD=_GD();_WR();', '_WR();c->AD=_GD();_SD(c->AD);')
+    if s.endswith('_WR();') and not s.endswith('{_WR();}'):
+        s = '_WR();' + s[:-len('_WR();')]
+    if s.endswith('_FETCH();') and 'c->PC=' not in s:
+        s = '_FETCH();' + s[:-len('_FETCH();')]
+    if t > 0 and '_GD()' not in s:
+        s += '_ID();'
+    return s
+
+#-------------------------------------------------------------------------------
+#   Address classes for memory-map specialised decoders. Zero-page and stack
+#   accesses are resolved at code-generation time (the memory map must have
+#   RAM at 0000..01FF), everything else goes through the inline decoder.
+#
+AC_ZP    = 'zp'
+AC_STACK = 'stack'
+AC_ANY   = 'any'
+
+def first_arg(s, start):
+    # first top-level argument of the call whose '(' is at s[start]
+    depth = 0
+    for i in range(start, len(s)):
+        if s[i] == '(':
+            depth += 1
+        elif s[i] == ')':
+            depth -= 1
+            if depth == 0:
+                return s[start+1:i]
+        elif s[i] == ',' and depth == 1:
+            return s[start+1:i]
+    assert False
+
+def addr_class(s, pos, expr):
+    if expr.startswith('0x0100|c->S'):
+        return AC_STACK
+    if expr in ['_GD()', '(c->AD+1)&0xFF', '(c->AD+c->X)&0x00FF', '(c->AD+c->Y)&0x00FF']:
+        return AC_ZP
+    if expr == 'c->AD':
+        # base/pointer address of the zp,X / zp,Y / (zp,X) / (zp),Y modes
+        if s[:pos].endswith('c->AD=_GD();') or s[:pos].endswith('c->AD=(c->AD+c->X)&0xFF;'):
+            return AC_ZP
+    return AC_ANY
+
+def tick_addr_class(s, prev):
+    # class of the address on the bus at the end of the tick, ticks which
+    # don't set an address keep the previous one
+    classes = set()
+    for m in re.finditer(r'_SAD?\(|_FETCH\(\)', s):
+        if m.group(0) == '_FETCH()':
+            classes.add(AC_ANY)
+        else:
+            classes.add(addr_class(s, m.start(), first_arg(s, m.end()-1)))
+    if not classes:
+        return prev
+    if len(classes) == 1:
+        return classes.pop()
+    return AC_ANY
+
+def tick_access(s):
+    # unconditional writes have been moved to the start by connomore_tick(),
+    # conditional writes (BRK during RESET) are only known at runtime
+    if s.startswith('_WR();'):
+        return 'W'
+    if '_WR();' in s:
+        return 'RW'
+    return 'R'
+
+def memmap_tick(src, t, ctx):
+    s = connomore_tick(src, t, ctx)
+    cls = tick_addr_class(s, ctx.get('cls', AC_ANY))
+    ctx['cls'] = cls
+    if cls in [AC_ZP, AC_STACK]:
+        s += '_RAM_{}();'.format(tick_access(s))
+    else:
+        s += '_MEM_{}();'.format(tick_access(s))
+    return s
+
+#-------------------------------------------------------------------------------
+#   Memory maps of specialised cores. An address belongs to a region if
+#   (addr & mask) == match, the region is indexed with (addr & (size-1)).
+#   The ROM is split into 'banks' equally sized pointers (e.g. separate
+#   ROM chips), selected by the address bits above the bank size.
+#   Addresses which are neither RAM nor ROM set the M6502_IO pin and must
+#   be handled by the system tick function.
+#
+C1541_MEMMAP = {
+    'header': 'm6502_c1541.h',
+    'define': 'HAVE_C1541_M6502H',
+    'system': 'Commodore 1541',
+    'ram': { 'mask': 0x9800, 'match': 0x0000, 'size': 0x0800 },
+    'rom': { 'mask': 0x8000, 'match': 0x8000, 'size': 0x4000, 'banks': 2 },
+}
+
+def rom_bank_shift(rom):
+    bank_size = rom['size'] // rom['banks']
+    assert rom['size'] == bank_size * rom['banks'] and (bank_size & (bank_size - 1)) == 0
+    return bank_size.bit_length() - 1
+
+def memmap_access_macros(mm):
+    ram = mm['ram']
+    rom = mm['rom']
+    assert (0x0000 & ram['mask']) == ram['match'] and (0x01FF & ram['mask']) == ram['match']
+    return \
+        '/* {} memory map */\n'.format(mm['system']) + \
+        '#define _IS_RAM() ((c->bus_addr&0x{:04X})==0x{:04X})\n'.format(ram['mask'], ram['match']) + \
+        '#define _IS_ROM() ((c->bus_addr&0x{:04X})==0x{:04X})\n'.format(rom['mask'], rom['match']) + \
+        '#define _RAM_R() c->bus_data=c->ram[c->bus_addr&0x{:04X}];\n'.format(ram['size']-1) + \
+        '#define _RAM_W() c->ram[c->bus_addr&0x{:04X}]=c->bus_data;\n'.format(ram['size']-1) + \
+        '#define _RAM_RW() if(pins&M6502_RW){_RAM_R()}else{_RAM_W()}\n' + \
+        '#define _ROM_R() c->bus_data=c->rom[(c->bus_addr>>{})&0x{:X}][c->bus_addr&0x{:04X}];\n'.format(
+            rom_bank_shift(rom), rom['banks']-1, rom['size']//rom['banks']-1) + \
+        '#define _MEM_R() if(_IS_ROM()){_ROM_R()}else if(_IS_RAM()){_RAM_R()}else{_ON(M6502_IO);}\n' + \
+        '#define _MEM_W() if(_IS_RAM()){_RAM_W()}else if(!_IS_ROM()){_ON(M6502_IO);}\n' + \
+        '#define _MEM_RW() if(pins&M6502_RW){_MEM_R()}else{_MEM_W()}\n'
+
+MEMMAP_UNDEFS = '''\
+#undef _IS_RAM
+#undef _IS_ROM
+#undef _RAM_R
+#undef _RAM_W
+#undef _RAM_RW
+#undef _ROM_R
+#undef _MEM_R
+#undef _MEM_W
+#undef _MEM_RW
+'''
+
+#-------------------------------------------------------------------------------
+#   template snippets of the generic m6502_connomore64.h
+#
+CONNOMORE_SUBST = {
+    'header_name': 'm6502_connomore64.h',
+    'variant_doc': '',
+    'variant_defines': '',
+    'variant_pins': '',
+    'variant_pin_masks': '',
+    'variant_desc': '''\
+/* m6510 IO port callback prototypes */
+typedef void (*m6510_out_t)(uint8_t data, void* user_data);
+typedef uint8_t (*m6510_in_t)(void* user_data);
+
+/* the desc structure provided to m6502_init() */
+typedef struct {
+    bool bcd_disabled;              /* set to true if BCD mode is disabled */
+    m6510_in_t m6510_in_cb;         /* optional port IO input callback (only on m6510) */
+    m6510_out_t m6510_out_cb;       /* optional port IO output callback (only on m6510) */
+    void* m6510_user_data;          /* optional callback user data */
+    uint8_t m6510_io_pullup;        /* IO port bits that are 1 when reading */
+    uint8_t m6510_io_floating;      /* unconnected IO port pins */
+} m6502_desc_t;
+
+''',
+    'variant_state': '''\
+    /* 6510 IO port state */
+    void* user_data;
+    m6510_in_t in_cb;
+    m6510_out_t out_cb;
+    uint8_t io_ddr;     /* 1: output, 0: input */
+    uint8_t io_inp;     /* last port input */
+    uint8_t io_out;     /* last port output */
+    uint8_t io_pullup;
+    uint8_t io_floating;
+    uint8_t io_drive;
+
+    uint8_t io_pins;    /* current state of IO pins (combined input/output) */
+''',
+    'variant_protos': '''\
+/* perform m6510 port IO (only call this if M6510_CHECK_IO(pins) is true) */
+uint32_t m6510_iorq(m6502_t* cpu, uint32_t pins);
+''',
+    'variant_init': '''\
+    c->in_cb = desc->m6510_in_cb;
+    c->out_cb = desc->m6510_out_cb;
+    c->user_data = desc->m6510_user_data;
+    c->io_pullup = desc->m6510_io_pullup;
+    c->io_floating = desc->m6510_io_floating;
+''',
+    'variant_impl': '''\
+/* only call this when accessing address 0 or 1 (M6510_CHECK_IO(pins) evaluates to true) */
+uint32_t m6510_iorq(m6502_t* c, uint32_t pins) {
+    CHIPS_ASSERT(c->in_cb && c->out_cb);
+    if ((c->bus_addr & 1) == 0) {
+        /* address 0: access to data direction register */
+        if (pins & M6502_RW) {
+            /* read IO direction bits */
+            c->bus_data = c->io_ddr;
+        }
+        else {
+            /* write IO direction bits and update outside world */
+            c->io_ddr = c->bus_data;
+            c->io_drive = (c->io_out & c->io_ddr) | (c->io_drive & ~c->io_ddr);
+            c->out_cb((c->io_out & c->io_ddr) | (c->io_pullup & ~c->io_ddr), c->user_data);
+            c->io_pins = (c->io_out & c->io_ddr) | (c->io_inp & ~c->io_ddr);
+        }
+    }
+    else {
+        /* address 1: perform I/O */
+        if (pins & M6502_RW) {
+            /* an input operation */
+            c->io_inp = c->in_cb(c->user_data);
+            uint8_t val = ((c->io_inp | (c->io_floating & c->io_drive)) & ~c->io_ddr) | (c->io_out & c->io_ddr);
+            c->bus_data = val;
+        }
+        else {
+            /* an output operation */
+            c->io_out = c->bus_data;
+            c->io_drive = (c->io_out & c->io_ddr) | (c->io_drive & ~c->io_ddr);
+            c->out_cb((c->io_out & c->io_ddr) | (c->io_pullup & ~c->io_ddr), c->user_data);
+        }
+        c->io_pins = (c->io_out & c->io_ddr) | (c->io_inp & ~c->io_ddr);
+    }
+    return pins;
+}
+
+void m6502_snapshot_onsave(m6502_t* snapshot) {
+    CHIPS_ASSERT(snapshot);
+    snapshot->in_cb = 0;
+    snapshot->out_cb = 0;
+    snapshot->user_data = 0;
+}
+
+void m6502_snapshot_onload(m6502_t* snapshot, m6502_t* sys) {
+    CHIPS_ASSERT(snapshot && sys);
+    snapshot->in_cb = sys->in_cb;
+    snapshot->out_cb = sys->out_cb;
+    snapshot->user_data = sys->user_data;
+}
+
+''',
+    'variant_access_macros': '',
+    'variant_access_undefs': '',
+    'tick_interrupts': '''\
+    if (pins & (M6502_SYNC|M6502_IRQ|M6502_NMI|M6502_RDY|M6502_RES)) {
+        // interrupt detection also works in RDY phases, but only NMI is "sticky"
+
+        // NMI is edge-triggered
+        if (0 != ((pins & (pins ^ c->PINS)) & M6502_NMI)) {
+            c->int_pip |= 0x00100000;
+        }
+        // IRQ test is level triggered
+        if ((pins & M6502_IRQ) && (0 == (c->P & M6502_IF))) {
+            c->int_pip |= 0x00000100;
+        }
+
+        // RDY pin is only checked during read cycles
+        if ((pins & (M6502_RW|M6502_RDY)) == (M6502_RW|M6502_RDY)) {
+            c->PINS = pins;
+            c->int_pip = (c->int_pip & 0xffff0000) | ((c->int_pip & 0x7fff) << 1);
+            _IA();
+            _ID();
+            return pins;
+        }
+''',
+    'tick_reset': '''\
+            if (0 != (pins & M6502_RES)) {
+                c->brk_flags |= M6502_BRK_RESET;
+                c->io_ddr = 0;
+                c->io_out = 0;
+                c->io_inp = 7;
+                c->io_pins = 7;
+            }
+''',
+    'tick_pre_decode': '',
+}
+
+#-------------------------------------------------------------------------------
+#   template snippets of a memory-map specialised core (no 6510 IO port,
+#   no RDY and NMI)
+#
+def memmap_subst(mm):
+    ram = mm['ram']
+    rom = mm['rom']
+    subst = {
+        'header_name': mm['header'],
+        'variant_doc':
+            '\n'
+            '    Specialised for the {} memory map: RAM and ROM accesses are\n'.format(mm['system']) +
+            '    performed inside the instruction decoder, zero-page and stack\n'
+            '    accesses go straight to RAM. All other accesses set the M6502_IO\n'
+            '    pin and must be completed by the system. The 6510 IO port, RDY\n'
+            '    and NMI are not emulated.\n'
+            '\n'
+            '    RAM: (addr & 0x{:04X}) == 0x{:04X}, 0x{:04X} bytes\n'.format(ram['mask'], ram['match'], ram['size']) +
+            '    ROM: (addr & 0x{:04X}) == 0x{:04X}, 0x{:04X} bytes in {} banks\n'.format(rom['mask'], rom['match'], rom['size'], rom['banks']),
+        'variant_defines': '#define {}\n'.format(mm['define']),
+        'variant_pins': '#define M6502_PIN_IO    (7)      // out: access outside of RAM/ROM, to be completed by the system\n',
+        'variant_pin_masks': '#define M6502_IO    (1UL<<M6502_PIN_IO)\n',
+        'variant_desc': '''\
+/* the desc structure provided to m6502_init() */
+typedef struct {
+    bool bcd_disabled;              /* set to true if BCD mode is disabled */
+    uint8_t* ram;                   /* RAM, accessed by the instruction decoder */
+    $rom_decl/* ROM banks, accessed by the instruction decoder */
+} m6502_desc_t;
+
+''',
+        'variant_state': '''\
+    /* memory map */
+    uint8_t* ram;
+    const uint8_t* rom[$banks];
+
+''',
+        'variant_protos': '',
+        'variant_init': '''\
+    CHIPS_ASSERT(desc->ram);
+    c->ram = desc->ram;
+    for (int i = 0; i < $banks; i++) {
+        CHIPS_ASSERT(desc->rom[i]);
+        c->rom[i] = desc->rom[i];
+    }
+''',
+        'variant_impl': '''\
+void m6502_snapshot_onsave(m6502_t* snapshot) {
+    CHIPS_ASSERT(snapshot);
+    snapshot->ram = 0;
+    memset(snapshot->rom, 0, sizeof(snapshot->rom));
+}
+
+void m6502_snapshot_onload(m6502_t* snapshot, m6502_t* sys) {
+    CHIPS_ASSERT(snapshot && sys);
+    snapshot->ram = sys->ram;
+    memcpy(snapshot->rom, sys->rom, sizeof(snapshot->rom));
+}
+
+''',
+        'variant_access_macros': memmap_access_macros(mm),
+        'variant_access_undefs': MEMMAP_UNDEFS,
+        'tick_interrupts': '''\
+    if (pins & (M6502_SYNC|M6502_IRQ|M6502_RES)) {
+        // IRQ test is level triggered
+        if ((pins & M6502_IRQ) && (0 == (c->P & M6502_IF))) {
+            c->int_pip |= 0x00000100;
+        }
+''',
+        'tick_reset': '''\
+            if (0 != (pins & M6502_RES)) {
+                c->brk_flags |= M6502_BRK_RESET;
+            }
+''',
+        'tick_pre_decode': '    _OFF(M6502_IO);\n',
+    }
+    # number of ROM bank pointers in the desc and state, the desc comment column stays aligned
+    rom_decl = 'const uint8_t* rom[{}];'.format(rom['banks']).ljust(32)
+    return { k: v.replace('$rom_decl', rom_decl).replace('$banks', str(rom['banks'])) for k, v in subst.items() }
+
 #-------------------------------------------------------------------------------
 #   execution starts here
 #
-for op in range(0, 256):
-    write_op(enc_op(op))
-
-with open(InpPath, 'r') as inf:
-    templ = Template(inf.read())
-    c_src = templ.safe_substitute(decode_block=out_lines)
-    with open(OutPath, 'w') as outf:
-        outf.write(c_src)
+def decode_block(tick_func):
+    global out_lines
+    out_lines = ''
+    for op in range(0, 256):
+        write_op(enc_op(op), tick_func)
+    return out_lines
+
+def write_file(inp_path, out_path, subst):
+    with open(inp_path, 'r') as inf:
+        templ = Template(inf.read())
+        c_src = templ.safe_substitute(subst)
+        with open(out_path, 'w') as outf:
+            outf.write(c_src)
+
+write_file(InpPath, OutPath, { 'decode_block': decode_block(None) })
+
+subst = dict(CONNOMORE_SUBST)
+subst['decode_block'] = decode_block(connomore_tick)
+write_file(FastInpPath, FastOutPath, subst)
+
+for mm in [C1541_MEMMAP]:
+    subst = memmap_subst(mm)
+    subst['decode_block'] = decode_block(memmap_tick)
+    write_file(FastInpPath, '../chips/' + mm['header'], subst)
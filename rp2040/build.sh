@@ -13,7 +13,9 @@ mkdir -p build
 cd build
 
 # Run CMake configuration
-cmake .. -DPICO_BOARD=pico
+cmake .. -DPICO_BOARD=pico -DC1541_DUAL_CORE=${C1541_DUAL_CORE:-OFF} -DC1541_REALTIME=${C1541_REALTIME:-OFF} \
+    -DC1541_SRAM=${C1541_SRAM:-OFF} -DC1541_XIP_STATS=${C1541_XIP_STATS:-OFF} \
+    -DC1541_CYCLE_TRACE=${C1541_CYCLE_TRACE:-OFF} -DC1541_PERF=${C1541_PERF:-OFF}
 
 # Build the project
 make -j$(nproc)
@@ -4,6 +4,15 @@
 
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
+#include "hardware/pio.h"
+#include "hardware/timer.h"
+#include "hardware/uart.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "iec.pio.h"
+#ifdef C1541_DUAL_CORE
+#include "pico/multicore.h"
+#endif
 #include "cycle_tracing.h"
 
 // GPIO pin assignments
@@ -22,8 +31,8 @@
 #include <stdio.h>
 #include "../chips/chips_common.h"
 #define likely(x) __builtin_expect(!!(x), 1)
-#include "../chips/m6502_connomore64.h"
-#include "../chips/m6522.h"
+#include "../chips/m6502_c1541.h"
+#include "../chips/m6522_fast.h"
 #include "../chips/clk.h"
 #include "../chips/mem.h"
 static bool drive_led_status = 0;
@@ -32,6 +41,12 @@ static int drive_current_track = 0;
 #define C1541_TRACK_CHANGED_HOOK(s,v) {cycle_info("track");drive_current_track=v;}
 #define C1541_MOTOR_CHANGED_HOOK(s,v) gpio_put(MOTOR_STATUS_PIN,v)
 #define C1541_LED_CHANGED_HOOK(s,v) {cycle_info("led");gpio_put(LED_PIN,v);}
+#define C1541_BYTE_READY_HOOK(s) cycle_trace("byte")
+#ifdef C1541_DUAL_CORE
+// disk rotor on core 1, see c1541_rotor_poll()
+#define C1541_ENABLE_ROTOR_CORE
+#define C1541_ROTOR_WAIT_HOOK(s) tight_loop_contents()
+#endif
 #include "iecbus_rp2.h"
 #include "../systems/c1541.h"
 #include "../tests/c1541-roms.h"
@@ -40,104 +55,277 @@ static int drive_current_track = 0;
 
 static struct {
     c1541_t c1541;
+    c1541_storage_t c1541_storage;
     bool keep_running;
+    #ifdef C1541_DUAL_CORE
+    c1541_rotor_link_t rotor_link;
+    #endif
+    #ifdef C1541_ENABLE_PERF
+    c1541_perf_t perf;
+    #endif
 } state;
 
 void cleanup(int signal) {
     state.keep_running = false;
 }
 
-// Initialize GPIO pins for IEC bus open-collector operation
-void init_iec_gpio(void) {
-    // Build mask of all IEC pins
-    const uint32_t iec_mask = (1u << IEC_PIN_DATA) |
-                              (1u << IEC_PIN_CLK) |
-                              (1u << IEC_PIN_ATN) |
-                              (1u << IEC_PIN_SRQ) |
-                              (1u << IEC_PIN_RESET);
+// IEC lines on PIO0: iec_in samples DATA..RESET, iec_out drives DATA/CLK
+#define IEC_PIO_LINES (IECLINE_DATA|IECLINE_CLK|IECLINE_ATN|IECLINE_SRQIN|IECLINE_RESET)
+static PIO iec_pio = pio0;
+static uint iec_in_sm;
+static uint iec_out_sm;
 
-    // Initialize all IEC pins
-    gpio_init_mask(iec_mask);
+// Initialize the IEC pins and start both PIO state machines
+void init_iec_pio(void) {
+    const uint32_t in_mask = (1u << IEC_PIN_ATN) |
+                             (1u << IEC_PIN_SRQ) |
+                             (1u << IEC_PIN_RESET);
 
-    // IMPORTANT: Set all pins to output 0V first
-    // This ensures that if a pin is set to output, it drives low (not high)
-    gpio_put_masked(iec_mask, 0u);
+    // ATN, SRQ and RESET are plain inputs (inactive state = high via the bus pull-ups)
+    gpio_init_mask(in_mask);
+    gpio_set_dir_in_masked(in_mask);
 
-    // Set all to input with pull-up initially (inactive state = high)
-    gpio_set_dir_in_masked(iec_mask);
+    iec_in_sm = pio_claim_unused_sm(iec_pio, true);
+    iec_in_program_init(iec_pio, iec_in_sm, pio_add_program(iec_pio, &iec_in_program), IEC_PIN_DATA);
+    iec_out_sm = pio_claim_unused_sm(iec_pio, true);
+    iec_out_program_init(iec_pio, iec_out_sm, pio_add_program(iec_pio, &iec_out_program), IEC_PIN_DATA, IEC_PIN_ATN);
 }
 
-// Read incoming IEC signals from GPIOs
+// Read incoming IEC signals, one FIFO status read if no line changed
 uint8_t read_iec_signals(void) {
-    uint8_t signals = 0xFF;  // Start with all inactive (high)
+    static uint8_t signals = 0xFF;
+    while (!pio_sm_is_rx_fifo_empty(iec_pio, iec_in_sm)) {
+        signals = pio_sm_get(iec_pio, iec_in_sm) | ~IEC_PIO_LINES;
+    }
+    return signals;
+}
 
-    // GPIO reads return 1 when HIGH (inactive), 0 when LOW (active)
-    if (!gpio_get(IEC_PIN_ATN))   signals &= ~IECLINE_ATN;
-    if (!gpio_get(IEC_PIN_DATA))  signals &= ~IECLINE_DATA;
-    if (!gpio_get(IEC_PIN_CLK))   signals &= ~IECLINE_CLK;
-    if (!gpio_get(IEC_PIN_RESET)) signals &= ~IECLINE_RESET;
-    if (!gpio_get(IEC_PIN_SRQ))   signals &= ~IECLINE_SRQIN;
+// Write DATA/CLK pin directions, see iec_get_drive_pio_dirs()
+void write_iec_signals(uint8_t dirs) {
+    pio_sm_put(iec_pio, iec_out_sm, dirs);
+}
 
-    return signals;
+#if defined(C1541_REALTIME) || defined(C1541_XIP_STATS) || defined(C1541_ENABLE_PERF)
+#include <stdarg.h>
+// Report lines (pacing, XIP stats, stage times), fed to the UART TX FIFO from the
+// drive loop so that they never block it
+static struct {
+    char buf[320];
+    uint16_t pos;
+    uint16_t len;
+} report;
+
+static void report_printf(const char* fmt, ...) {
+    if (report.pos == report.len) {
+        report.pos = report.len = 0;
+    }
+    va_list args;
+    va_start(args, fmt);
+    const int n = vsnprintf(report.buf + report.len, sizeof(report.buf) - report.len, fmt, args);
+    va_end(args);
+    // a line that does not fit any more is dropped
+    if ((n > 0) && ((report.len + n) < sizeof(report.buf))) {
+        report.len += n;
+    }
 }
 
-// Write outgoing IEC signals using open-collector logic
-void write_iec_signals(uint8_t signals) {
-    // Open-collector output: set direction to output to pull low (active),
-    // or input to release (inactive/high via pull-up)
+static inline void report_out(void) {
+    while ((report.pos < report.len) && uart_is_writable(uart_default)) {
+        uart_putc_raw(uart_default, report.buf[report.pos++]);
+    }
+}
+#endif
+
+#ifdef C1541_XIP_STATS
+#include "hardware/structs/xip_ctrl.h"
+// XIP cache accesses and hits of the past 2^20 drive cycles (about a second),
+// any flash read of code, constants or the GCR image store counts
+static void xip_report(void) {
+    const uint32_t acc = xip_ctrl_hw->ctr_acc;
+    const uint32_t hit = xip_ctrl_hw->ctr_hit;
+    xip_ctrl_hw->ctr_acc = 0;
+    xip_ctrl_hw->ctr_hit = 0;
+    report_printf("xip: %lu accesses, %lu hits, %lu misses, track %d\n",
+        (unsigned long)acc, (unsigned long)hit, (unsigned long)(acc - hit), drive_current_track);
+}
+#endif
 
-    // DATA line: pull low if active, otherwise release (input)
-    if (signals & IECLINE_DATA) {
-        gpio_set_dir(IEC_PIN_DATA, GPIO_IN);  // Release (inactive)
-    } else {
-        gpio_set_dir(IEC_PIN_DATA, GPIO_OUT); // Pull low (active)
+#ifdef C1541_ENABLE_PERF
+// Average and max SysTick cycles per stage of c1541_tick() over the past 2^20
+// drive cycles (see c1541_perf_t), then the counters start over
+static void perf_report(void) {
+    static const char* names[C1541_PERF_NUM_STAGES] = { "tick", "cpu", "via1", "via2", "fetch" };
+    char line[160];
+    int len = snprintf(line, sizeof(line), "perf @%lu MHz avg/max cyc:", (unsigned long)(state.perf.frequency / 1000000));
+    for (int i = 0; (i < C1541_PERF_NUM_STAGES) && (len < (int)sizeof(line)); i++) {
+        const c1541_perf_counter_t* c = &state.perf.stage[i];
+        if (c->count) {
+            len += snprintf(line + len, sizeof(line) - len, " %s %lu/%lu", names[i],
+                (unsigned long)(c->total / c->count), (unsigned long)c->max);
+        } else {
+            len += snprintf(line + len, sizeof(line) - len, " %s -", names[i]);
+        }
     }
+    report_printf("%s\n", line);
+    c1541_perf_reset(&state.perf);
+}
+#endif
 
-    // CLK line
-    if (signals & IECLINE_CLK) {
-        gpio_set_dir(IEC_PIN_CLK, GPIO_IN);   // Release (inactive)
-    } else {
-        gpio_set_dir(IEC_PIN_CLK, GPIO_OUT);  // Pull low (active)
+#ifdef C1541_REALTIME
+// Real-time pacing: drive cycle n is due at timer tick start + n (the timer counts
+// at 1 MHz). When late, cycles run back to back and the timer is read only once
+// per batch. When ahead, the loop busy-waits for the due tick.
+#define PACE_MAX_BATCH  256         // cycles run back to back before reading the timer again
+#define PACE_MAX_LATE   100000      // resync instead of catching up beyond this (a slip)
+static struct {
+    uint32_t next_us;               // timer value the next drive cycle is due at
+    uint32_t due;                   // cycles left to run without reading the timer
+    uint32_t second_us;             // timer value of the next report
+    uint32_t cycles;                // drive cycles run in this second
+    uint32_t wait_us;               // busy-wait time in this second
+    int32_t late;                   // lateness at the last timer read
+    uint32_t late_max;              // max lateness in this second
+    uint32_t slips;                 // resyncs since start
+    uint32_t edges;                 // IEC edge count at the last report
+} pace;
+
+void pace_init(void) {
+    pace.next_us = time_us_32();
+    pace.second_us = pace.next_us + 1000000;
+}
+
+// Queue the stats of the past second
+static void pace_report(void) {
+    const uint32_t edges = iec_get_edge_count(NULL);
+    report_printf("pace: %lu cyc/s, drift %ld us, late max %lu us, wait %lu us, slips %lu, iec %lu edges/s\n",
+        (unsigned long)pace.cycles, (long)pace.late, (unsigned long)pace.late_max,
+        (unsigned long)pace.wait_us, (unsigned long)pace.slips, (unsigned long)(edges - pace.edges));
+    pace.edges = edges;
+    pace.cycles = 0;
+    pace.wait_us = 0;
+    pace.late_max = 0;
+    pace.second_us += 1000000;
+}
+
+// Wait until the next drive cycle is due
+static inline void pace_cycle(void) {
+    if (pace.due == 0) {
+        const uint32_t now = time_us_32();
+        int32_t late = (int32_t)(now - pace.next_us);
+        if (late < 0) {
+            pace.wait_us += -late;
+            while ((int32_t)(time_us_32() - pace.next_us) < 0) {
+                tight_loop_contents();
+            }
+            late = 0;
+        }
+        pace.late = late;
+        if ((uint32_t)late > pace.late_max) {
+            pace.late_max = late;
+        }
+        if (late > PACE_MAX_LATE) {
+            pace.next_us = now;
+            pace.slips++;
+            late = 0;
+        }
+        pace.due = (late < PACE_MAX_BATCH) ? (late + 1) : PACE_MAX_BATCH;
+        if ((int32_t)(now - pace.second_us) >= 0) {
+            pace_report();
+        }
     }
+    pace.due--;
+    pace.next_us++;
+    pace.cycles++;
+}
+#endif
+
+// GCR image store in the second MB of flash, the rotor reads the tracks in
+// place through XIP (see c1541_insert_disc() and tests/c1541_gcrimg.c)
+#define GCRIMG_FLASH_OFFSET (1024 * 1024)
+#define GCRIMG_FLASH_SIZE (PICO_FLASH_SIZE_BYTES - GCRIMG_FLASH_OFFSET)
+#define GCRIMG_UPLOAD_TIMEOUT_US 1000000
+static uint8_t gcrimg_sector[FLASH_SECTOR_SIZE];
 
-    // ATN line (typically input-only for drive, but handle for completeness)
-    if (signals & IECLINE_ATN) {
-        gpio_set_dir(IEC_PIN_ATN, GPIO_IN);   // Release (inactive)
-    } else {
-        gpio_set_dir(IEC_PIN_ATN, GPIO_OUT);  // Pull low (active)
+// Insert the GCR image from the store, if there is a valid one
+void gcrimg_insert(void) {
+    const chips_range_t image = {
+        .ptr = (void*)(XIP_BASE + GCRIMG_FLASH_OFFSET),
+        .size = GCRIMG_FLASH_SIZE
+    };
+    if (c1541_gcrimg_check(image) && c1541_insert_disc(&state.c1541, image)) {
+        printf("c1541: GCR image in flash, %lu bytes\n", (unsigned long)((const c1541_gcrimg_header_t*)image.ptr)->size);
     }
+}
+
+static bool gcrimg_read(uint8_t* dst, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (!uart_is_readable_within_us(uart_default, GCRIMG_UPLOAD_TIMEOUT_US)) {
+            return false;
+        }
+        dst[i] = uart_getc(uart_default);
+    }
+    return true;
+}
+
+static void gcrimg_program(uint32_t offset) {
+#ifdef C1541_DUAL_CORE
+    // core 1 must not read flash while it is being written
+    multicore_lockout_start_blocking();
+#endif
+    const uint32_t irq = save_and_disable_interrupts();
+    flash_range_erase(GCRIMG_FLASH_OFFSET + offset, FLASH_SECTOR_SIZE);
+    flash_range_program(GCRIMG_FLASH_OFFSET + offset, gcrimg_sector, FLASH_SECTOR_SIZE);
+    restore_interrupts(irq);
+#ifdef C1541_DUAL_CORE
+    multicore_lockout_end_blocking();
+#endif
+}
 
-    // RESET line
-    if (signals & IECLINE_RESET) {
-        gpio_set_dir(IEC_PIN_RESET, GPIO_IN); // Release (inactive)
-    } else {
-        gpio_set_dir(IEC_PIN_RESET, GPIO_OUT);// Pull low (active)
+// Receive a GCR image on the UART (c1541_gcrimg -s) into the store, after its
+// first magic byte. Each flash sector is acknowledged with '.', the sender
+// waits for it, so no bytes arrive while the flash is erased and programmed.
+// The drive stands still meanwhile, like during a disk change.
+void gcrimg_upload(void) {
+    const c1541_gcrimg_header_t* hdr = (const c1541_gcrimg_header_t*)gcrimg_sector;
+    gcrimg_sector[0] = C1541_GCRIMG_MAGIC[0];
+    if (!gcrimg_read(gcrimg_sector + 1, sizeof(c1541_gcrimg_header_t) - 1) ||
+        (0 != memcmp(hdr->magic, C1541_GCRIMG_MAGIC, 8)) ||
+        (hdr->size < sizeof(c1541_gcrimg_header_t)) || (hdr->size > GCRIMG_FLASH_SIZE)) {
+        return;
     }
+    c1541_remove_disc(&state.c1541);
+    const uint32_t size = hdr->size;
+    bool ok = true;
+    for (uint32_t offset = 0; ok && (offset < size); offset += FLASH_SECTOR_SIZE) {
+        const uint32_t len = MIN(size - offset, FLASH_SECTOR_SIZE);
+        const uint32_t have = (0 == offset) ? sizeof(c1541_gcrimg_header_t) : 0;
+        ok = gcrimg_read(gcrimg_sector + have, len - have);
+        if (ok) {
+            memset(gcrimg_sector + len, 0xFF, FLASH_SECTOR_SIZE - len);
+            gcrimg_program(offset);
+            uart_putc_raw(uart_default, '.');
+        }
+    }
+    if (ok) {
+        gcrimg_insert();
+        ok = state.c1541.disk_loaded;
+    }
+    uart_puts(uart_default, ok ? "OK\n" : "ERR\n");
+}
 
-    // always input for now
-    gpio_set_dir(IEC_PIN_SRQ, GPIO_IN);
+#ifdef C1541_DUAL_CORE
+// core 1: disk rotor ahead of the drive CPU
+static void __not_in_flash_func(core1_main)(void) {
+    // GCR image uploads pause core 1 while they write the flash
+    multicore_lockout_victim_init();
+    while (true) {
+        c1541_rotor_poll(&state.rotor_link);
+    }
 }
+#endif
 
 int main(int argc, char **argv) {
-    struct timespec ts;
-    struct timespec sleep_ts;
-    long next_tick_ns = 0;
-    long current_ns = 0;
-    long last_ns = 0;
-    long start_ns = 0;
-    long run_ticks = 0;
-    long sleep_ns = 0;
-    long total_ns = 0;
-    c1541_desc_t floppy_desc;
-    const long ticks_per_sec = 1000000;
-    const long ns_per_sec = 1000000000;
-    const long ns_per_tick = ns_per_sec / ticks_per_sec;
-    uint8_t last_device_signals;
-    uint8_t device_signals;
-    long last_second_ns = 0;
-    long current_ticks_per_second;
-
-    sleep_ts.tv_sec = 0;
+    c1541_desc_t floppy_desc = {0};
 
     state.keep_running = true;
 
@@ -146,13 +334,17 @@ int main(int argc, char **argv) {
     floppy_desc.roms.e000_ffff.ptr = dump_1541_e000_901229_06aa_bin;
     floppy_desc.roms.e000_ffff.size = 8192;
     floppy_desc.iec_bus = NULL;
+    floppy_desc.storage = &state.c1541_storage;
+#ifdef C1541_ENABLE_PERF
+    c1541_perf_reset(&state.perf);
+    floppy_desc.perf = &state.perf;
+#endif
 
     uint tick = 0;
     uint ftick = 0;
-    uint out_signals = 0;
-    uint in_signals = 0;
-    // Initialize RP2040 GPIOs for IEC bus (open collector logic)
-    init_iec_gpio();
+    uint out_dirs = 0;
+    // Initialize the IEC bus PIO state machines (open collector logic)
+    init_iec_pio();
     gpio_init(MOTOR_STATUS_PIN);
     gpio_set_dir(MOTOR_STATUS_PIN, 1); // output
     gpio_put(MOTOR_STATUS_PIN, drive_motor_status);
@@ -162,21 +354,55 @@ int main(int argc, char **argv) {
 
     c1541_init(&state.c1541, &floppy_desc);
     iecbus_device_t* host_iec = iec_connect(&state.c1541.iec_bus, false);
+    extern char __flash_binary_end;
+    CHIPS_ASSERT((uintptr_t)&__flash_binary_end <= (XIP_BASE + GCRIMG_FLASH_OFFSET));
+    gcrimg_insert();
+
+#ifdef C1541_DUAL_CORE
+    c1541_rotor_attach(&state.c1541, &state.rotor_link);
+    multicore_launch_core1(core1_main);
+#endif
+#ifdef C1541_REALTIME
+    pace_init();
+#endif
 
     do {
-      // Read IEC incoming signals from GPIOs and update the IEC bus
+#ifdef C1541_REALTIME
+      pace_cycle();
+#endif
+      // Read IEC incoming signals from the sampler FIFO and update the IEC bus
       iec_set_from_host_signals(read_iec_signals());
+      cycle_trace(">drive");
       c1541_tick(&state.c1541);
+      cycle_trace("<drive");
       //if((tick&0xfffff)==0) printf("%d %d %04x\n", tick, state.c1541.iec_bus->master_tick, state.c1541.cpu.PC);
       tick++;
 
-      const uint in_new_signals = iec_get_signals(state.c1541.iec_bus);
-      const uint out_new_signals = iec_get_drive_out_signals();
-      if((out_new_signals != out_signals) || (in_new_signals != in_signals)) {
-        out_signals = out_new_signals;
-        in_signals = in_new_signals;
-        //printf("1541 iec output - DATA(%d) CLK(%d), input - ATN(%d) DATA(%d) CLK(%d)\n", IEC_DATA_ACTIVE(out_signals), IEC_CLK_ACTIVE(out_signals), IEC_ATN_ACTIVE(in_signals), IEC_DATA_ACTIVE(in_signals), IEC_CLK_ACTIVE(in_signals));
-        write_iec_signals(out_new_signals);
+#if defined(C1541_REALTIME) || defined(C1541_XIP_STATS) || defined(C1541_ENABLE_PERF)
+      if (report.pos != report.len) {
+        report_out();
+      }
+#endif
+#ifdef C1541_XIP_STATS
+      if (0 == (tick & 0xFFFFF)) {
+        xip_report();
+      }
+#endif
+#ifdef C1541_ENABLE_PERF
+      if (0x80000 == (tick & 0xFFFFF)) {
+        perf_report();
+      }
+#endif
+      // GCR image upload on the UART, see gcrimg_upload()
+      if ((0 == (tick & 0xFFFF)) && uart_is_readable(uart_default) &&
+          (C1541_GCRIMG_MAGIC[0] == uart_getc(uart_default))) {
+        gcrimg_upload();
+      }
+      // the ATN acknowledge is done by iec_out, so only drive output changes need a write
+      const uint out_new_dirs = iec_get_drive_pio_dirs();
+      if (out_new_dirs != out_dirs) {
+        out_dirs = out_new_dirs;
+        write_iec_signals(out_dirs);
       }
       //_c1541_debug_out_processor_pc(tick, &state.c1541, state.c1541.pins, state.c1541.via_1.pins);
       cycle_info("tick "); // rp2040js catches these and ticks the c64 emulation
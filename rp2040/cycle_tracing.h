@@ -1,3 +1,5 @@
+// Marker for rp2040js: a branch over a magic word and the tag string, the
+// code after an odd length tag is realigned to the instruction size
 #ifndef __riscv
 #define PROF_TP(tag,tp,par) \
   __asm__ __volatile__ ( \
@@ -5,6 +7,7 @@
     "b 1f\n\t" \
     ".word 0xffffabcd\n\t" \
     ".asciz "#tag"\n\t" \
+    ".balign 2\n\t" \
     "1:\n\t" \
   );
 #else
@@ -13,6 +16,7 @@
     "j 1f\n\t" \
     ".word 0xffffabcd\n\t" \
     ".asciz "#tag"\n\t" \
+    ".balign 2\n\t" \
     "1:\n\t" \
   );
 #endif
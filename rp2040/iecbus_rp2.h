@@ -24,6 +24,7 @@ typedef struct {
 
 static uint iecbus_host_signals = 0;
 static uint iecbus_drive_signals = 0;
+static uint32_t iecbus_edge_count = 0;
 
 iecbus_device_t* iec_connect(iecbus_t** iec_bus, bool have_atna_logic) {};
 void iec_disconnect(iecbus_t* iec_bus, iecbus_device_t* iec_device) {};
@@ -37,26 +38,39 @@ uint8_t iec_get_signals(iecbus_t* iec_bus) {
 };
 
 void iec_set_signals(iecbus_t* iec_bus, iecbus_device_t* iec_device, uint8_t signals) {
-    iecbus_drive_signals = signals;
+    if (iecbus_drive_signals != signals) {
+        iecbus_drive_signals = signals;
+        iecbus_edge_count++;
+    }
 };
 
+uint32_t iec_get_edge_count(iecbus_t* iec_bus) {
+    return iecbus_edge_count;
+}
+
 void iec_set_from_host_signals(uint8_t signals) {
-    iecbus_host_signals = signals;
+    if (iecbus_host_signals != signals) {
+        iecbus_host_signals = signals;
+        iecbus_edge_count++;
+    }
 }
 
-uint8_t iec_get_drive_out_signals() {
-    if (IEC_ATN_ACTIVE(iecbus_host_signals & iecbus_drive_signals) ^ IEC_ATNA_ACTIVE(iecbus_drive_signals)) {
-        return iecbus_drive_signals & ~IECLINE_DATA;
+// DATA/CLK pin directions for the iec_out PIO program (1 = pull low), bits 0..1
+// while ATN is released and bits 2..3 while ATN is asserted (ATNA acknowledge)
+uint8_t iec_get_drive_pio_dirs() {
+    const uint8_t dirs = ~iecbus_drive_signals & (IECLINE_DATA|IECLINE_CLK);
+    if (IEC_ATNA_ACTIVE(iecbus_drive_signals)) {
+        return (dirs | IECLINE_DATA) | (dirs << 2);
     }
-    return iecbus_drive_signals;
+    return dirs | ((dirs | IECLINE_DATA) << 2);
 }
 
 /*
 void iec_get_status_text(iecbus_t* iec_bus, char* dest);
 void iec_get_device_status_text(iecbus_device_t* iec_device, char* dest);
 void iec_debug_print_device_signals(iecbus_device_t* device, char* prefix);
-void world_tick();
-uint64_t get_world_tick();
+void world_tick(iecbus_t *iec_bus);
+uint64_t get_world_tick(iecbus_t *iec_bus);
 void set_master_tick(iecbus_t *iec_bus);
 void clear_master_tick(iecbus_t *iec_bus);
 */
@@ -25,6 +25,35 @@
     - chips/m6522.h
     - chips/mem.h
 
+    c1541_desc_t.device_number (8..11) sets the device number jumpers the
+    DOS reads from VIA1 PB5/PB6, so several drives can share one IEC bus
+    (see c64_desc_t.num_drives in c64.h).
+
+    Define C1541_ENABLE_PERF to measure the host time of the stages of
+    c1541_tick() (CPU, VIA1, VIA2/rotor, track fetch) into the accumulating
+    counters and log2 histograms of a c1541_perf_t (c1541_desc_t.perf). This
+    costs two timer reads per stage and tick, so it is compiled out by default.
+
+    Define C1541_ENABLE_TIMELINE to record LED, motor, head and IEC bus
+    activity into a timeline_t (c1541_desc_t.timeline) for a Chrome
+    trace_event JSON export, see timeline.h.
+
+    Define C1541_ENABLE_ROTOR_CORE to run the disk rotor (GCR shift register,
+    SYNC detection and byte latch) on another core, e.g. core 1 of the
+    RP2040. c1541_rotor_attach() connects a c1541_rotor_link_t, the other core
+    calls c1541_rotor_poll() in a loop. The rotor core runs up to
+    C1541_ROTOR_LINK_CYCLES drive cycles ahead with the current motor, read
+    mode, bit rate and track, c1541_tick() consumes one precomputed cycle per
+    tick. When the CPU changes one of these, the drive core restarts the rotor
+    core from the current cycle and waits for it, so the result stays cycle
+    for cycle the same as without the split.
+
+    c1541_insert_disc() inserts a GCR image: all half-tracks pre-encoded, each
+    0-terminated, behind a c1541_gcrimg_header_t. The rotor reads the tracks
+    in place, so the image can stay in flash (e.g. through the RP2040 XIP
+    window) and a track change only moves a pointer. c1541_gcrimg_build()
+    creates one from a D64 or G64 file (see tests/c1541_gcrimg.c).
+
     ## zlib/libpng license
 
     Copyright (c) 2019 Andre Weissflog
@@ -48,8 +77,21 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdalign.h>
 #include "iecbus.h"
 #include "disk_helpers.h"
+#ifdef C1541_ENABLE_TRACE
+#include "trace.h"
+#endif
+#ifdef C1541_ENABLE_PROFILE
+#include "rom_prof.h"
+#endif
+#ifdef C1541_ENABLE_TIMELINE
+#include "timeline.h"
+#endif
+#ifdef C1541_ENABLE_ROTOR_CORE
+#include <stdatomic.h>
+#endif
 // #include "disass.h"
 
 #ifdef __cplusplus
@@ -67,6 +109,18 @@ extern "C" {
 #ifndef C1541_TRACK_CHANGED_HOOK
 #define C1541_TRACK_CHANGED_HOOK(s,v)
 #endif
+#ifndef C1541_BYTE_READY_HOOK
+// called when a GCR byte is latched with BYTE READY (CA1, SO) enabled
+#define C1541_BYTE_READY_HOOK(s)
+#endif
+#ifndef C1541_ROTOR_WAIT_HOOK
+// called while the drive core waits for the rotor core (e.g. sched_yield())
+#define C1541_ROTOR_WAIT_HOOK(s)
+#endif
+#ifndef C1541_TICK_HOOK
+// called at the start of each c1541_tick() (e.g. to log or feed the IEC inputs)
+#define C1541_TICK_HOOK(s)
+#endif
 
 #define VIA2_STEPPER_LO_BIT_POS  0
 #define VIA2_STEPPER_HI_BIT_POS  1
@@ -96,10 +150,156 @@ extern "C" {
 #define C1541_SET_DATA(pins,sys,data) M6502_SET_DATA(pins,data)
 #endif
 
+#ifdef C1541_ENABLE_PERF
+// stages of c1541_tick() with host time measurement
+typedef enum {
+    C1541_PERF_TICK,            // all of c1541_tick()
+    C1541_PERF_CPU,             // CPU tick including memory and VIA register accesses
+    C1541_PERF_VIA1,            // full VIA1 ticks (IEC), skipped lazy ticks are not counted
+    C1541_PERF_VIA2,            // VIA2 tick with rotor/GCR and stepper (including track fetches)
+    C1541_PERF_TRACK_FETCH,     // c1541_fetch_track()
+    C1541_PERF_NUM_STAGES,
+} c1541_perf_stage_t;
+
+#define C1541_PERF_HIST_BUCKETS (16)
+
+// host time of one stage, in timer ticks (see c1541_perf_t.frequency)
+typedef struct {
+    uint64_t count;
+    uint64_t total;
+    uint32_t min;
+    uint32_t max;
+    // bucket 0: 0 ticks, bucket n: [2^(n-1), 2^n) ticks, the last one is open-ended
+    uint64_t hist[C1541_PERF_HIST_BUCKETS];
+} c1541_perf_counter_t;
+
+// owned by the caller, call c1541_perf_reset() before use
+typedef struct {
+    c1541_perf_counter_t stage[C1541_PERF_NUM_STAGES];
+    uint64_t frequency;         // timer ticks per second, set by c1541_perf_reset()
+} c1541_perf_t;
+#endif
+
+// drive activity counters, always on, see c1541_stats()
+typedef struct {
+    uint64_t half_track_steps;      // head movements, in half tracks
+    uint64_t track_fetches;         // c1541_fetch_track() calls
+    uint64_t track_fetch_ns;        // host time spent in track fetches
+    uint64_t track_fetch_max_ns;    // slowest track fetch
+    uint64_t syncs;                 // SYNC marks seen by the read electronics
+    uint64_t gcr_bytes;             // GCR bytes latched from the shift register
+    uint64_t byte_ready;            // latched bytes signalled to the CPU (BYTE READY)
+    uint64_t motor_on_cycles;       // drive cycles with the spindle motor on
+    // bytes of the standard serial protocol (a ready-to-send CLK release and
+    // 8 bit strobes), fast loaders with their own bit timing are not counted
+    uint64_t iec_bytes;
+    uint64_t atn_sequences;         // ATN asserted on the bus
+} c1541_stats_t;
+
+// disk rotor read state, advanced once per drive cycle
+typedef struct {
+    uint32_t nanoseconds_counter;
+    uint16_t gcr_byte_pos;
+    uint16_t current_data;      // last 10 bits under the head
+    uint8_t gcr_bit_pos;
+    uint8_t output_bit_counter;
+    uint8_t output_data;
+    bool gcr_sync;              // SYNC at the last bit, for c1541_stats_t.syncs
+} c1541_rotor_t;
+
+// result bits of one rotor cycle
+#define C1541_ROTOR_SYNC        (1<<0)  // SYNC (10 one bits) under the head in read mode
+#define C1541_ROTOR_SYNC_EDGE   (1<<1)  // new SYNC at this bit
+#define C1541_ROTOR_LATCH       (1<<2)  // byte complete, latched into output_data
+
+#ifdef C1541_ENABLE_ROTOR_CORE
+#define C1541_ROTOR_LINK_CYCLES (256)
+
+// rotor state and inputs from a drive cycle on
+typedef struct {
+    uint32_t cycle;
+    c1541_rotor_t rotor;
+    const uint8_t* gcr_bytes;
+    uint32_t gcr_size;
+    uint32_t nanoseconds_per_bit;
+    bool motor_active;
+    bool output_enable;
+} c1541_rotor_restart_t;
+
+// one precomputed rotor cycle
+typedef struct {
+    c1541_rotor_t rotor;        // state after the cycle
+    uint8_t flags;              // C1541_ROTOR_*
+} c1541_rotor_cycle_t;
+
+// shared between the drive core and the rotor core, see c1541_rotor_attach()
+typedef struct {
+    // written by the drive core
+    alignas(64) _Atomic uint32_t gen;   // incremented with each restart
+    _Atomic uint32_t tail;              // next cycle the drive consumes
+    c1541_rotor_restart_t restart;
+    uint32_t restarts;                  // restarts posted (bit rate, motor, mode, track changes)
+    uint32_t stalls;                    // cycles the drive core had to wait for
+    // written by the rotor core
+    alignas(64) _Atomic uint32_t ack;   // gen of the restart in use
+    _Atomic uint32_t head;              // next cycle the rotor core computes
+    c1541_rotor_restart_t cur;
+    c1541_rotor_cycle_t cycles[C1541_ROTOR_LINK_CYCLES];
+} c1541_rotor_link_t;
+#endif
+
+// bulk data of a c1541_t, allocated separately so that the per-tick state
+// of many drive instances can be packed closely
+typedef struct {
+    uint8_t gcr_bytes[0x2000];  // current track, 0-terminated
+    char disk_filename[256];    // attached D64/G64 file
+    mem_t mem;                  // memory map of RAM and ROM
+} c1541_storage_t;
+
+// GCR image for c1541_insert_disc(), little-endian, 4-byte aligned
+#define C1541_GCRIMG_MAGIC "C1541GCR"
+#define C1541_GCRIMG_VERSION (1)
+#define C1541_GCRIMG_HALF_TRACKS (84)   // half-tracks 2..85 (track 1..42.5)
+typedef struct {
+    char magic[8];
+    uint32_t size;              // image size in bytes, including this header
+    uint32_t hash;              // chips_hash() of the bytes behind the header
+    uint16_t version;
+    uint16_t num_half_tracks;   // C1541_GCRIMG_HALF_TRACKS
+    struct {
+        uint32_t offset;        // from the image start, 0 = empty half-track
+        uint32_t size;          // GCR bytes, followed by a 0 byte
+    } tracks[C1541_GCRIMG_HALF_TRACKS];
+} c1541_gcrimg_header_t;
+
 // config params for c1541_init()
 typedef struct {
     // the IEC bus to connect to
     iecbus_t* iec_bus;
+    // optional storage for the bulk data (e.g. from a pool), must stay valid
+    // until c1541_discard(), allocated with malloc() if not provided
+    c1541_storage_t* storage;
+    // reference the ROM images instead of copying them, they must stay valid
+    // and unchanged until c1541_discard()
+    bool shared_roms;
+    // IEC device number 8..11 (default 8), read by the DOS from the VIA1 PB5/PB6 jumpers
+    uint8_t device_number;
+    #ifdef C1541_ENABLE_TRACE
+    // optional instruction trace
+    trace_t* trace;
+    #endif
+    #ifdef C1541_ENABLE_PROFILE
+    // optional ROM routine profiler, see c1541_prof_add_routines() in c1541_debug.h
+    rom_prof_t* prof;
+    #endif
+    #ifdef C1541_ENABLE_PERF
+    // optional per-stage host time counters
+    c1541_perf_t* perf;
+    #endif
+    #ifdef C1541_ENABLE_TIMELINE
+    // optional drive and IEC bus activity timeline
+    timeline_t* timeline;
+    #endif
     // rom images
     struct {
         chips_range_t c000_dfff;
@@ -109,42 +309,66 @@ typedef struct {
 
 // 1541 emulator state
 typedef struct {
-    uint64_t pins;
-    iecbus_t* iec_bus;
-    iecbus_device_t* iec_device;
-    m6502_t cpu;
-    m6522_t via_1;
-    m6522_t via_2;
-    bool valid;
-    mem_t mem;
-    uint8_t ram[0x0800];
-    uint8_t rom[0x4000];
-    uint32_t rotor_nanoseconds_counter;
+    // per-tick state, keep within two cache lines (see tests/c1541_layout.c)
+    alignas(64) uint64_t pins;
     uint32_t nanoseconds_per_bit;
-    bool rotor_active;
-    uint8_t gcr_bytes[0x2000];
     uint32_t gcr_size;
-    uint16_t gcr_byte_pos;
-    uint8_t gcr_bit_pos;
+    const uint8_t* gcr_bytes;   // current track in storage
+    const uint8_t* rom[2];      // 8 KB ROMs at 0xC000 and 0xE000, either rom_copy or caller-owned
+    iecbus_t* iec_bus;
+    iecbus_device_t* iec_device;
+    uint32_t via1_iec_edges;    // IEC bus edge count at the last full VIA1 tick
+    int byte_ready_countdown;
+    c1541_rotor_t rotor;
     uint8_t gcr_ones;
     uint8_t current_byte;
     uint8_t current_bit_pos;
-    bool gcr_sync;
-
-    uint16_t current_data;
-    uint8_t output_data;
-    uint8_t output_bit_counter;
-    int byte_ready_countdown;
-
     uint8_t half_track;          // Track 1 = 0b10=2, Track 1.5 = 0b11=3, Track 2 = 0b100=4, ...
     uint8_t stepper_position;    // 0..3
     uint8_t coil_dir;            // 0..1
+    bool rotor_active;
+    bool via1_dirty;            // VIA1 needs a full tick, see _c1541_tick_via1()
 
-    char disk_filename[256];
-    bool disk_loaded;
-    uint8_t disk_type;  // 0=none, 1=G64, 2=D64
+    // chips and RAM
+    m6502_t cpu;
+    m6522_t via_1;
+    m6522_t via_2;
+    uint8_t ram[0x0800];
 
+    // cold state
+    bool valid;
+    bool owns_storage;
+    bool disk_loaded;
+    uint8_t disk_type;  // 0=none, 1=G64, 2=D64, 3=GCR image
+    const uint8_t* gcr_image;   // inserted GCR image (caller-owned)
+    uint8_t* rom_copy;          // 16 KB ROM copy, only allocated without shared ROMs
+    uint32_t rom_hash;          // identifies the ROM in snapshots
     uint32_t exit_countdown;
+    uint8_t device_number;      // IEC device number, 8..11
+    uint8_t iec_lines;          // IEC lines at the last full VIA1 tick
+    int8_t iec_bit;             // serial protocol bit, -1 while waiting for ready-to-send
+    c1541_stats_t stats;
+    #ifdef C1541_ENABLE_TRACE
+    trace_t* trace;
+    uint64_t trace_cycle;
+    #endif
+    #ifdef C1541_ENABLE_PROFILE
+    rom_prof_t* prof;
+    uint64_t prof_cycle;
+    #endif
+    #ifdef C1541_ENABLE_PERF
+    c1541_perf_t* perf;
+    #endif
+    #ifdef C1541_ENABLE_TIMELINE
+    timeline_t* timeline;
+    uint64_t timeline_cycle;
+    #endif
+    #ifdef C1541_ENABLE_ROTOR_CORE
+    c1541_rotor_link_t* rotor_link;
+    uint32_t rotor_cycle;       // next rotor cycle to consume
+    bool rotor_dirty;           // rotor state changed outside of the rotor, restart the rotor core
+    #endif
+    c1541_storage_t* storage;
 } c1541_t;
 
 // initialize a new c1541_t instance
@@ -155,18 +379,41 @@ void c1541_discard(c1541_t* sys);
 void c1541_reset(c1541_t* sys);
 // tick a c1541_t instance forward
 void c1541_tick(c1541_t* sys);
-// insert a disc image file (.d64)
-void c1541_insert_disc(c1541_t* sys, chips_range_t data);
+// insert a GCR image (must stay valid until removed), false if it is broken
+bool c1541_insert_disc(c1541_t* sys, chips_range_t data);
+// check the header, track table and hash of a GCR image
+bool c1541_gcrimg_check(chips_range_t data);
+// convert a .d64 or .g64 file into a GCR image, returns its size or 0
+size_t c1541_gcrimg_build(const char* filename, uint8_t* dst, size_t dst_size);
 // remove current disc
 void c1541_remove_disc(c1541_t* sys);
 // prepare a c1541_t snapshot for saving
-void c1541_snapshot_onsave(c1541_t* snapshot, void* base);
+void c1541_snapshot_onsave(c1541_t* snapshot, c1541_t* sys, void* base);
 // prepare a c1541_t snapshot for loading
 void c1541_snapshot_onload(c1541_t* snapshot, c1541_t* sys, void* base);
 // attach disk image file (quick validation only, stores filename)
 bool c1541_attach_disk(c1541_t* sys, const char* filename);
 // fetch track data for current half-track position (opens file, reads offsets, reads track)
 bool c1541_fetch_track(c1541_t* sys);
+// drive LED and spindle motor state (VIA2 port B outputs)
+bool c1541_led_on(const c1541_t* sys);
+bool c1541_motor_on(const c1541_t* sys);
+// get the drive activity counters
+const c1541_stats_t* c1541_stats(const c1541_t* sys);
+// clear the drive activity counters
+void c1541_stats_reset(c1541_t* sys);
+#ifdef C1541_ENABLE_ROTOR_CORE
+// run the rotor on another core from now on, the link must stay valid until c1541_discard()
+void c1541_rotor_attach(c1541_t* sys, c1541_rotor_link_t* link);
+// rotor core: apply a restart or compute one cycle ahead, false if there was nothing to do
+bool c1541_rotor_poll(c1541_rotor_link_t* link);
+#endif
+#ifdef C1541_ENABLE_PERF
+// clear the per-stage host time counters, start the timer and measure its frequency
+void c1541_perf_reset(c1541_perf_t* perf);
+// print the per-stage host time counters
+void c1541_perf_write(const c1541_perf_t* perf, FILE* fp);
+#endif
 
 #ifdef __cplusplus
 } // extern "C"
@@ -175,6 +422,9 @@ bool c1541_fetch_track(c1541_t* sys);
 /*-- IMPLEMENTATION ----------------------------------------------------------*/
 #ifdef CHIPS_IMPL
 #include <string.h>
+#ifndef PICO
+#include <time.h>
+#endif
 #ifndef CHIPS_ASSERT
     #include <assert.h>
     #define CHIPS_ASSERT(c) assert(c)
@@ -182,22 +432,91 @@ bool c1541_fetch_track(c1541_t* sys);
 
 const uint32_t c1541_speedzone[] = { 4000, 3750, 3500, 3250 }; // nanoseconds per bit
 
+#ifdef C1541_ENABLE_PERF
+// stage timer: SysTick on the RP2040 (24 bit down counter at the system clock),
+// TSC on x86, CLOCK_MONOTONIC elsewhere
+#if defined(PICO) || (defined(PICO_ON_DEVICE) && PICO_ON_DEVICE)
+#define _C1541_PERF_SYSTICK
+#include "hardware/structs/systick.h"
+#include "hardware/clocks.h"
+#define _C1541_PERF_NOW() ((uint32_t)systick_hw->cvr)
+#define _C1541_PERF_ELAPSED(t0,t1) (((t0) - (t1)) & 0x00FFFFFF)
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#include <time.h>
+#define _C1541_PERF_NOW() ((uint32_t)__rdtsc())
+#define _C1541_PERF_ELAPSED(t0,t1) ((uint32_t)((t1) - (t0)))
+#else
+#include <time.h>
+static inline uint32_t _c1541_perf_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+#define _C1541_PERF_NOW() _c1541_perf_now()
+#define _C1541_PERF_ELAPSED(t0,t1) ((uint32_t)((t1) - (t0)))
+#endif
+
+static void _c1541_perf_add(c1541_perf_counter_t* c, uint32_t ticks) {
+    c->count++;
+    c->total += ticks;
+    if (ticks < c->min) {
+        c->min = ticks;
+    }
+    if (ticks > c->max) {
+        c->max = ticks;
+    }
+    uint32_t bucket = ticks ? (32 - __builtin_clz(ticks)) : 0;
+    if (bucket >= C1541_PERF_HIST_BUCKETS) {
+        bucket = C1541_PERF_HIST_BUCKETS - 1;
+    }
+    c->hist[bucket]++;
+}
+
+#define _C1541_PERF_BEGIN(t) const uint32_t t = _C1541_PERF_NOW()
+#define _C1541_PERF_END(sys,st,t) if ((sys)->perf) { _c1541_perf_add(&(sys)->perf->stage[st], _C1541_PERF_ELAPSED(t, _C1541_PERF_NOW())); }
+#else
+#define _C1541_PERF_BEGIN(t)
+#define _C1541_PERF_END(sys,st,t)
+#endif
+
+#ifdef C1541_ENABLE_TIMELINE
+#define _C1541_TIMELINE(sys,type,value) if ((sys)->timeline) { timeline_push((sys)->timeline, (sys)->timeline_cycle, (sys)->device_number, type, value); }
+#else
+#define _C1541_TIMELINE(sys,type,value)
+#endif
+
+#ifdef C1541_ENABLE_ROTOR_CORE
+#define _C1541_ROTOR_DIRTY(sys) (sys)->rotor_dirty = true
+#else
+#define _C1541_ROTOR_DIRTY(sys)
+#endif
+
 void c1541_init(c1541_t* sys, const c1541_desc_t* desc) {
     CHIPS_ASSERT(sys && desc);
 
     memset(sys, 0, sizeof(c1541_t));
     sys->valid = true;
+    if (desc->storage) {
+        sys->storage = desc->storage;
+    }
+    else {
+        sys->storage = malloc(sizeof(c1541_storage_t));
+        CHIPS_ASSERT(sys->storage);
+        sys->owns_storage = true;
+    }
+    sys->gcr_bytes = sys->storage->gcr_bytes;
     // Initialize as empty drive
-    sys->disk_filename[0] = '\0';
+    sys->storage->disk_filename[0] = '\0';
     sys->disk_loaded = false;
     sys->disk_type = 0;
     sys->gcr_size = 0;
-    sys->gcr_bytes[0] = 0;
-    sys->gcr_byte_pos = 0;
-    sys->gcr_bit_pos = 0;
+    sys->storage->gcr_bytes[0] = 0;
+    sys->rotor.gcr_byte_pos = 0;
+    sys->rotor.gcr_bit_pos = 0;
     sys->current_byte = 0;
     sys->current_bit_pos = 0;
-    sys->rotor_nanoseconds_counter = 0;
+    sys->rotor.nanoseconds_counter = 0;
     sys->rotor_active = 1;
     const uint8_t initial_full_track = 18;
     sys->nanoseconds_per_bit = c1541_speedzone[2];
@@ -206,12 +525,44 @@ void c1541_init(c1541_t* sys, const c1541_desc_t* desc) {
     // copy ROM images
     CHIPS_ASSERT(desc->roms.c000_dfff.ptr && (0x2000 == desc->roms.c000_dfff.size));
     CHIPS_ASSERT(desc->roms.e000_ffff.ptr && (0x2000 == desc->roms.e000_ffff.size));
-    memcpy(&sys->rom[0x0000], desc->roms.c000_dfff.ptr, 0x2000);
-    memcpy(&sys->rom[0x2000], desc->roms.e000_ffff.ptr, 0x2000);
+    if (desc->shared_roms) {
+        sys->rom[0] = desc->roms.c000_dfff.ptr;
+        sys->rom[1] = desc->roms.e000_ffff.ptr;
+    }
+    else {
+        sys->rom_copy = malloc(0x4000);
+        CHIPS_ASSERT(sys->rom_copy);
+        memcpy(&sys->rom_copy[0x0000], desc->roms.c000_dfff.ptr, 0x2000);
+        memcpy(&sys->rom_copy[0x2000], desc->roms.e000_ffff.ptr, 0x2000);
+        sys->rom[0] = &sys->rom_copy[0x0000];
+        sys->rom[1] = &sys->rom_copy[0x2000];
+    }
+    sys->rom_hash = chips_hash(chips_hash(CHIPS_HASH_INIT, sys->rom[0], 0x2000), sys->rom[1], 0x2000);
+    #ifdef C1541_ENABLE_TRACE
+    sys->trace = desc->trace;
+    #endif
+    #ifdef C1541_ENABLE_PROFILE
+    sys->prof = desc->prof;
+    #endif
+    #ifdef C1541_ENABLE_PERF
+    sys->perf = desc->perf;
+    #endif
+    #ifdef C1541_ENABLE_TIMELINE
+    sys->timeline = desc->timeline;
+    #endif
+    sys->iec_lines = 0xFF;
+    sys->iec_bit = -1;
+    sys->device_number = desc->device_number ? desc->device_number : 8;
+    CHIPS_ASSERT((sys->device_number >= 8) && (sys->device_number <= 11));
 
     // initialize the hardware
     m6502_desc_t cpu_desc;
     memset(&cpu_desc, 0, sizeof(cpu_desc));
+#ifdef HAVE_C1541_M6502H
+    cpu_desc.ram = sys->ram;
+    cpu_desc.rom[0] = sys->rom[0];
+    cpu_desc.rom[1] = sys->rom[1];
+#endif
     sys->pins = m6502_init(&sys->cpu, &cpu_desc);
     m6522_init(&sys->via_1);
     m6522_init(&sys->via_2);
@@ -220,13 +571,15 @@ void c1541_init(c1541_t* sys, const c1541_desc_t* desc) {
     // to the stepper once the motor gets turned off...)
     M6522_SET_PAB(sys->via_2.pins, 0x00, 0x04);
 
+    sys->via1_dirty = true;
     sys->via_1.chip_name = "via1";
     sys->via_2.chip_name = "via2";
 
     // setup memory map
-    mem_init(&sys->mem);
-    mem_map_ram(&sys->mem, 0, 0x0000, 0x0800, sys->ram);
-    mem_map_rom(&sys->mem, 0, 0xC000, 0x4000, sys->rom);
+    mem_init(&sys->storage->mem);
+    mem_map_ram(&sys->storage->mem, 0, 0x0000, 0x0800, sys->ram);
+    mem_map_rom(&sys->storage->mem, 0, 0xC000, 0x2000, sys->rom[0]);
+    mem_map_rom(&sys->storage->mem, 0, 0xE000, 0x2000, sys->rom[1]);
 
     // use iec_bus instance if we got passed one
     if(desc->iec_bus) {
@@ -244,6 +597,13 @@ void c1541_discard(c1541_t* sys) {
     c1541_remove_disc(sys);
     iec_disconnect(sys->iec_bus, sys->iec_device);
     sys->iec_device = NULL;
+    if (sys->owns_storage) {
+        free(sys->storage);
+    }
+    sys->storage = NULL;
+    sys->gcr_bytes = NULL;
+    free(sys->rom_copy);
+    sys->rom_copy = NULL;
     sys->valid = false;
 }
 
@@ -252,6 +612,7 @@ void c1541_reset(c1541_t* sys) {
     sys->pins |= M6502_RES;
     m6522_reset(&sys->via_1);
     m6522_reset(&sys->via_2);
+    sys->via1_dirty = true;
 }
 
 void _c1541_write(c1541_t* sys, uint16_t addr, uint8_t data) {
@@ -260,12 +621,14 @@ void _c1541_write(c1541_t* sys, uint16_t addr, uint8_t data) {
     if (uc7_input == 0x18) {
         // Write to VIA1
         _m6522_write(&sys->via_1, addr & 0xF, data);
+        sys->via1_dirty = true;
     } else if (uc7_input == 0x1C) {
         // Write to VIA2
         if ((addr & 0xf) == 0) {
             sys->rotor_active = (data & VIA2_ROTOR) != 0;
             if (!sys->rotor_active) {
-                sys->rotor_nanoseconds_counter = 0;
+                sys->rotor.nanoseconds_counter = 0;
+                _C1541_ROTOR_DIRTY(sys);
             }
 
             sys->nanoseconds_per_bit = c1541_speedzone[(data >> 5) & 3];
@@ -273,9 +636,11 @@ void _c1541_write(c1541_t* sys, uint16_t addr, uint8_t data) {
             uint changed_bits = sys->via_2.pb.outr ^ data;
             if(changed_bits & 0b1000) {
                 C1541_LED_CHANGED_HOOK(sys, !!(data & 0b1000));
+                _C1541_TIMELINE(sys, TIMELINE_LED, !!(data & 0b1000));
             }
             if(changed_bits & 0b100) {
                 C1541_MOTOR_CHANGED_HOOK(sys, !!(data & 0b100));
+                _C1541_TIMELINE(sys, TIMELINE_MOTOR, !!(data & 0b100));
             }
         }
         _m6522_write(&sys->via_2, addr & 0xF, data);
@@ -305,9 +670,7 @@ void _c1541_write(c1541_t* sys, uint16_t addr, uint8_t data) {
   ((byte) & 0x01 ? '1' : '0')
 
 uint64_t _c1541_tick_cpu(c1541_t *sys, const uint64_t input_pins) {
-#ifdef PICO
-    uint32_t tick = get_ticks();
-#endif
+    _C1541_PERF_BEGIN(perf_t0);
     const bool is_cpu_sync = (input_pins & M6502_SYNC);
 
     // s0 pin high workaround for injecting OV flag to the cpu on a new instruction
@@ -316,24 +679,17 @@ uint64_t _c1541_tick_cpu(c1541_t *sys, const uint64_t input_pins) {
         m6502_set_p(&sys->cpu, m6502_p(&sys->cpu)|M6502_VF);
     }
 
-// #ifdef PICO
-//     uint32_t tick_cpu = get_ticks();
-// #endif
     // printf("cpu pc: $%04x\n", sys->cpu.PC);
-#ifdef PICO
-    uint32_t chip_tick = get_ticks();
-#endif
     uint64_t pins = m6502_tick(&sys->cpu, input_pins);
-#ifdef PICO
-    ticks_chip_cpu = get_elapsed_ticks(chip_tick);
-#endif
-// #ifdef PICO
-//     uint32_t dt_cpu = get_elapsed_ticks(tick_cpu);
-//     printf("chip_tick cpu: %ld sys tick(s)\n", dt_cpu);
-// #endif
 
     const uint16_t addr = C1541_GET_ADDR(pins, sys);
 
+#ifdef HAVE_C1541_M6502H
+    if (0 == (pins & M6502_IO)) {
+        // RAM and ROM accesses have already been done by the CPU
+    }
+    else
+#endif
     if (pins & M6502_RW) {
         // memory read
         bool valid_read = true;
@@ -342,13 +698,14 @@ uint64_t _c1541_tick_cpu(c1541_t *sys, const uint64_t input_pins) {
         const uint uc7_input = (addr >> 8) & 0b10011100;
         if (addr >= 0x8000) { // UC6
             // Read from ROM
-            read_data = sys->rom[addr & 0x3FFF];
+            read_data = sys->rom[(addr >> 13) & 1][addr & 0x1FFF];
         } else if (uc7_input == 0x18) {
             // Read from VIA1
             read_data = _m6522_read(&sys->via_1, addr & 0xF);
+            sys->via1_dirty = true;
             //	    // FIXME: debugging purpose
             //            if (addr == 0x1800) {
-            //                printf("%ld - 1541 - Read VIA1 $1800 = $%02X - CPU @ $%04X\n", get_world_tick(), read_data, _1541_last_cpu_address);
+            //                printf("%ld - 1541 - Read VIA1 $1800 = $%02X - CPU @ $%04X\n", get_world_tick(sys->iec_bus), read_data, _1541_last_cpu_address);
             //            }
         } else if (uc7_input == 0x1C) {
             // Read from VIA2
@@ -372,29 +729,95 @@ uint64_t _c1541_tick_cpu(c1541_t *sys, const uint64_t input_pins) {
         //         uint8_t write_data = C1541_GET_DATA(pins, sys);
         // //        // FIXME: debugging purpose
         // //        if (addr == 0x1800) {
-        // //            printf("%ld - 1541 - Write VIA1 $1800 = $%02X - CPU @ $%04X\n", get_world_tick(), write_data, _1541_last_cpu_address);
+        // //            printf("%ld - 1541 - Write VIA1 $1800 = $%02X - CPU @ $%04X\n", get_world_tick(sys->iec_bus), write_data, _1541_last_cpu_address);
         // //        }
         _c1541_write(sys, addr, C1541_GET_DATA(pins, sys));
     }
 
-#ifdef PICO
-    ticks_cpu = get_elapsed_ticks(tick);
-#endif
+    _C1541_PERF_END(sys, C1541_PERF_CPU, perf_t0);
     return pins;
 }
 
-// _c1541_tick_via1 returns if IRQ should be set
+/*
+    _c1541_tick_via1 returns if IRQ should be set
+
+    With the event driven m6522_fast.h, VIA1 only gets a full tick on
+    register accesses, IEC line edges and timer events (or while its
+    interrupt or input pipelines settle). All other ticks only advance
+    the VIA tick counter, the timer values are computed from that.
+*/
+#ifdef C1541_ENABLE_TIMELINE
+static uint8_t _c1541_timeline_iec(uint8_t iec_lines) {
+    return (IEC_ATN_ACTIVE(iec_lines) ? TIMELINE_IEC_ATN : 0) |
+           (IEC_CLK_ACTIVE(iec_lines) ? TIMELINE_IEC_CLK : 0) |
+           (IEC_DATA_ACTIVE(iec_lines) ? TIMELINE_IEC_DATA : 0);
+}
+#endif
+
+// count ATN sequences and bytes of the standard serial protocol
+static void _c1541_stats_iec(c1541_t* sys, uint8_t iec_lines) {
+    #ifdef C1541_ENABLE_TIMELINE
+    if (_c1541_timeline_iec(iec_lines) != _c1541_timeline_iec(sys->iec_lines)) {
+        _C1541_TIMELINE(sys, TIMELINE_IEC_LINES, _c1541_timeline_iec(iec_lines));
+    }
+    #endif
+    if (IEC_ATN_ACTIVE(iec_lines) != IEC_ATN_ACTIVE(sys->iec_lines)) {
+        if (IEC_ATN_ACTIVE(iec_lines)) {
+            sys->stats.atn_sequences++;
+        }
+        _C1541_TIMELINE(sys, TIMELINE_ATN, IEC_ATN_ACTIVE(iec_lines));
+        sys->iec_bit = -1;
+    } else if (IEC_CLK_ACTIVE(sys->iec_lines) && !IEC_CLK_ACTIVE(iec_lines)) {
+        // CLK released: ready-to-send, then one strobe per data bit
+        if (++sys->iec_bit == 8) {
+            sys->stats.iec_bytes++;
+            sys->iec_bit = -1;
+            _C1541_TIMELINE(sys, TIMELINE_IEC_BYTE, 0);
+        } else if (sys->iec_bit == 0) {
+            _C1541_TIMELINE(sys, TIMELINE_IEC_BYTE, 1);
+        }
+    }
+    sys->iec_lines = iec_lines;
+}
+
+// IEC line outputs of the VIA1 port B pins
+static inline uint8_t _c1541_iec_out_signals(uint64_t pins) {
+    uint8_t out_signals = ~0;
+    if (pins & M6522_PB3) {
+        out_signals &= ~IECLINE_CLK;
+    }
+    if (pins & M6522_PB1) {
+        out_signals &= ~IECLINE_DATA;
+    }
+    if (!(pins & M6522_PB4)) {
+        out_signals &= ~IECLINE_ATNA;
+    }
+    return out_signals;
+}
+
 uint8_t _c1541_tick_via1(c1541_t* sys) {
-#ifdef PICO
-    uint32_t tick = get_ticks();
+#ifdef HAVE_FAST_M6522H
+    const uint32_t iec_edges = iec_get_edge_count(sys->iec_bus);
+    if (!sys->via1_dirty && (iec_edges == sys->via1_iec_edges) && (sys->via_1.ticks != sys->via_1.next_event)) {
+        sys->via_1.ticks++;
+        return 0 != (sys->via_1.pins & M6522_IRQ);
+    }
+    // NOTE: taken before our own outputs are written to the bus, so
+    // that any change of them forces another full tick
+    sys->via1_iec_edges = iec_edges;
 #endif
+    _C1541_PERF_BEGIN(perf_t0);
     uint64_t pins = sys->via_1.pins;
 
     // 1. "Tick" the IEC bus (reflects back active outputs).
     uint8_t iec_lines = iec_get_signals(sys->iec_bus);
+    if (iec_lines != sys->iec_lines) {
+        _c1541_stats_iec(sys, iec_lines);
+    }
 
-    // 2. Write IEC signals to VIA inputs.
-    pins &= ~(M6522_PB0 | M6522_PB2 | M6522_PB7 | M6522_CA1);
+    // 2. Write IEC signals and the device number jumpers to VIA inputs.
+    pins &= ~(M6522_PB0 | M6522_PB2 | M6522_PB5 | M6522_PB6 | M6522_PB7 | M6522_CA1);
+    pins |= (uint64_t)(sys->device_number & 3) << M6522_PIN_PB5;    // PB5/PB6: device 8 + 0..3
     if (IEC_ATN_ACTIVE(iec_lines)) {
         pins |= M6522_PB7; // ATN IN
         pins |= M6522_CA1;
@@ -407,102 +830,193 @@ uint8_t _c1541_tick_via1(c1541_t* sys) {
     }
     // note ATNA logic (activates DATA dependent on ATN and PB4) gets handled by iecbus.h
 
+    #ifdef HAVE_FAST_M6522H
+    const uint64_t in_pins = pins;
+    #endif
+
     // 3. Tick VIA1
-    #ifdef PICO
-    uint32_t chip_tick = get_ticks();
-    pins = m6522_tick(&sys->via_1, pins);
-    ticks_chip_via1 = get_elapsed_ticks(chip_tick);
-    #else
     pins = m6522_tick(&sys->via_1, pins);
+    #ifdef HAVE_FAST_M6522H
+    {
+        // next tick gets the same IEC inputs unless the bus has an edge
+        const uint64_t iec_pins = M6522_PB0 | M6522_PB2 | M6522_PB7 | M6522_CA1;
+        sys->via1_dirty = !m6522_idle(&sys->via_1, (pins & ~iec_pins) | (in_pins & iec_pins));
+    }
     #endif
 
     // 4. Write VIA outputs to IEC bus.
-    uint8_t out_signals = ~0;
-    if (pins & M6522_PB3) {
-        out_signals &= ~IECLINE_CLK;
+    iec_set_signals(sys->iec_bus, sys->iec_device, _c1541_iec_out_signals(pins));
+
+    _C1541_PERF_END(sys, C1541_PERF_VIA1, perf_t0);
+    return 0 != (pins & M6522_IRQ);
+}
+
+// advance the disk rotor by one drive cycle, returns C1541_ROTOR_* bits
+static inline uint8_t _c1541_rotor_tick(c1541_rotor_t* r, const uint8_t* gcr_bytes, uint32_t gcr_size, uint32_t nanoseconds_per_bit, bool motor_active, bool output_enable) {
+    uint8_t flags = 0;
+    bool is_sync = (((r->current_data + 1) & (1<<10)) != 0) && output_enable;
+    if (motor_active) {
+        r->nanoseconds_counter += 1000;
+        if (r->nanoseconds_counter >= nanoseconds_per_bit) {
+            r->nanoseconds_counter -= nanoseconds_per_bit;
+
+            // shift in next gcr bit
+            r->current_data <<= 1;
+            r->current_data &= (1<<10)-1;
+            if (gcr_bytes[r->gcr_byte_pos] & (1<<(7-r->gcr_bit_pos))) {
+                // GCR 1 bit
+                r->current_data |= 1;
+            }
+
+            // update gcr read position
+            r->gcr_bit_pos++;
+            if (r->gcr_bit_pos > 7) {
+                r->gcr_bit_pos = 0;
+                r->gcr_byte_pos++;
+                if (r->gcr_byte_pos >= gcr_size || gcr_bytes[r->gcr_byte_pos] == 0) {
+                    r->gcr_byte_pos = 0;
+                }
+            }
+
+            is_sync = (((r->current_data + 1) & (1<<10)) != 0) && output_enable;
+            if (is_sync && !r->gcr_sync) {
+                flags |= C1541_ROTOR_SYNC_EDGE;
+            }
+            r->gcr_sync = is_sync;
+
+            if (is_sync) {
+                r->output_bit_counter = 0;
+            } else {
+                r->output_bit_counter++;
+                if (r->output_bit_counter > 7) {
+                    r->output_bit_counter = 0;
+                    r->output_data = r->current_data & 0xff;
+                    flags |= C1541_ROTOR_LATCH;
+                }
+            }
+        }
     }
-    if (pins & M6522_PB1) {
-        out_signals &= ~IECLINE_DATA;
+    if (is_sync) {
+        flags |= C1541_ROTOR_SYNC;
     }
-    if (!(pins & M6522_PB4)) {
-        out_signals &= ~IECLINE_ATNA;
+    return flags;
+}
+
+#ifdef C1541_ENABLE_ROTOR_CORE
+// restart the rotor core from the current cycle with the current state and inputs
+static void _c1541_rotor_restart(c1541_t* sys, bool motor_active, bool output_enable) {
+    c1541_rotor_link_t* link = sys->rotor_link;
+    link->restart = (c1541_rotor_restart_t){
+        .cycle = sys->rotor_cycle,
+        .rotor = sys->rotor,
+        .gcr_bytes = sys->gcr_bytes,
+        .gcr_size = sys->gcr_size,
+        .nanoseconds_per_bit = sys->nanoseconds_per_bit,
+        .motor_active = motor_active,
+        .output_enable = output_enable,
+    };
+    link->restarts++;
+    // NOTE: the rotor core copies the restart before it acks, and the next
+    // restart only happens after that, so the restart is not overwritten early
+    atomic_store_explicit(&link->gen, atomic_load_explicit(&link->gen, memory_order_relaxed) + 1, memory_order_release);
+    sys->rotor_dirty = false;
+}
+
+// take the current cycle from the rotor core, returns C1541_ROTOR_* bits
+static uint8_t _c1541_rotor_consume(c1541_t* sys, bool motor_active, bool output_enable) {
+    c1541_rotor_link_t* link = sys->rotor_link;
+    const c1541_rotor_restart_t* in = &link->restart;
+    if (sys->rotor_dirty || (motor_active != in->motor_active) || (output_enable != in->output_enable) ||
+        (sys->nanoseconds_per_bit != in->nanoseconds_per_bit) || (sys->gcr_bytes != in->gcr_bytes) || (sys->gcr_size != in->gcr_size))
+    {
+        _c1541_rotor_restart(sys, motor_active, output_enable);
+    }
+    const uint32_t gen = atomic_load_explicit(&link->gen, memory_order_relaxed);
+    const uint32_t cycle = sys->rotor_cycle;
+    // head is only valid once the rotor core acked the last restart
+    bool ready = (atomic_load_explicit(&link->ack, memory_order_acquire) == gen) &&
+                 ((int32_t)(atomic_load_explicit(&link->head, memory_order_acquire) - cycle) > 0);
+    if (!ready) {
+        link->stalls++;
+        do {
+            C1541_ROTOR_WAIT_HOOK(sys);
+            ready = (atomic_load_explicit(&link->ack, memory_order_acquire) == gen) &&
+                    ((int32_t)(atomic_load_explicit(&link->head, memory_order_acquire) - cycle) > 0);
+        } while (!ready);
     }
-    iec_set_signals(sys->iec_bus, sys->iec_device, out_signals);
+    const c1541_rotor_cycle_t* c = &link->cycles[cycle & (C1541_ROTOR_LINK_CYCLES - 1)];
+    sys->rotor = c->rotor;
+    const uint8_t flags = c->flags;
+    sys->rotor_cycle = cycle + 1;
+    atomic_store_explicit(&link->tail, cycle + 1, memory_order_release);
+    return flags;
+}
+
+void c1541_rotor_attach(c1541_t* sys, c1541_rotor_link_t* link) {
+    CHIPS_ASSERT(sys && sys->valid && link);
+    memset(link, 0, sizeof(c1541_rotor_link_t));
+    sys->rotor_link = link;
+    sys->rotor_cycle = 0;
+    sys->rotor_dirty = true;
+}
 
+bool
 #ifdef PICO
-    ticks_via1 = get_elapsed_ticks(tick);
+__not_in_flash_func(c1541_rotor_poll)
+#else
+c1541_rotor_poll
 #endif
-    return 0 != (pins & M6522_IRQ);
+(c1541_rotor_link_t* link) {
+    const uint32_t gen = atomic_load_explicit(&link->gen, memory_order_acquire);
+    if (gen == 0) {
+        // no restart posted yet
+        return false;
+    }
+    if (gen != atomic_load_explicit(&link->ack, memory_order_relaxed)) {
+        link->cur = link->restart;
+        atomic_store_explicit(&link->head, link->cur.cycle, memory_order_relaxed);
+        atomic_store_explicit(&link->ack, gen, memory_order_release);
+        return true;
+    }
+    const uint32_t cycle = atomic_load_explicit(&link->head, memory_order_relaxed);
+    if ((cycle - atomic_load_explicit(&link->tail, memory_order_acquire)) >= C1541_ROTOR_LINK_CYCLES) {
+        return false;
+    }
+    c1541_rotor_restart_t* cur = &link->cur;
+    c1541_rotor_cycle_t* c = &link->cycles[cycle & (C1541_ROTOR_LINK_CYCLES - 1)];
+    c->flags = _c1541_rotor_tick(&cur->rotor, cur->gcr_bytes, cur->gcr_size, cur->nanoseconds_per_bit, cur->motor_active, cur->output_enable);
+    c->rotor = cur->rotor;
+    atomic_store_explicit(&link->head, cycle + 1, memory_order_release);
+    return true;
 }
+#endif
 
 // _c1541_tick_via2 returns if IRQ should be set
 uint8_t _c1541_tick_via2(c1541_t* sys) {
-#ifdef PICO
-    uint32_t tick = get_ticks();
-#endif
+    _C1541_PERF_BEGIN(perf_t0);
     uint64_t pins = sys->via_2.pins;
     {
         // Prepare VIA2 pins
-// #ifdef PICO
-//         uint32_t tick = get_ticks();
-// #endif
-
-        bool output_enable = (sys->via_2.pins & M6522_CB2) != 0;
-        bool motor_active = (sys->via_2.pins & M6522_PB2) != 0;
-        bool sync_bits_present = ((sys->current_data + 1) & (1<<10)) != 0;
-        bool is_sync = sync_bits_present && output_enable;
-        bool latch_data = false;
-
-        // Motor active?
+        const bool output_enable = (sys->via_2.pins & M6522_CB2) != 0;
+        const bool motor_active = (sys->via_2.pins & M6522_PB2) != 0;
+        #ifdef C1541_ENABLE_ROTOR_CORE
+        const uint8_t rotor = sys->rotor_link ? _c1541_rotor_consume(sys, motor_active, output_enable) :
+            _c1541_rotor_tick(&sys->rotor, sys->gcr_bytes, sys->gcr_size, sys->nanoseconds_per_bit, motor_active, output_enable);
+        #else
+        const uint8_t rotor = _c1541_rotor_tick(&sys->rotor, sys->gcr_bytes, sys->gcr_size, sys->nanoseconds_per_bit, motor_active, output_enable);
+        #endif
         if (motor_active) {
-            //// FIXME: for debugging purpose the countdown runs for 2 simulated seconds and terminates the program afterward
-            //if (sys->exit_countdown == 0) {
-            //    sys->exit_countdown = C1541_FREQUENCY << 1;
-            //}
-//            via_output = true;
-            sys->rotor_nanoseconds_counter += 1000;
-            if (sys->rotor_nanoseconds_counter >= sys->nanoseconds_per_bit) {
-                sys->rotor_nanoseconds_counter -= sys->nanoseconds_per_bit;
-                
-                // shift in next gcr bit
-                sys->current_data <<= 1;
-                sys->current_data &= (1<<10)-1;
-                if (sys->gcr_bytes[sys->gcr_byte_pos] & (1<<(7-sys->gcr_bit_pos))) {
-                    // GCR 1 bit
-                    sys->current_data |= 1;
-                } else {
-                    // GCR 0 bit
-                }
-
-                // update gcr read position
-                sys->gcr_bit_pos++;
-                if (sys->gcr_bit_pos > 7) {
-                    sys->gcr_bit_pos = 0;
-                    sys->gcr_byte_pos++;
-                    if (sys->gcr_byte_pos >= sys->gcr_size || sys->gcr_bytes[sys->gcr_byte_pos] == 0) {
-                        sys->gcr_byte_pos = 0;
-			// FIXME: debug output
-                        //printf("%ld - 1541 - disk cycle complete\n", get_world_tick());
-                    }
-                }
-
-                is_sync = (((sys->current_data + 1) & (1<<10)) != 0) && output_enable;
-                
-                if (is_sync) {
-                    sys->output_bit_counter = 0;
-                } else {
-                    sys->output_bit_counter++;
-                    if (sys->output_bit_counter > 7) {
-                        sys->output_bit_counter = 0;
-                        sys->byte_ready_countdown = 2;
-                        latch_data = true;
-                    }
-                }
-            }
+            sys->stats.motor_on_cycles++;
+        }
+        if (rotor & C1541_ROTOR_SYNC_EDGE) {
+            sys->stats.syncs++;
+        }
+        if (rotor & C1541_ROTOR_LATCH) {
+            sys->byte_ready_countdown = 2;
         }
 
         pins &= ~M6522_PB7;
-        if (!is_sync) {
+        if (!(rotor & C1541_ROTOR_SYNC)) {
             pins |= M6522_PB7;
         }
 
@@ -511,39 +1025,24 @@ uint8_t _c1541_tick_via2(c1541_t* sys) {
         }
 
         pins &= ~M6522_CA1;
-        if (latch_data) {
-            sys->output_data = sys->current_data & 0xff;
+        if (rotor & C1541_ROTOR_LATCH) {
+            sys->stats.gcr_bytes++;
             if (output_enable) {
                 pins |= M6522_CA1;
+                sys->stats.byte_ready++;
+                C1541_BYTE_READY_HOOK(sys);
             }
         }
 
         if (output_enable) {
-            M6522_SET_PA(pins, sys->output_data);
+            M6522_SET_PA(pins, sys->rotor.output_data);
         }
-// #ifdef PICO
-//         uint32_t dt = get_elapsed_ticks(tick);
-//         printf("chip_tick via2 prepare: %ld sys tick(s)\n", dt);
-// #endif
     }
 
     // tick VIA2
     {
-// #ifdef PICO
-//         uint32_t tick = get_ticks();
-// #endif
-#ifdef PICO
-        uint32_t chip_tick = get_ticks();
-#endif
         pins = _m6522_tick(&sys->via_2, pins); // use internal _m6522_tick(), register reads/writes are done in cpu tick directly
         sys->via_2.pins = pins;
-#ifdef PICO
-        ticks_chip_via2 = get_elapsed_ticks(chip_tick);
-#endif
-// #ifdef PICO
-//         uint32_t dt = get_elapsed_ticks(tick);
-//         printf("chip_tick via2: %ld sys tick(s)\n", dt);
-// #endif
         // if (pins & M6502_IRQ) {
         //     pins |= M6502_IRQ;
         // }
@@ -586,18 +1085,20 @@ uint8_t _c1541_tick_via2(c1541_t* sys) {
             // TODO if stepper has settled...
             const uint8_t new_stepper_position = (((pins >> M6522_PIN_PB0) & 3) - (sys->half_track & 3)) & 3;
             if (new_stepper_position != 0) {
+                const uint8_t old_half_track = sys->half_track;
                 updateStepper(new_stepper_position);
+                sys->stats.half_track_steps += (sys->half_track > old_half_track) ? (sys->half_track - old_half_track) : (old_half_track - sys->half_track);
                 C1541_TRACK_CHANGED_HOOK(sys, sys->half_track);
+                _C1541_TIMELINE(sys, TIMELINE_HALF_TRACK, sys->half_track);
                 c1541_fetch_track(sys); //TODO do this in background/only after the head settled
-                sys->gcr_byte_pos = 0;
-                sys->gcr_bit_pos = 0;
+                sys->rotor.gcr_byte_pos = 0;
+                sys->rotor.gcr_bit_pos = 0;
+                _C1541_ROTOR_DIRTY(sys);
                 sys->stepper_position = new_stepper_position;
             }
         }
     }
-#ifdef PICO
-    ticks_via2 = get_elapsed_ticks(tick);
-#endif
+    _C1541_PERF_END(sys, C1541_PERF_VIA2, perf_t0);
     return 0 != (pins & M6522_IRQ);
 }
 
@@ -619,6 +1120,51 @@ uint64_t _c1541_tick(c1541_t* sys, const uint64_t input_pins) {
     return pins;
 }
 
+#if defined(C1541_ENABLE_TRACE) || defined(C1541_ENABLE_PROFILE)
+// code byte as seen by the CPU, 0 for I/O
+static uint8_t _c1541_peek_code(c1541_t* sys, uint16_t addr) {
+    if (addr & 0x8000) {
+        return sys->rom[(addr >> 13) & 1][addr & 0x1FFF];
+    } else if ((addr & 0x1800) == 0) {
+        return sys->ram[addr & 0x07FF];
+    }
+    return 0;
+}
+#endif
+
+#ifdef C1541_ENABLE_TRACE
+static void _c1541_trace(c1541_t* sys) {
+    if (sys->trace && (sys->pins & M6502_SYNC)) {
+        const uint16_t pc = m6502_pc(&sys->cpu);
+        trace_record_t rec = {
+            .cycle = sys->trace_cycle,
+            .pc = pc,
+            .a = m6502_a(&sys->cpu),
+            .x = m6502_x(&sys->cpu),
+            .y = m6502_y(&sys->cpu),
+            .s = m6502_s(&sys->cpu),
+            .p = m6502_p(&sys->cpu),
+            .device = TRACE_DEVICE_C1541,
+        };
+        for (int i = 0; i < 3; i++) {
+            rec.bytes[i] = _c1541_peek_code(sys, pc + i);
+        }
+        trace_push(sys->trace, &rec);
+    }
+    sys->trace_cycle++;
+}
+#endif
+
+#ifdef C1541_ENABLE_PROFILE
+static void _c1541_prof(c1541_t* sys) {
+    if (sys->prof && (sys->pins & M6502_SYNC)) {
+        const uint16_t pc = m6502_pc(&sys->cpu);
+        rom_prof_instr(sys->prof, sys->prof_cycle, pc, _c1541_peek_code(sys, pc), m6502_s(&sys->cpu));
+    }
+    sys->prof_cycle++;
+}
+#endif
+
 void
 #ifdef PICO
 __not_in_flash_func(c1541_tick)
@@ -626,13 +1172,111 @@ __not_in_flash_func(c1541_tick)
 c1541_tick
 #endif
 (c1541_t* sys) {
+    C1541_TICK_HOOK(sys);
+    _C1541_PERF_BEGIN(perf_t0);
     sys->pins = _c1541_tick(sys, sys->pins);
+    _C1541_PERF_END(sys, C1541_PERF_TICK, perf_t0);
+    #ifdef C1541_ENABLE_TRACE
+    _c1541_trace(sys);
+    #endif
+    #ifdef C1541_ENABLE_PROFILE
+    _c1541_prof(sys);
+    #endif
+    #ifdef C1541_ENABLE_TIMELINE
+    sys->timeline_cycle++;
+    #endif
 }
 
-void c1541_insert_disc(c1541_t* sys, chips_range_t data) {
-    // FIXME
-    (void)sys;
-    (void)data;
+bool c1541_gcrimg_check(chips_range_t data) {
+    const c1541_gcrimg_header_t* hdr = (const c1541_gcrimg_header_t*)data.ptr;
+    if (!data.ptr || ((uintptr_t)data.ptr & 3) || (data.size < sizeof(c1541_gcrimg_header_t))) {
+        return false;
+    }
+    if ((0 != memcmp(hdr->magic, C1541_GCRIMG_MAGIC, 8)) || (hdr->version != C1541_GCRIMG_VERSION) ||
+        (hdr->num_half_tracks != C1541_GCRIMG_HALF_TRACKS) ||
+        (hdr->size < sizeof(c1541_gcrimg_header_t)) || (hdr->size > data.size)) {
+        return false;
+    }
+    const uint8_t* bytes = (const uint8_t*)data.ptr;
+    for (int i = 0; i < C1541_GCRIMG_HALF_TRACKS; i++) {
+        const uint32_t offset = hdr->tracks[i].offset;
+        const uint32_t size = hdr->tracks[i].size;
+        if (0 == offset) {
+            continue;
+        }
+        // the rotor stops at the 0 byte behind the track
+        if ((offset < sizeof(c1541_gcrimg_header_t)) || (size >= hdr->size) ||
+            (offset >= hdr->size - size) || (0 != bytes[offset + size])) {
+            return false;
+        }
+    }
+    const uint32_t hash = chips_hash(CHIPS_HASH_INIT, bytes + sizeof(c1541_gcrimg_header_t), hdr->size - sizeof(c1541_gcrimg_header_t));
+    return hash == hdr->hash;
+}
+
+bool c1541_insert_disc(c1541_t* sys, chips_range_t data) {
+    CHIPS_ASSERT(sys && sys->valid);
+    c1541_remove_disc(sys);
+    if (!c1541_gcrimg_check(data)) {
+        printf("c1541: invalid GCR image\n");
+        return false;
+    }
+    sys->gcr_image = (const uint8_t*)data.ptr;
+    sys->disk_type = 3;
+    sys->disk_loaded = true;
+    c1541_fetch_track(sys);
+    return true;
+}
+
+static bool _c1541_fetch_track(c1541_t* sys);
+
+size_t c1541_gcrimg_build(const char* filename, uint8_t* dst, size_t dst_size) {
+    CHIPS_ASSERT(filename && dst && (0 == ((uintptr_t)dst & 3)));
+    if (dst_size < sizeof(c1541_gcrimg_header_t)) {
+        return 0;
+    }
+    // a bare drive, only for the D64/G64 track reading of _c1541_fetch_track()
+    c1541_t* sys = aligned_alloc(alignof(c1541_t), sizeof(c1541_t));
+    CHIPS_ASSERT(sys);
+    memset(sys, 0, sizeof(c1541_t));
+    sys->storage = malloc(sizeof(c1541_storage_t));
+    CHIPS_ASSERT(sys->storage);
+    sys->gcr_bytes = sys->storage->gcr_bytes;
+    sys->valid = true;
+    size_t pos = 0;
+    if (c1541_attach_disk(sys, filename)) {
+        c1541_gcrimg_header_t* hdr = (c1541_gcrimg_header_t*)dst;
+        memset(hdr, 0, sizeof(c1541_gcrimg_header_t));
+        memcpy(hdr->magic, C1541_GCRIMG_MAGIC, 8);
+        hdr->version = C1541_GCRIMG_VERSION;
+        hdr->num_half_tracks = C1541_GCRIMG_HALF_TRACKS;
+        pos = sizeof(c1541_gcrimg_header_t);
+        for (int i = 0; i < C1541_GCRIMG_HALF_TRACKS; i++) {
+            sys->half_track = i + 2;
+            if (!_c1541_fetch_track(sys) || (0 == sys->gcr_size)) {
+                continue;
+            }
+            const size_t start = (pos + 3) & ~(size_t)3;
+            if (start + sys->gcr_size + 1 > dst_size) {
+                printf("c1541: GCR image too large: %s\n", filename);
+                pos = 0;
+                break;
+            }
+            memset(dst + pos, 0, start - pos);
+            memcpy(dst + start, sys->storage->gcr_bytes, sys->gcr_size);
+            dst[start + sys->gcr_size] = 0;
+            hdr->tracks[i].offset = (uint32_t)start;
+            hdr->tracks[i].size = sys->gcr_size;
+            pos = start + sys->gcr_size + 1;
+        }
+        if (pos > 0) {
+            hdr->size = (uint32_t)pos;
+            hdr->hash = chips_hash(CHIPS_HASH_INIT, dst + sizeof(c1541_gcrimg_header_t), pos - sizeof(c1541_gcrimg_header_t));
+        }
+    }
+    free(sys->storage);
+    free(sys);
+    return pos;
 }
 
 bool c1541_attach_disk(c1541_t* sys, const char* filename) {
@@ -684,8 +1328,8 @@ bool c1541_attach_disk(c1541_t* sys, const char* filename) {
     }
 
     // Store filename
-    strncpy(sys->disk_filename, filename, sizeof(sys->disk_filename) - 1);
-    sys->disk_filename[sizeof(sys->disk_filename) - 1] = '\0';
+    strncpy(sys->storage->disk_filename, filename, sizeof(sys->storage->disk_filename) - 1);
+    sys->storage->disk_filename[sizeof(sys->storage->disk_filename) - 1] = '\0';
     sys->disk_loaded = true;
     c1541_fetch_track(sys);
 
@@ -694,12 +1338,27 @@ bool c1541_attach_disk(c1541_t* sys, const char* filename) {
     return true;
 }
 
-bool c1541_fetch_track(c1541_t* sys) {
-    CHIPS_ASSERT(sys && sys->valid);
+static bool _c1541_fetch_track(c1541_t* sys) {
 
-    if (!sys->disk_loaded || sys->disk_filename[0] == '\0') {
+    // GCR image: point the rotor at the track in place
+    if (sys->disk_type == 3) {
+        const c1541_gcrimg_header_t* hdr = (const c1541_gcrimg_header_t*)sys->gcr_image;
+        const uint32_t i = sys->half_track - 2;
+        if ((i >= C1541_GCRIMG_HALF_TRACKS) || (0 == hdr->tracks[i].offset)) {
+            sys->gcr_bytes = sys->storage->gcr_bytes;
+            sys->gcr_size = 0;
+            sys->storage->gcr_bytes[0] = 0;
+            return i < C1541_GCRIMG_HALF_TRACKS;
+        }
+        sys->gcr_bytes = sys->gcr_image + hdr->tracks[i].offset;
+        sys->gcr_size = hdr->tracks[i].size;
+        return true;
+    }
+    sys->gcr_bytes = sys->storage->gcr_bytes;
+
+    if (!sys->disk_loaded || sys->storage->disk_filename[0] == '\0') {
         sys->gcr_size = 0;
-        sys->gcr_bytes[0] = 0;
+        sys->storage->gcr_bytes[0] = 0;
         return false;
     }
 
@@ -715,12 +1374,12 @@ bool c1541_fetch_track(c1541_t* sys) {
         if (sys->half_track % 2 == 1) {
             // Even half-tracks have no data in D64
             sys->gcr_size = 0;
-            sys->gcr_bytes[0] = 0;
+            sys->storage->gcr_bytes[0] = 0;
             return true;
         }
 
         // Open D64 file
-        FILE* fp = fopen(sys->disk_filename, "rb");
+        FILE* fp = fopen(sys->storage->disk_filename, "rb");
         if (!fp) {
             return false;
         }
@@ -744,7 +1403,7 @@ bool c1541_fetch_track(c1541_t* sys) {
         }
 
         // Read and convert sectors to GCR
-        uint8_t *ptr = sys->gcr_bytes;
+        uint8_t *ptr = sys->storage->gcr_bytes;
         uint8_t sector_buffer[256];
         uint16_t sector_size = SYNC_LENGTH + HEADER_LENGTH + HEADER_GAP_LENGTH +
                                SYNC_LENGTH + DATA_LENGTH;
@@ -763,26 +1422,26 @@ bool c1541_fetch_track(c1541_t* sys) {
         fclose(fp);
 
         // Calculate actual data written and expected track capacity
-        uint16_t actual_size = (uint16_t)(ptr - sys->gcr_bytes);
+        uint16_t actual_size = (uint16_t)(ptr - sys->storage->gcr_bytes);
         uint8_t speed_zone = speed_map[full_track];
         uint16_t expected_size = track_capacity[speed_zone];
 
         // Pad remaining space with gap bytes (0x55) to match expected track size
-        if (actual_size < expected_size && actual_size < sizeof(sys->gcr_bytes)) {
+        if (actual_size < expected_size && actual_size < sizeof(sys->storage->gcr_bytes)) {
             memset(ptr, 0x55, expected_size - actual_size);
             actual_size = expected_size;
         }
 
-        if (actual_size > sizeof(sys->gcr_bytes) - 1) {
-            actual_size = sizeof(sys->gcr_bytes) - 1;
+        if (actual_size > sizeof(sys->storage->gcr_bytes) - 1) {
+            actual_size = sizeof(sys->storage->gcr_bytes) - 1;
         }
         sys->gcr_size = actual_size;
-        sys->gcr_bytes[sys->gcr_size] = 0;  // Mark end of track
+        sys->storage->gcr_bytes[sys->gcr_size] = 0;  // Mark end of track
         return true;
     }
 
     // G64 handling
-    FILE* fp = fopen(sys->disk_filename, "rb");
+    FILE* fp = fopen(sys->storage->disk_filename, "rb");
     if (!fp) {
         return false;
     }
@@ -814,7 +1473,7 @@ bool c1541_fetch_track(c1541_t* sys) {
     if (track_offset == 0) {
         // Empty track
         sys->gcr_size = 0;
-        sys->gcr_bytes[0] = 0;
+        sys->storage->gcr_bytes[0] = 0;
         fclose(fp);
         return true;
     }
@@ -833,12 +1492,12 @@ bool c1541_fetch_track(c1541_t* sys) {
     }
     uint16_t data_size = size_bytes[0] | (size_bytes[1] << 8);
 
-    if (data_size > sizeof(sys->gcr_bytes)) {
-        data_size = sizeof(sys->gcr_bytes);
+    if (data_size > sizeof(sys->storage->gcr_bytes)) {
+        data_size = sizeof(sys->storage->gcr_bytes);
     }
 
     // Read track data
-    if (fread(sys->gcr_bytes, 1, data_size, fp) != data_size) {
+    if (fread(sys->storage->gcr_bytes, 1, data_size, fp) != data_size) {
         fclose(fp);
         return false;
     }
@@ -846,31 +1505,186 @@ bool c1541_fetch_track(c1541_t* sys) {
     fclose(fp);
 
     sys->gcr_size = data_size;
-    sys->gcr_bytes[data_size] = 0;  // Mark end of track
+    sys->storage->gcr_bytes[data_size] = 0;  // Mark end of track
 
     return true;
 }
 
+// host time for c1541_stats_t, only read around track fetches
+static uint64_t _c1541_now_ns(void) {
+    #if defined(PICO)
+    return time_us_64() * 1000;
+    #else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    #endif
+}
+
+bool c1541_fetch_track(c1541_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    const uint64_t t0 = _c1541_now_ns();
+    _C1541_PERF_BEGIN(perf_t0);
+    const bool res = _c1541_fetch_track(sys);
+    _C1541_PERF_END(sys, C1541_PERF_TRACK_FETCH, perf_t0);
+    // new track data in the same buffer
+    _C1541_ROTOR_DIRTY(sys);
+    const uint64_t ns = _c1541_now_ns() - t0;
+    sys->stats.track_fetches++;
+    sys->stats.track_fetch_ns += ns;
+    if (ns > sys->stats.track_fetch_max_ns) {
+        sys->stats.track_fetch_max_ns = ns;
+    }
+    return res;
+}
+
+bool c1541_led_on(const c1541_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return 0 != (sys->via_2.pb.outr & 0b1000);
+}
+
+bool c1541_motor_on(const c1541_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return 0 != (sys->via_2.pb.outr & 0b100);
+}
+
+const c1541_stats_t* c1541_stats(const c1541_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    return &sys->stats;
+}
+
+void c1541_stats_reset(c1541_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    memset(&sys->stats, 0, sizeof(sys->stats));
+}
+
 void c1541_remove_disc(c1541_t* sys) {
     CHIPS_ASSERT(sys && sys->valid);
 
-    sys->disk_filename[0] = '\0';
+    sys->storage->disk_filename[0] = '\0';
     sys->disk_loaded = false;
     sys->disk_type = 0;
+    sys->gcr_image = NULL;
+    sys->gcr_bytes = sys->storage->gcr_bytes;
     sys->gcr_size = 0;
-    sys->gcr_bytes[0] = 0;
+    sys->storage->gcr_bytes[0] = 0;
+    _C1541_ROTOR_DIRTY(sys);
 }
 
-void c1541_snapshot_onsave(c1541_t* snapshot, void* base) {
-    CHIPS_ASSERT(snapshot && base);
+void c1541_snapshot_onsave(c1541_t* snapshot, c1541_t* sys, void* base) {
+    CHIPS_ASSERT(snapshot && sys && base);
     m6502_snapshot_onsave(&snapshot->cpu);
-    mem_snapshot_onsave(&snapshot->mem, base);
+    // the bulk storage (memory map, disk file name, current track) and the
+    // ROM copy are not part of the snapshot
+    snapshot->storage = 0;
+    snapshot->gcr_bytes = 0;
+    snapshot->gcr_image = 0;
+    snapshot->rom[0] = 0;
+    snapshot->rom[1] = 0;
+    snapshot->rom_copy = 0;
+    // the IEC bus is shared with other devices and not part of the snapshot
+    snapshot->iec_bus = 0;
+    snapshot->iec_device = 0;
+    #ifdef C1541_ENABLE_PERF
+    snapshot->perf = 0;
+    #endif
+    #ifdef C1541_ENABLE_TIMELINE
+    snapshot->timeline = 0;
+    #endif
+    #ifdef C1541_ENABLE_ROTOR_CORE
+    snapshot->rotor_link = 0;
+    #endif
 }
 
 void c1541_snapshot_onload(c1541_t* snapshot, c1541_t* sys, void* base) {
     CHIPS_ASSERT(snapshot && sys && base);
     m6502_snapshot_onload(&snapshot->cpu, &sys->cpu);
-    mem_snapshot_onload(&snapshot->mem, base);
+    snapshot->via1_dirty = true;
+    // keep the storage and ROM of the running instance (with a matching rom_hash),
+    // its memory map still points at the same RAM and ROM
+    snapshot->storage = sys->storage;
+    snapshot->owns_storage = sys->owns_storage;
+    snapshot->gcr_bytes = sys->gcr_bytes;
+    // the disk (file name or GCR image) isn't part of the snapshot either,
+    // the running instance keeps its disk
+    snapshot->gcr_image = sys->gcr_image;
+    snapshot->disk_loaded = sys->disk_loaded;
+    snapshot->disk_type = sys->disk_type;
+    snapshot->rom[0] = sys->rom[0];
+    snapshot->rom[1] = sys->rom[1];
+    snapshot->rom_copy = sys->rom_copy;
+    // stay on the bus of the running instance, with the outputs of the snapshot
+    snapshot->iec_bus = sys->iec_bus;
+    snapshot->iec_device = sys->iec_device;
+    iec_set_signals(sys->iec_bus, sys->iec_device, _c1541_iec_out_signals(snapshot->via_1.pins));
+    #ifdef C1541_ENABLE_PERF
+    snapshot->perf = sys->perf;
+    #endif
+    #ifdef C1541_ENABLE_TIMELINE
+    snapshot->timeline = sys->timeline;
+    snapshot->timeline_cycle = sys->timeline_cycle;
+    #endif
+    #ifdef C1541_ENABLE_ROTOR_CORE
+    snapshot->rotor_link = sys->rotor_link;
+    snapshot->rotor_cycle = sys->rotor_cycle;
+    snapshot->rotor_dirty = true;
+    #endif
+    // the counters keep running across snapshot loads
+    snapshot->stats = sys->stats;
+    if (snapshot->valid) {
+        // read the track under the head again
+        c1541_fetch_track(snapshot);
+    }
+}
+
+#ifdef C1541_ENABLE_PERF
+void c1541_perf_reset(c1541_perf_t* perf) {
+    CHIPS_ASSERT(perf);
+    memset(perf, 0, sizeof(*perf));
+    for (int i = 0; i < C1541_PERF_NUM_STAGES; i++) {
+        perf->stage[i].min = UINT32_MAX;
+    }
+    #if defined(_C1541_PERF_SYSTICK)
+    // free running SysTick at the system clock
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->csr = 0x5;
+    perf->frequency = clock_get_hz(clk_sys);
+    #elif defined(__x86_64__) || defined(__i386__)
+    // TSC against CLOCK_MONOTONIC, kept per c1541_perf_t so that threads share nothing
+    struct timespec ts0, ts1;
+    clock_gettime(CLOCK_MONOTONIC, &ts0);
+    const uint64_t tsc0 = __rdtsc();
+    uint64_t ns;
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &ts1);
+        ns = (uint64_t)(ts1.tv_sec - ts0.tv_sec) * 1000000000ULL + (uint64_t)ts1.tv_nsec - (uint64_t)ts0.tv_nsec;
+    } while (ns < 20000000);
+    perf->frequency = (__rdtsc() - tsc0) * 1000000000ULL / ns;
+    #else
+    perf->frequency = 1000000000ULL;
+    #endif
 }
 
+void c1541_perf_write(const c1541_perf_t* perf, FILE* fp) {
+    CHIPS_ASSERT(perf && fp);
+    static const char* names[C1541_PERF_NUM_STAGES] = { "tick", "cpu", "via1", "via2", "track_fetch" };
+    const double ns_per_tick = 1e9 / (double)perf->frequency;
+    fprintf(fp, "%-12s %12s %10s %10s %10s  histogram (ticks < 2^n: count)\n", "stage", "count", "avg ns", "min ns", "max ns");
+    for (int i = 0; i < C1541_PERF_NUM_STAGES; i++) {
+        const c1541_perf_counter_t* c = &perf->stage[i];
+        if (0 == c->count) {
+            continue;
+        }
+        fprintf(fp, "%-12s %12llu %10.1f %10.1f %10.1f ", names[i], (unsigned long long)c->count,
+            (double)c->total * ns_per_tick / (double)c->count, c->min * ns_per_tick, c->max * ns_per_tick);
+        for (int b = 0; b < C1541_PERF_HIST_BUCKETS; b++) {
+            if (c->hist[b]) {
+                fprintf(fp, " %d:%llu", b, (unsigned long long)c->hist[b]);
+            }
+        }
+        fprintf(fp, "\n");
+    }
+}
+#endif
+
 #endif // CHIPS_IMPL
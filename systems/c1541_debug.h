@@ -1114,6 +1114,11 @@ c1541_routine_t* _get_c1541_in_routine(uint16_t addr) {
     return (c1541_routine_t*) &c1541_routines[right];
 }
 
+// ROM byte at 0xC000 + (offset & 0x3FFF)
+static inline uint8_t _c1541_debug_rom(c1541_t* sys, uint16_t offset) {
+    return sys->rom[(offset >> 13) & 1][offset & 0x1FFF];
+}
+
 static void _c1541_debug_out_processor_pc(float microseconds, c1541_t* sys, uint64_t cpu_pins, uint64_t via1_pins, bool with_disass) {
     if (cpu_pins & M6502_SYNC) {
         uint16_t cpu_pc = m6502_pc(&sys->cpu);
@@ -1145,7 +1150,7 @@ static void _c1541_debug_out_processor_pc(float microseconds, c1541_t* sys, uint
         if (with_disass) {
             if ((cpu_pc & 0xC000) == 0xC000) { // ROM
                 _show_debug_trace('8', &sys->cpu, microseconds,
-                                  sys->rom[(cpu_pc+0) & 0x3FFF], sys->rom[(cpu_pc+1) & 0x3FFF], sys->rom[(cpu_pc+2) & 0x3FFF]);
+                                  _c1541_debug_rom(sys, cpu_pc+0), _c1541_debug_rom(sys, cpu_pc+1), _c1541_debug_rom(sys, cpu_pc+2));
             } else if (cpu_pc < 0x0800) { // RAM
                 _show_debug_trace('8', &sys->cpu, microseconds,
                                   sys->ram[(cpu_pc+0) & 0x07FF], sys->ram[(cpu_pc+1) & 0x07FF], sys->ram[(cpu_pc+2) & 0x07FF]);
@@ -1155,3 +1160,12 @@ static void _c1541_debug_out_processor_pc(float microseconds, c1541_t* sys, uint
         }
     }
 }
+
+#ifdef C1541_ENABLE_PROFILE
+// add c1541_routines to a ROM routine profiler (see rom_prof.h)
+static void c1541_prof_add_routines(rom_prof_t* prof) {
+    for (int i = 0; i < _c1541_routine_count; i++) {
+        rom_prof_add_routine(prof, c1541_routines[i].address, c1541_routines[i].name);
+    }
+}
+#endif
@@ -21,7 +21,7 @@
     You need to include the following headers before including c64.h:
 
     - chips/chips_common.h
-    - chips/m6502.h
+    - chips/m6502.h or chips/m6502_connomore64.h
     - chips/m6526.h
     - chips/m6569.h
     - chips/m6581.h
@@ -248,17 +248,54 @@
 #include <stddef.h>
 #include <stdalign.h>
 #include "iecbus.h"
+#ifdef C64_ENABLE_TRACE
+#include "trace.h"
+#endif
+#ifdef C64_ENABLE_PROFILE
+#include "rom_prof.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // bump snapshot version when c64_t memory layout changes
-#define C64_SNAPSHOT_VERSION (1)
+#define C64_SNAPSHOT_VERSION (5)
 
 #define C64_FREQUENCY (985248)              // clock frequency in Hz
 #define C64_MAX_AUDIO_SAMPLES (1024)        // max number of audio samples in internal sample buffer
 #define C64_DEFAULT_AUDIO_SAMPLES (128)     // default number of samples in internal sample buffer
+#define C64_MAX_DRIVES (4)                  // C1541 drives as devices 8..11
+
+// idle drive scheduler (c64_desc_t.drive_sleep): drives are checked every
+// C64_DRIVE_IDLE_CHECK drive cycles and sleep after two idle checks in a row,
+// idle means the DOS main loop (PC in C64_DRIVE_IDLE_START..END), motor and
+// LED off, ATN released and CLK/DATA released by the drive
+#ifndef C64_DRIVE_IDLE_CHECK
+#define C64_DRIVE_IDLE_CHECK (1024)
+#endif
+#ifndef C64_DRIVE_IDLE_START
+#define C64_DRIVE_IDLE_START (0xEBE7)
+#endif
+#ifndef C64_DRIVE_IDLE_END
+#define C64_DRIVE_IDLE_END (0xEC9D)
+#endif
+
+// CPU bus access, m6502_connomore64.h keeps address and data out of the pin mask
+#ifdef HAVE_CONNOMORE_M6502H
+#define C64_GET_ADDR(pins,sys) (sys->cpu.bus_addr)
+#define C64_GET_DATA(pins,sys) (sys->cpu.bus_data)
+#define C64_SET_DATA(pins,sys,data) sys->cpu.bus_data=data
+#define C64_CHECK_IO(pins,sys) ((sys->cpu.bus_addr&0xFFFE)==0)
+// address, data and RW in the 64-bit pin layout of the IO chips
+#define C64_CHIP_PINS(pins,sys) ((uint64_t)sys->cpu.bus_addr|((uint64_t)sys->cpu.bus_data<<16)|((pins&M6502_RW)?M6526_RW:0))
+#else
+#define C64_GET_ADDR(pins,sys) M6502_GET_ADDR(pins)
+#define C64_GET_DATA(pins,sys) M6502_GET_DATA(pins)
+#define C64_SET_DATA(pins,sys,data) M6502_SET_DATA(pins,data)
+#define C64_CHECK_IO(pins,sys) M6510_CHECK_IO(pins)
+#define C64_CHIP_PINS(pins,sys) (pins&M6502_PIN_MASK)
+#endif
 
 // C64 joystick types
 typedef enum {
@@ -325,9 +362,26 @@ typedef enum {
 typedef struct {
     bool c1530_enabled;     // true to enable the C1530 datassette emulation
     bool c1541_enabled;     // true to enable the C1541 floppy drive emulation
+    // number of C1541 drives with c1541_enabled, as devices 8, 9, ... (default 1,
+    // max C64_MAX_DRIVES), the extra drives share the ROM of the first one
+    int num_drives;
+    // idle drives stop ticking until the C64 asserts ATN (see C64_DRIVE_IDLE_CHECK),
+    // a sleeping drive skips its timer interrupts and the disc doesn't turn
+    bool drive_sleep;
     c64_joystick_type_t joystick_type;  // default is C64_JOYSTICK_NONE
     chips_debug_t debug;    // optional debugging hook
     chips_audio_desc_t audio;   // audio output options
+    // reference the ROM images (also the C1541 ones) instead of copying them, they
+    // must stay valid and unchanged until c64_discard()
+    bool shared_roms;
+    #ifdef C64_ENABLE_TRACE
+    // optional instruction trace, also used for the C1541 with C1541_ENABLE_TRACE
+    trace_t* trace;
+    #endif
+    #ifdef C64_ENABLE_PROFILE
+    // optional ROM routine profiler, see c64_prof_add_routines() in c64_debug.h
+    rom_prof_t* prof;
+    #endif
     // ROM images
     struct {
         chips_range_t chars;     // 4 KByte character ROM dump
@@ -342,6 +396,13 @@ typedef struct {
 
 } c64_desc_t;
 
+// ROM image copies of a c64_t
+typedef struct {
+    uint8_t chars[0x1000];          // 4 KB character ROM image
+    uint8_t basic[0x2000];          // 8 KB BASIC ROM image
+    uint8_t kernal[0x2000];         // 8 KB KERNAL V3 ROM image
+} c64_rom_copy_t;
+
 // C64 emulator state
 typedef struct {
     m6502_t cpu;
@@ -378,18 +439,81 @@ typedef struct {
 
     uint8_t color_ram[1024];        // special static color ram
     uint8_t ram[1<<16];             // general ram
-    uint8_t rom_char[0x1000];       // 4 KB character ROM image
-    uint8_t rom_basic[0x2000];      // 8 KB BASIC ROM image
-    uint8_t rom_kernal[0x2000];     // 8 KB KERNAL V3 ROM image
+    c64_rom_copy_t* rom_copy;       // only allocated without shared ROMs
+    // the ROM images in use, either rom_copy or caller-owned
+    struct {
+        const uint8_t* chars;
+        const uint8_t* basic;
+        const uint8_t* kernal;
+        uint32_t hash;              // identifies the ROMs in snapshots
+    } roms;
     alignas(64) uint8_t fb[M6569_FRAMEBUFFER_SIZE_BYTES];
 
     c1530_t c1530;      // optional datassette
-    c1541_t c1541;      // optional floppy drive
+    c1541_t c1541;      // optional floppy drive (device 8)
+    c1541_t c1541_ext[C64_MAX_DRIVES - 1];  // more drives (device 9..)
+    // drive scheduler
+    int num_drives;
+    bool drive_sleep;
+    uint8_t drive_awake;        // bit per drive, only those are ticked
+    uint8_t drive_mask;         // bit per drive in use
+    uint8_t drive_idle[C64_MAX_DRIVES];  // idle checks in a row
+    uint32_t drive_edges;       // IEC edge count seen by the scheduler
+    uint32_t drive_cycle;
 
     float c64_microseconds;
     float c1541_microseconds;
+    uint16_t last_cpu_address;      // PC of the last opcode fetch, for debug output
+    // C1541 PC stop condition while in c64_exec_until()
+    bool until_drive;
+    bool until_drive_hit;
+    uint16_t until_drive_pc;
+    #ifdef C64_ENABLE_TRACE
+    trace_t* trace;
+    uint64_t trace_cycle;
+    #endif
+    #ifdef C64_ENABLE_PROFILE
+    rom_prof_t* prof;
+    uint64_t prof_cycle;
+    #endif
 } c64_t;
 
+// stop conditions of c64_exec_until()
+typedef enum {
+    C64_UNTIL_NONE,
+    C64_UNTIL_PC,           // C64 CPU fetches the opcode at addr
+    C64_UNTIL_DRIVE_PC,     // C1541 CPU fetches the opcode at addr
+    C64_UNTIL_MEM,          // RAM byte at addr equals value
+    C64_UNTIL_IEC_IDLE,     // no IEC line change for cycles C64 cycles (counted from the call)
+    C64_UNTIL_MOTOR_OFF,    // C1541 motor is off
+    C64_UNTIL_SCREEN,       // a CPU write to the text screen at addr (0: 0x0400) completes text
+    C64_UNTIL_NUM,
+} c64_until_type_t;
+
+#define C64_UNTIL_MAX_TEXT (40)
+
+// one stop condition, input of c64_until_compile()
+typedef struct {
+    c64_until_type_t type;
+    uint16_t addr;
+    uint8_t value;
+    uint32_t cycles;
+    const char* text;       // ASCII, letters become the uppercase screen codes
+} c64_cond_t;
+
+// stop conditions compiled by c64_until_compile()
+typedef struct {
+    uint32_t mask;          // (1<<C64_UNTIL_*) of the active conditions
+    uint16_t pc;
+    uint16_t drive_pc;
+    uint16_t mem_addr;
+    uint8_t mem_value;
+    uint32_t iec_idle_cycles;
+    uint16_t screen_addr;
+    uint8_t screen_len;
+    uint8_t screen_text[C64_UNTIL_MAX_TEXT];    // screen codes
+} c64_until_t;
+
 // initialize a new C64 instance
 void c64_init(c64_t* sys, const c64_desc_t* desc);
 // discard C64 instance
@@ -400,6 +524,12 @@ void c64_reset(c64_t* sys);
 chips_display_info_t c64_display_info(c64_t* sys);
 // tick C64 instance for a given number of microseconds, return number of ticks executed
 uint32_t c64_exec(c64_t* sys, uint32_t micro_seconds);
+// compile stop conditions (at most one per type) for c64_exec_until()
+void c64_until_compile(c64_until_t* until, const c64_cond_t* conds, int num_conds);
+// tick C64 instance for up to the given number of microseconds, stops at the first C64
+// instruction boundary where a condition holds, returns number of ticks executed and
+// the condition in hit (C64_UNTIL_NONE if the time ran out)
+uint32_t c64_exec_until(c64_t* sys, uint32_t micro_seconds, const c64_until_t* until, c64_until_type_t* hit);
 // send a key-down event to the C64
 void c64_key_down(c64_t* sys, int key_code);
 // send a key-up event to the C64
@@ -424,6 +554,8 @@ void c64_tape_play(c64_t* sys);
 void c64_tape_stop(c64_t* sys);
 // return true if tape motor is on
 bool c64_is_tape_motor_on(c64_t* sys);
+// get a C1541 drive, index 0 is device 8 (c1541_enabled and index < num_drives)
+c1541_t* c64_drive(c64_t* sys, int index);
 // save a snapshot, patches pointers to zero and offsets, returns snapshot version
 uint32_t c64_save_snapshot(c64_t* sys, c64_t* dst);
 // load a snapshot, returns false if snapshot versions don't match
@@ -471,15 +603,36 @@ void c64_init(c64_t* sys, const c64_desc_t* desc) {
     sys->valid = true;
     sys->joystick_type = desc->joystick_type;
     sys->debug = desc->debug;
+    #ifdef C64_ENABLE_TRACE
+    sys->trace = desc->trace;
+    #endif
+    #ifdef C64_ENABLE_PROFILE
+    sys->prof = desc->prof;
+    #endif
     sys->audio.callback = desc->audio.callback;
     sys->audio.num_samples = _C64_DEFAULT(desc->audio.num_samples, C64_DEFAULT_AUDIO_SAMPLES);
     CHIPS_ASSERT(sys->audio.num_samples <= C64_MAX_AUDIO_SAMPLES);
-    CHIPS_ASSERT(desc->roms.chars.ptr && (desc->roms.chars.size == sizeof(sys->rom_char)));
-    CHIPS_ASSERT(desc->roms.basic.ptr && (desc->roms.basic.size == sizeof(sys->rom_basic)));
-    CHIPS_ASSERT(desc->roms.kernal.ptr && (desc->roms.kernal.size == sizeof(sys->rom_kernal)));
-    memcpy(sys->rom_char, desc->roms.chars.ptr, sizeof(sys->rom_char));
-    memcpy(sys->rom_basic, desc->roms.basic.ptr, sizeof(sys->rom_basic));
-    memcpy(sys->rom_kernal, desc->roms.kernal.ptr, sizeof(sys->rom_kernal));
+    CHIPS_ASSERT(desc->roms.chars.ptr && (desc->roms.chars.size == sizeof(sys->rom_copy->chars)));
+    CHIPS_ASSERT(desc->roms.basic.ptr && (desc->roms.basic.size == sizeof(sys->rom_copy->basic)));
+    CHIPS_ASSERT(desc->roms.kernal.ptr && (desc->roms.kernal.size == sizeof(sys->rom_copy->kernal)));
+    if (desc->shared_roms) {
+        sys->roms.chars = desc->roms.chars.ptr;
+        sys->roms.basic = desc->roms.basic.ptr;
+        sys->roms.kernal = desc->roms.kernal.ptr;
+    }
+    else {
+        sys->rom_copy = malloc(sizeof(c64_rom_copy_t));
+        CHIPS_ASSERT(sys->rom_copy);
+        memcpy(sys->rom_copy->chars, desc->roms.chars.ptr, sizeof(sys->rom_copy->chars));
+        memcpy(sys->rom_copy->basic, desc->roms.basic.ptr, sizeof(sys->rom_copy->basic));
+        memcpy(sys->rom_copy->kernal, desc->roms.kernal.ptr, sizeof(sys->rom_copy->kernal));
+        sys->roms.chars = sys->rom_copy->chars;
+        sys->roms.basic = sys->rom_copy->basic;
+        sys->roms.kernal = sys->rom_copy->kernal;
+    }
+    sys->roms.hash = chips_hash(CHIPS_HASH_INIT, sys->roms.chars, sizeof(sys->rom_copy->chars));
+    sys->roms.hash = chips_hash(sys->roms.hash, sys->roms.basic, sizeof(sys->rom_copy->basic));
+    sys->roms.hash = chips_hash(sys->roms.hash, sys->roms.kernal, sizeof(sys->rom_copy->kernal));
 
     // initialize the hardware
     sys->cpu_port = 0xF7;       // for initial memory mapping
@@ -526,11 +679,33 @@ void c64_init(c64_t* sys, const c64_desc_t* desc) {
     if (desc->c1541_enabled) {
         c1541_init(&sys->c1541, &(c1541_desc_t){
             .iec_bus = sys->iec_bus,
+            .shared_roms = desc->shared_roms,
+            #if defined(C64_ENABLE_TRACE) && defined(C1541_ENABLE_TRACE)
+            .trace = desc->trace,
+            #endif
             .roms = {
                 .c000_dfff = desc->roms.c1541.c000_dfff,
                 .e000_ffff = desc->roms.c1541.e000_ffff
             },
         });
+        sys->num_drives = _C64_DEFAULT(desc->num_drives, 1);
+        CHIPS_ASSERT((sys->num_drives >= 1) && (sys->num_drives <= C64_MAX_DRIVES));
+        // the IEC bus has room for the C64, all drives and a host device (c64_rec.h)
+        CHIPS_ASSERT((sys->num_drives + 2) <= IEC_BUS_MAX_DEVICES);
+        for (int i = 1; i < sys->num_drives; i++) {
+            c1541_init(&sys->c1541_ext[i - 1], &(c1541_desc_t){
+                .iec_bus = sys->iec_bus,
+                .shared_roms = true,
+                .device_number = 8 + i,
+                .roms = {
+                    .c000_dfff = { .ptr = (void*)sys->c1541.rom[0], .size = 0x2000 },
+                    .e000_ffff = { .ptr = (void*)sys->c1541.rom[1], .size = 0x2000 }
+                },
+            });
+        }
+        sys->drive_sleep = desc->drive_sleep;
+        sys->drive_mask = (1 << sys->num_drives) - 1;
+        sys->drive_awake = sys->drive_mask;
     }
 }
 
@@ -540,9 +715,13 @@ void c64_discard(c64_t* sys) {
     if (sys->c1530.valid) {
         c1530_discard(&sys->c1530);
     }
-    if (sys->c1541.valid) {
-        c1541_discard(&sys->c1541);
+    for (int i = 0; i < sys->num_drives; i++) {
+        c1541_discard(c64_drive(sys, i));
     }
+    iec_disconnect(sys->iec_bus, sys->iec_device);
+    sys->iec_device = NULL;
+    free(sys->rom_copy);
+    sys->rom_copy = NULL;
 }
 
 void c64_reset(c64_t* sys) {
@@ -560,15 +739,71 @@ void c64_reset(c64_t* sys) {
     m6581_reset(&sys->sid);
 }
 
+c1541_t* c64_drive(c64_t* sys, int index) {
+    CHIPS_ASSERT(sys && (index >= 0) && (index < sys->num_drives));
+    return (index == 0) ? &sys->c1541 : &sys->c1541_ext[index - 1];
+}
+
+static bool _c64_drive_idle(c1541_t* drive) {
+    const uint16_t pc = m6502_pc(&drive->cpu);
+    const uint8_t lines = IECLINE_CLK | IECLINE_DATA;
+    return (pc >= C64_DRIVE_IDLE_START) && (pc < C64_DRIVE_IDLE_END) &&
+        !c1541_motor_on(drive) && !c1541_led_on(drive) &&
+        ((drive->iec_device->signals & lines) == lines);
+}
+
+// wakes all drives when ATN gets asserted, puts idle ones to sleep
+static void _c64_drive_schedule(c64_t* sys) {
+    const uint32_t edges = iec_get_edge_count(sys->iec_bus);
+    if (edges != sys->drive_edges) {
+        sys->drive_edges = edges;
+        // every drive must see the address after ATN, ATN acknowledge
+        // of sleeping drives is handled by iecbus.h
+        if (IEC_ATN_ACTIVE(iec_get_signals(sys->iec_bus))) {
+            sys->drive_awake = sys->drive_mask;
+            memset(sys->drive_idle, 0, sizeof(sys->drive_idle));
+        }
+    }
+    if ((++sys->drive_cycle % C64_DRIVE_IDLE_CHECK) || (sys->drive_awake == 0)) {
+        return;
+    }
+    if (IEC_ATN_ACTIVE(iec_get_signals(sys->iec_bus))) {
+        return;
+    }
+    for (int i = 0; i < sys->num_drives; i++) {
+        if (sys->drive_awake & (1 << i)) {
+            if (!_c64_drive_idle(c64_drive(sys, i))) {
+                sys->drive_idle[i] = 0;
+            } else if (++sys->drive_idle[i] == 2) {
+                sys->drive_awake &= ~(1 << i);
+            }
+        }
+    }
+}
+
+// IEC line outputs of the CIA2 port A pins
+static inline uint8_t _c64_iec_out_signals(uint64_t cia2_pins) {
+    uint8_t iec_signals = ~0;
+    if (cia2_pins & M6526_PA3) {
+        iec_signals &= ~IECLINE_ATN;
+    }
+    if (cia2_pins & M6526_PA4) {
+        iec_signals &= ~IECLINE_CLK;
+    }
+    if (cia2_pins & M6526_PA5) {
+        iec_signals &= ~IECLINE_DATA;
+    }
+    return iec_signals;
+}
+
 static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
-    static uint16_t last_cpu_address = 0;
 #ifdef __IEC_DEBUG
     _c64_debug_out_processor_pc(sys, pins);
 #endif
     // tick the CPU
     pins = m6502_tick(&sys->cpu, pins);
     sys->c64_microseconds += 1.0f/0.985248f;
-    const uint16_t addr = M6502_GET_ADDR(pins);
+    const uint16_t addr = C64_GET_ADDR(pins, sys);
 
     // those pins are set each tick by the CIAs and VIC
     pins &= ~(M6502_IRQ|M6502_NMI|M6502_RDY|M6510_AEC);
@@ -581,12 +816,13 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
     bool cpu_io_access = false;
     bool color_ram_access = false;
     bool mem_access = false;
-    uint64_t vic_pins = pins & M6502_PIN_MASK;
-    uint64_t cia1_pins = pins & M6502_PIN_MASK;
-    uint64_t cia2_pins = pins & M6502_PIN_MASK;
-    uint64_t sid_pins = pins & M6502_PIN_MASK;
+    const uint64_t chip_pins = C64_CHIP_PINS(pins, sys);
+    uint64_t vic_pins = chip_pins;
+    uint64_t cia1_pins = chip_pins;
+    uint64_t cia2_pins = chip_pins;
+    uint64_t sid_pins = chip_pins;
     if ((pins & (M6502_RDY|M6502_RW)) != (M6502_RDY|M6502_RW)) {
-        if (M6510_CHECK_IO(pins)) {
+        if (C64_CHECK_IO(pins, sys)) {
             cpu_io_access = true;
         }
         else {
@@ -617,17 +853,38 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
             }
         }
     }
-    #ifdef C64_ENABLE_DEBUG
-    static uint _c64_debug_ticks = 0;
-    #endif
     if (pins & M6502_SYNC) {
         #ifdef C64_ENABLE_DEBUG
         _show_debug_trace('C', &sys->cpu, sys->c64_microseconds, mem_rd(&sys->mem_cpu, addr), mem_rd(&sys->mem_cpu, addr+1), mem_rd(&sys->mem_cpu, addr+2));
         #endif
-        last_cpu_address = addr;
+        #ifdef C64_ENABLE_TRACE
+        if (sys->trace) {
+            trace_record_t rec = {
+                .cycle = sys->trace_cycle,
+                .pc = addr,
+                .a = m6502_a(&sys->cpu),
+                .x = m6502_x(&sys->cpu),
+                .y = m6502_y(&sys->cpu),
+                .s = m6502_s(&sys->cpu),
+                .p = m6502_p(&sys->cpu),
+                .bytes = { mem_rd(&sys->mem_cpu, addr), mem_rd(&sys->mem_cpu, addr+1), mem_rd(&sys->mem_cpu, addr+2) },
+                .device = TRACE_DEVICE_C64,
+            };
+            trace_push(sys->trace, &rec);
+        }
+        #endif
+        #ifdef C64_ENABLE_PROFILE
+        if (sys->prof) {
+            rom_prof_instr(sys->prof, sys->prof_cycle, addr, mem_rd(&sys->mem_cpu, addr), m6502_s(&sys->cpu));
+        }
+        #endif
+        sys->last_cpu_address = addr;
     }
-    #ifdef C64_ENABLE_DEBUG
-    _c64_debug_ticks++;
+    #ifdef C64_ENABLE_TRACE
+    sys->trace_cycle++;
+    #endif
+    #ifdef C64_ENABLE_PROFILE
+    sys->prof_cycle++;
     #endif
 
     // tick the SID
@@ -644,7 +901,7 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
             }
         }
         if ((sid_pins & (M6581_CS|M6581_RW)) == (M6581_CS|M6581_RW)) {
-            pins = M6502_COPY_DATA(pins, sid_pins);
+            C64_SET_DATA(pins, sys, M6581_GET_DATA(sid_pins));
         }
     }
 
@@ -673,11 +930,11 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
         cia1_pins = m6526_tick(&sys->cia_1, cia1_pins);
         const uint8_t kbd_lines = ~M6526_GET_PA(cia1_pins);
         kbd_set_active_lines(&sys->kbd, kbd_lines);
-        if (cia1_pins & M6502_IRQ) {
+        if (cia1_pins & M6526_IRQ) {
             pins |= M6502_IRQ;
         }
         if ((cia1_pins & (M6526_CS|M6526_RW)) == (M6526_CS|M6526_RW)) {
-            pins = M6502_COPY_DATA(pins, cia1_pins);
+            C64_SET_DATA(pins, sys, M6526_GET_DATA(cia1_pins));
         }
     }
 
@@ -709,8 +966,21 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
         // handle IEC communication and C1541 synchronization
 
         void _c1541_tick() {
-            c1541_tick(&sys->c1541);
+            if (sys->drive_sleep) {
+                _c64_drive_schedule(sys);
+            }
+            if (sys->drive_awake & 1) {
+                c1541_tick(&sys->c1541);
+            }
+            for (int i = 1; i < sys->num_drives; i++) {
+                if (sys->drive_awake & (1 << i)) {
+                    c1541_tick(&sys->c1541_ext[i - 1]);
+                }
+            }
             sys->c1541_microseconds += 1;
+            if (sys->until_drive && (sys->c1541.pins & M6502_SYNC) && (m6502_pc(&sys->c1541.cpu) == sys->until_drive_pc)) {
+                sys->until_drive_hit = true;
+            }
             #ifdef C1541_ENABLE_DEBUG
             _c1541_debug_out_processor_pc(sys->c1541_microseconds, &sys->c1541, sys->c1541.cpu.PINS, 0, 1);
             #endif
@@ -763,33 +1033,24 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
         cia2_pins = m6526_tick(&sys->cia_2, cia2_pins);
 
         sys->vic_bank_select = ((~M6526_GET_PA(cia2_pins))&3)<<14;
-        if (cia2_pins & M6502_IRQ) {
+        if (cia2_pins & M6526_IRQ) {
             pins |= M6502_NMI;
         }
         if (cia2_pins & M6526_CS) {
             if (cia2_pins & M6526_RW) {
-                pins = M6502_COPY_DATA(pins, cia2_pins);
-                //if ((addr & 0xf) < 4) { printf("%ld - c64 - Read CIA2 $%04x = $%02X - CPU @ $%04X\n", get_world_tick(), addr, M6502_GET_DATA(cia2_pins), last_cpu_address); }
+                C64_SET_DATA(pins, sys, M6526_GET_DATA(cia2_pins));
+                //if ((addr & 0xf) < 4) { printf("%ld - c64 - Read CIA2 $%04x = $%02X - CPU @ $%04X\n", get_world_tick(sys->iec_bus), addr, M6502_GET_DATA(cia2_pins), sys->last_cpu_address); }
             }
-            //else if ((addr & 0xf) < 4) { printf("%ld - c64 - Write CIA2 $%04x = $%02X - CPU @ $%04X\n", get_world_tick(), addr, M6502_GET_DATA(cia2_pins), last_cpu_address); }
+            //else if ((addr & 0xf) < 4) { printf("%ld - c64 - Write CIA2 $%04x = $%02X - CPU @ $%04X\n", get_world_tick(sys->iec_bus), addr, M6502_GET_DATA(cia2_pins), sys->last_cpu_address); }
         }
         {
             cia2_pa = M6526_GET_PA(cia2_pins);
-            uint8_t iec_signals = ~0;
-            if (cia2_pins & M6522_PA3) {
-                iec_signals &= ~IECLINE_ATN;
-            }
-            if (cia2_pins & M6522_PA4) {
-                iec_signals &= ~IECLINE_CLK;
-            }
-            if (cia2_pins & M6522_PA5) {
-                iec_signals &= ~IECLINE_DATA;
-            }
+            uint8_t iec_signals = _c64_iec_out_signals(cia2_pins);
             iec_set_signals(sys->iec_bus, sys->iec_device, iec_signals);
 /*
             if (iec_signals != sys->iec_device->signals) {
                 char message_prefix[256];
-                sprintf(message_prefix, "%ld - c64 - write-iec - cpu @ $%04X", get_world_tick(), last_cpu_address);
+                sprintf(message_prefix, "%ld - c64 - write-iec - cpu @ $%04X", get_world_tick(sys->iec_bus), sys->last_cpu_address);
                 #ifdef __IEC_DEBUG
                 iec_debug_print_device_signals(sys->iec_device, message_prefix);
                 #endif
@@ -813,9 +1074,17 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
     */
     {
         vic_pins = m6569_tick(&sys->vic, vic_pins);
-        pins |= (vic_pins & (M6502_IRQ|M6502_RDY|M6510_AEC));
+        if (vic_pins & M6569_IRQ) {
+            pins |= M6502_IRQ;
+        }
+        if (vic_pins & M6569_BA) {
+            pins |= M6502_RDY;
+        }
+        if (vic_pins & M6569_AEC) {
+            pins |= M6510_AEC;
+        }
         if ((vic_pins & (M6569_CS|M6569_RW)) == (M6569_CS|M6569_RW)) {
-            pins = M6502_COPY_DATA(pins, vic_pins);
+            C64_SET_DATA(pins, sys, M6569_GET_DATA(vic_pins));
         }
     }
 
@@ -828,21 +1097,21 @@ static uint64_t _c64_tick(c64_t* sys, uint64_t pins) {
     }
     else if (color_ram_access) {
         if (pins & M6502_RW) {
-            M6502_SET_DATA(pins, sys->color_ram[addr & 0x03FF]);
+            C64_SET_DATA(pins, sys, sys->color_ram[addr & 0x03FF]);
         }
         else {
-            sys->color_ram[addr & 0x03FF] = M6502_GET_DATA(pins);
+            sys->color_ram[addr & 0x03FF] = C64_GET_DATA(pins, sys);
         }
     }
     else if (mem_access) {
         if (pins & M6502_RW) {
             // memory read
             uint8_t read_data = mem_rd(&sys->mem_cpu, addr);
-            M6502_SET_DATA(pins, read_data);
+            C64_SET_DATA(pins, sys, read_data);
         }
         else {
             // memory write
-            uint8_t write_data = M6502_GET_DATA(pins);
+            uint8_t write_data = C64_GET_DATA(pins, sys);
             mem_wr(&sys->mem_cpu, addr, write_data);
         }
     }
@@ -919,7 +1188,7 @@ static uint16_t _c64_vic_fetch(uint16_t addr, void* user_data) {
 
 static void _c64_update_memory_map(c64_t* sys) {
     sys->io_mapped = false;
-    uint8_t* read_ptr;
+    const uint8_t* read_ptr;
     // shortcut if HIRAM and LORAM is 0, everything is RAM
     if ((sys->cpu_port & (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM)) == 0) {
         mem_map_ram(&sys->mem_cpu, 0, 0xA000, 0x6000, sys->ram+0xA000);
@@ -927,7 +1196,7 @@ static void _c64_update_memory_map(c64_t* sys) {
     else {
         // A000..BFFF is either RAM-behind-BASIC-ROM or RAM
         if ((sys->cpu_port & (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM)) == (C64_CPUPORT_HIRAM|C64_CPUPORT_LORAM)) {
-            read_ptr = sys->rom_basic;
+            read_ptr = sys->roms.basic;
         }
         else {
             read_ptr = sys->ram + 0xA000;
@@ -936,7 +1205,7 @@ static void _c64_update_memory_map(c64_t* sys) {
 
         // E000..FFFF is either RAM-behind-KERNAL-ROM or RAM
         if (sys->cpu_port & C64_CPUPORT_HIRAM) {
-            read_ptr = sys->rom_kernal;
+            read_ptr = sys->roms.kernal;
         }
         else {
             read_ptr = sys->ram + 0xE000;
@@ -948,11 +1217,17 @@ static void _c64_update_memory_map(c64_t* sys) {
             sys->io_mapped = true;
         }
         else {
-            mem_map_rw(&sys->mem_cpu, 0, 0xD000, 0x1000, sys->rom_char, sys->ram+0xD000);
+            mem_map_rw(&sys->mem_cpu, 0, 0xD000, 0x1000, sys->roms.chars, sys->ram+0xD000);
         }
     }
 }
 
+// the VIC-II sees the character ROM at 0x1000..0x1FFF and 0x9000..0x9FFF
+static void _c64_map_vic_roms(c64_t* sys) {
+    mem_map_rom(&sys->mem_vic, 0, 0x1000, 0x1000, sys->roms.chars);
+    mem_map_rom(&sys->mem_vic, 0, 0x9000, 0x1000, sys->roms.chars);
+}
+
 static void _c64_init_memory_map(c64_t* sys) {
     // seperate memory mapping for CPU and VIC-II
     mem_init(&sys->mem_cpu);
@@ -988,8 +1263,7 @@ static void _c64_init_memory_map(c64_t* sys) {
        character ROMS at 0x1000.0x1FFF and 0x9000..0x9FFF
     */
     mem_map_ram(&sys->mem_vic, 1, 0x0000, 0x10000, sys->ram);
-    mem_map_rom(&sys->mem_vic, 0, 0x1000, 0x1000, sys->rom_char);
-    mem_map_rom(&sys->mem_vic, 0, 0x9000, 0x1000, sys->rom_char);
+    _c64_map_vic_roms(sys);
 }
 
 static void _c64_init_key_map(c64_t* sys) {
@@ -1070,7 +1344,7 @@ uint32_t c64_exec(c64_t* sys, uint32_t micro_seconds) {
         // run without debug callback
         for (uint32_t ticks = 0; ticks < num_ticks; ticks++) {
 // #ifdef __IEC_DEBUG
-            world_tick();
+            world_tick(sys->iec_bus);
 // #endif
             pins = _c64_tick(sys, pins);
             set_master_tick(sys->iec_bus);
@@ -1080,7 +1354,7 @@ uint32_t c64_exec(c64_t* sys, uint32_t micro_seconds) {
         // run with debug callback
         for (uint32_t ticks = 0; (ticks < num_ticks) && !(*sys->debug.stopped); ticks++) {
 // #ifdef __IEC_DEBUG
-            world_tick();
+            world_tick(sys->iec_bus);
 // #endif
             pins = _c64_tick(sys, pins);
             set_master_tick(sys->iec_bus);
@@ -1092,6 +1366,132 @@ uint32_t c64_exec(c64_t* sys, uint32_t micro_seconds) {
     return num_ticks;
 }
 
+void c64_until_compile(c64_until_t* until, const c64_cond_t* conds, int num_conds) {
+    CHIPS_ASSERT(until && (conds || (num_conds == 0)));
+    memset(until, 0, sizeof(c64_until_t));
+    for (int i = 0; i < num_conds; i++) {
+        const c64_cond_t* cond = &conds[i];
+        CHIPS_ASSERT((cond->type > C64_UNTIL_NONE) && (cond->type < C64_UNTIL_NUM));
+        CHIPS_ASSERT(0 == (until->mask & (1<<cond->type)));
+        until->mask |= 1<<cond->type;
+        switch (cond->type) {
+            case C64_UNTIL_PC:
+                until->pc = cond->addr;
+                break;
+            case C64_UNTIL_DRIVE_PC:
+                until->drive_pc = cond->addr;
+                break;
+            case C64_UNTIL_MEM:
+                until->mem_addr = cond->addr;
+                until->mem_value = cond->value;
+                break;
+            case C64_UNTIL_IEC_IDLE:
+                until->iec_idle_cycles = cond->cycles;
+                break;
+            case C64_UNTIL_SCREEN: {
+                CHIPS_ASSERT(cond->text && (strlen(cond->text) > 0) && (strlen(cond->text) <= C64_UNTIL_MAX_TEXT));
+                until->screen_addr = cond->addr ? cond->addr : 0x0400;
+                CHIPS_ASSERT((until->screen_addr + 1000) <= 0x10000);
+                for (const char* c = cond->text; *c; c++) {
+                    // ASCII to screen codes of the uppercase charset
+                    uint8_t code = (uint8_t)*c;
+                    if ((code >= 'a') && (code <= 'z')) {
+                        code = code - 'a' + 1;
+                    } else if ((code >= 0x40) && (code < 0x60)) {
+                        code -= 0x40;
+                    }
+                    until->screen_text[until->screen_len++] = code;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+// true if a match of the screen text contains the byte at addr
+static bool _c64_until_screen(c64_t* sys, const c64_until_t* until, uint16_t addr) {
+    const int len = until->screen_len;
+    const int first = ((addr - len + 1) > until->screen_addr) ? (addr - len + 1) : until->screen_addr;
+    const int last = (addr < (until->screen_addr + 1000 - len)) ? addr : (until->screen_addr + 1000 - len);
+    for (int pos = first; pos <= last; pos++) {
+        if (0 == memcmp(&sys->ram[pos], until->screen_text, len)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t c64_exec_until(c64_t* sys, uint32_t micro_seconds, const c64_until_t* until, c64_until_type_t* hit) {
+    CHIPS_ASSERT(sys && sys->valid && until);
+    CHIPS_ASSERT(sys->c1541.valid || !(until->mask & ((1<<C64_UNTIL_DRIVE_PC)|(1<<C64_UNTIL_MOTOR_OFF))));
+    const uint32_t num_ticks = clk_us_to_ticks(C64_FREQUENCY, micro_seconds);
+    const uint32_t mask = until->mask;
+    // the conditions are checked only if something they depend on happened
+    const uint32_t screen_begin = until->screen_addr;
+    const uint32_t screen_end = until->screen_addr + 1000;
+    int32_t screen_write = -1;
+    uint32_t iec_edges = iec_get_edge_count(sys->iec_bus);
+    uint32_t iec_edge_tick = 0;
+    c64_until_type_t res = C64_UNTIL_NONE;
+    sys->until_drive = 0 != (mask & (1<<C64_UNTIL_DRIVE_PC));
+    sys->until_drive_pc = until->drive_pc;
+    sys->until_drive_hit = false;
+    uint64_t pins = sys->pins;
+    uint32_t ticks = 0;
+    while ((ticks < num_ticks) && (res == C64_UNTIL_NONE)) {
+        if (sys->debug.callback.func && *sys->debug.stopped) {
+            break;
+        }
+        world_tick(sys->iec_bus);
+        pins = _c64_tick(sys, pins);
+        set_master_tick(sys->iec_bus);
+        ticks++;
+        if (sys->debug.callback.func) {
+            sys->debug.callback.func(sys->debug.callback.user_data, pins);
+        }
+        const uint16_t addr = C64_GET_ADDR(pins, sys);
+        if ((mask & (1<<C64_UNTIL_SCREEN)) && !(pins & M6502_RW) && (addr >= screen_begin) && (addr < screen_end)) {
+            screen_write = addr;
+        }
+        if (!(pins & M6502_SYNC)) {
+            continue;
+        }
+        // at an instruction boundary
+        if ((mask & (1<<C64_UNTIL_PC)) && (addr == until->pc)) {
+            res = C64_UNTIL_PC;
+        } else if (sys->until_drive_hit) {
+            res = C64_UNTIL_DRIVE_PC;
+        } else if ((mask & (1<<C64_UNTIL_MEM)) && (sys->ram[until->mem_addr] == until->mem_value)) {
+            res = C64_UNTIL_MEM;
+        } else if ((mask & (1<<C64_UNTIL_MOTOR_OFF)) && !c1541_motor_on(&sys->c1541)) {
+            res = C64_UNTIL_MOTOR_OFF;
+        } else if (mask & (1<<C64_UNTIL_IEC_IDLE)) {
+            const uint32_t edges = iec_get_edge_count(sys->iec_bus);
+            if (edges != iec_edges) {
+                iec_edges = edges;
+                iec_edge_tick = ticks;
+            } else if ((ticks - iec_edge_tick) >= until->iec_idle_cycles) {
+                res = C64_UNTIL_IEC_IDLE;
+            }
+        }
+        if ((res == C64_UNTIL_NONE) && (screen_write >= 0)) {
+            if (_c64_until_screen(sys, until, (uint16_t)screen_write)) {
+                res = C64_UNTIL_SCREEN;
+            }
+            screen_write = -1;
+        }
+    }
+    sys->pins = pins;
+    sys->until_drive = false;
+    kbd_update(&sys->kbd, (ticks == num_ticks) ? micro_seconds : (uint32_t)(((uint64_t)ticks * 1000000) / C64_FREQUENCY));
+    if (hit) {
+        *hit = res;
+    }
+    return ticks;
+}
+
 void c64_key_down(c64_t* sys, int key_code) {
     CHIPS_ASSERT(sys && sys->valid);
     if (sys->joystick_type == C64_JOYSTICKTYPE_NONE) {
@@ -1265,10 +1665,20 @@ uint32_t c64_save_snapshot(c64_t* sys, c64_t* dst) {
     chips_audio_callback_snapshot_onsave(&dst->audio.callback);
     m6502_snapshot_onsave(&dst->cpu);
     m6569_snapshot_onsave(&dst->vic);
-    mem_snapshot_onsave(&dst->mem_cpu, sys);
-    mem_snapshot_onsave(&dst->mem_vic, sys);
+    mem_snapshot_onsave_shared(&dst->mem_cpu, sys, sizeof(c64_t));
+    mem_snapshot_onsave_shared(&dst->mem_vic, sys, sizeof(c64_t));
     c1530_snapshot_onsave(&dst->c1530);
-    c1541_snapshot_onsave(&dst->c1541, sys);
+    // the IEC bus is shared with other devices and not part of the snapshot
+    dst->iec_bus = 0;
+    dst->iec_device = 0;
+    for (int i = 0; i < sys->num_drives; i++) {
+        c1541_snapshot_onsave(c64_drive(dst, i), c64_drive(sys, i), sys);
+    }
+    // only the ROM hash goes into the snapshot, not the ROM images
+    dst->roms.chars = 0;
+    dst->roms.basic = 0;
+    dst->roms.kernal = 0;
+    dst->rom_copy = 0;
     return C64_SNAPSHOT_VERSION;
 }
 
@@ -1277,17 +1687,37 @@ bool c64_load_snapshot(c64_t* sys, uint32_t version, c64_t* src) {
     if (version != C64_SNAPSHOT_VERSION) {
         return false;
     }
-    static c64_t im;
-    im = *src;
-    chips_debug_snapshot_onload(&im.debug, &sys->debug);
-    chips_audio_callback_snapshot_onload(&im.audio.callback, &sys->audio.callback);
-    m6502_snapshot_onload(&im.cpu, &sys->cpu);
-    m6569_snapshot_onload(&im.vic, &sys->vic);
-    mem_snapshot_onload(&im.mem_cpu, sys);
-    mem_snapshot_onload(&im.mem_vic, sys);
-    c1530_snapshot_onload(&im.c1530, &sys->c1530);
-    c1541_snapshot_onload(&im.c1541, &sys->c1541, sys);
-    *sys = im;
+    // the snapshot must have been taken with the same ROMs and drives
+    if ((src->roms.hash != sys->roms.hash) || (src->c1541.rom_hash != sys->c1541.rom_hash) ||
+        (src->num_drives != sys->num_drives))
+    {
+        return false;
+    }
+    // per call, so that instances on different threads can load snapshots
+    c64_t* im = (c64_t*) aligned_alloc(_Alignof(c64_t), sizeof(c64_t));
+    CHIPS_ASSERT(im);
+    *im = *src;
+    im->roms = sys->roms;
+    im->rom_copy = sys->rom_copy;
+    chips_debug_snapshot_onload(&im->debug, &sys->debug);
+    chips_audio_callback_snapshot_onload(&im->audio.callback, &sys->audio.callback);
+    m6502_snapshot_onload(&im->cpu, &sys->cpu);
+    m6569_snapshot_onload(&im->vic, &sys->vic);
+    mem_snapshot_onload(&im->mem_cpu, sys);
+    mem_snapshot_onload(&im->mem_vic, sys);
+    c1530_snapshot_onload(&im->c1530, &sys->c1530);
+    // stay on the bus of the running instance, with the outputs of the snapshot
+    im->iec_bus = sys->iec_bus;
+    im->iec_device = sys->iec_device;
+    iec_set_signals(sys->iec_bus, sys->iec_device, _c64_iec_out_signals(im->cia_2.pins));
+    for (int i = 0; i < sys->num_drives; i++) {
+        c1541_snapshot_onload(c64_drive(im, i), c64_drive(sys, i), sys);
+    }
+    *sys = *im;
+    free(im);
+    // the ROMs are outside the snapshot base, map them again
+    _c64_update_memory_map(sys);
+    _c64_map_vic_roms(sys);
     return true;
 }
 
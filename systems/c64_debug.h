@@ -589,7 +589,7 @@ const c64rom_routine_t c64_rom_routines[] = {
 
 static const int C64_ROM_ROUTINES_COUNT = sizeof(c64_rom_routines) / sizeof(c64_rom_routines[0]);
 
-c64rom_routine_t* _get_c64_in_rom_routine(uint16_t addr) {
+const c64rom_routine_t* _get_c64_in_rom_routine(uint16_t addr) {
     int left = 0;
     int right = C64_ROM_ROUTINES_COUNT - 1;
 
@@ -615,10 +615,10 @@ c64rom_routine_t* _get_c64_in_rom_routine(uint16_t addr) {
 static void _c64_debug_out_processor_pc(c64_t* sys, uint64_t pins) {
     if (pins & M6502_SYNC) {
         uint16_t cpu_pc = m6502_pc(&sys->cpu);
-        c64_rom_routine_t* in_c64_rom_routine = _get_c64_in_rom_routine(cpu_pc);
-        uint16_t function_address = in_c64_rom_routine->address;
-        uint16_t address_diff = cpu_pc - function_address;
-        const char* function_name = in_c64_rom_routine->name;
+        const c64rom_routine_t* in_c64_rom_routine = _get_c64_in_rom_routine(cpu_pc);
+        uint16_t function_address;
+        uint16_t address_diff;
+        const char* function_name;
         if (in_c64_rom_routine == NULL) {
             function_address = 0;
             address_diff = 0;
@@ -635,8 +635,19 @@ static void _c64_debug_out_processor_pc(c64_t* sys, uint64_t pins) {
         iec_get_status_text(&sys->iec_bus, iec_status);
         iec_get_device_status_text(sys->iec_device, local_iec_status);
 */
+        const char* iec_status = "?";
+        const char* local_iec_status = "?";
 
-        printf("tick:%10ld\taddr:%04x\tsys:c64 \tbus-iec:%s\tlocal-iec:%s\tlabel:%s+%x\n", get_world_tick(), cpu_pc, iec_status, local_iec_status, function_name, address_diff);
+        printf("tick:%10ld\taddr:%04x\tsys:c64 \tbus-iec:%s\tlocal-iec:%s\tlabel:%s+%x\n", get_world_tick(sys->iec_bus), cpu_pc, iec_status, local_iec_status, function_name, address_diff);
 
     }
 }
+
+#ifdef C64_ENABLE_PROFILE
+// add c64_rom_routines to a ROM routine profiler (see rom_prof.h)
+static void c64_prof_add_routines(rom_prof_t* prof) {
+    for (int i = 0; i < C64_ROM_ROUTINES_COUNT; i++) {
+        rom_prof_add_routine(prof, c64_rom_routines[i].address, c64_rom_routines[i].name);
+    }
+}
+#endif
@@ -0,0 +1,554 @@
+#pragma once
+/*#
+    # c64_rec.h
+
+    Deterministic record/replay of the external inputs of a c64_t (and its
+    C1541), for reproducing interactive sessions headless and at full speed.
+
+    Do this:
+    ~~~C
+    #define CHIPS_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Include c64.h (and its dependencies) before this file.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    Recording: call c64_rec_open() right after c64_init(), then use the
+    c64_rec_*() wrappers instead of c64_exec(), c64_key_down(), ... They call
+    through to the emulator and append compact events to the file. With a
+    closed recorder (c64_rec_t zero-initialized or after c64_rec_close()) they
+    only call through, so a frontend can always use them.
+
+    The events are the input calls in their exact order, with the c64_exec()
+    calls in between run-length encoded (the keyboard matrix timing depends
+    on the micro_seconds of each call, so a replay repeats the same calls).
+    This makes the position of each input an exact C64 cycle. Every
+    check_interval cycles a checkpoint with the cycle and a hash of the C64
+    RAM, CPU and (if enabled) drive RAM, CPU and head position is written.
+
+    Replaying: c64_replay_open() reads the header, the caller initializes a
+    c64_t with the same ROMs, c64_rec_header_t.num_drives and flags (see
+    tests/c64_replay.c) and checks it with c64_replay_check(), then
+    c64_replay_run() feeds the events back and compares the checkpoints.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2026 https://github.com/c1570
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define C64_REC_MAGIC "C64INREC"
+#define C64_REC_VERSION (2)
+
+// c64_rec_header_t.flags
+#define C64_REC_FLAG_C1541 (1<<0)       // C64 with emulated C1541
+#define C64_REC_FLAG_HOST_IEC (1<<1)    // extra IEC device for c64_rec_iec() (e.g. an external drive)
+#define C64_REC_FLAG_DRIVE_SLEEP (1<<2) // c64_desc_t.drive_sleep
+
+// event types
+typedef enum {
+    C64_REC_END,
+    C64_REC_EXEC,           // micro_seconds, count: c64_exec() called count times
+    C64_REC_KEY_DOWN,       // key code
+    C64_REC_KEY_UP,         // key code
+    C64_REC_JOYSTICK,       // joy1 mask, joy2 mask
+    C64_REC_JOYSTICK_TYPE,  // c64_joystick_type_t
+    C64_REC_KEYBUF,         // length, chars: typed into the KERNAL keyboard buffer
+    C64_REC_ATTACH_DISK,    // length, file name
+    C64_REC_REMOVE_DISK,
+    C64_REC_IEC,            // IECLINE_* signals of the host IEC device
+    C64_REC_CHECK,          // cycle, hash
+    C64_REC_ATTACH_DRIVE_DISK,  // drive index, length, file name
+} c64_rec_event_type_t;
+
+typedef struct {
+    char magic[8];          // C64_REC_MAGIC
+    uint32_t version;       // C64_REC_VERSION
+    uint32_t flags;         // C64_REC_FLAG_*
+    uint32_t c64_rom_hash;
+    uint32_t c1541_rom_hash;    // 0 without C1541
+    uint32_t check_interval;    // C64 cycles between checkpoints
+    uint32_t num_drives;        // C1541 drives (device 8..), 0 without C1541
+} c64_rec_header_t;
+
+typedef struct {
+    FILE* fp;
+    uint64_t cycle;         // C64 cycles since c64_rec_open()
+    uint64_t next_check;
+    uint32_t check_interval;
+    // pending run of c64_exec() calls
+    uint32_t exec_us;
+    uint32_t exec_count;
+} c64_rec_t;
+
+typedef enum {
+    C64_REPLAY_OK,          // event replayed, more to come
+    C64_REPLAY_END,         // end of recording
+    C64_REPLAY_MISMATCH,    // checkpoint hash differs
+    C64_REPLAY_ERROR,       // file error or unexpected event
+} c64_replay_status_t;
+
+typedef struct {
+    FILE* fp;
+    c64_rec_header_t header;
+    iecbus_device_t* host;  // for C64_REC_IEC events (C64_REC_FLAG_HOST_IEC)
+    uint64_t cycle;
+    uint32_t num_checks;    // checkpoints passed
+    uint64_t fail_cycle;    // cycle of the failed checkpoint
+    uint32_t expected_hash, actual_hash;
+} c64_replay_t;
+
+// hash of the emulated state compared at checkpoints
+uint32_t c64_rec_hash(c64_t* sys);
+
+// start recording into a file, call right after c64_init()
+bool c64_rec_open(c64_rec_t* rec, c64_t* sys, const char* filename, uint32_t flags, uint32_t check_interval);
+// finish the recording with a last checkpoint
+void c64_rec_close(c64_rec_t* rec, c64_t* sys);
+// recording wrappers
+uint32_t c64_rec_exec(c64_rec_t* rec, c64_t* sys, uint32_t micro_seconds);
+void c64_rec_key_down(c64_rec_t* rec, c64_t* sys, int key_code);
+void c64_rec_key_up(c64_rec_t* rec, c64_t* sys, int key_code);
+void c64_rec_joystick(c64_rec_t* rec, c64_t* sys, uint8_t joy1_mask, uint8_t joy2_mask);
+void c64_rec_set_joystick_type(c64_rec_t* rec, c64_t* sys, c64_joystick_type_t type);
+void c64_rec_keybuf(c64_rec_t* rec, c64_t* sys, const char* str);
+bool c64_rec_attach_disk(c64_rec_t* rec, c64_t* sys, const char* filename);
+bool c64_rec_attach_drive_disk(c64_rec_t* rec, c64_t* sys, int index, const char* filename);
+void c64_rec_remove_disk(c64_rec_t* rec, c64_t* sys);
+void c64_rec_iec(c64_rec_t* rec, c64_t* sys, iecbus_device_t* host, uint8_t signals);
+
+// open a recording and read its header
+bool c64_replay_open(c64_replay_t* rp, const char* filename);
+void c64_replay_close(c64_replay_t* rp);
+// check that sys is set up like the recording, returns 0 or an error message
+const char* c64_replay_check(const c64_replay_t* rp, c64_t* sys);
+// replay one event
+c64_replay_status_t c64_replay_step(c64_replay_t* rp, c64_t* sys);
+// replay until the end or the first failure
+c64_replay_status_t c64_replay_run(c64_replay_t* rp, c64_t* sys);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_IMPL
+#include <string.h>
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+// KERNAL keyboard buffer
+#define _C64_REC_NDX (198)
+#define _C64_REC_KEYD (631)
+#define _C64_REC_KEYD_SIZE (10)
+
+static void _c64_rec_varint(FILE* fp, uint64_t v) {
+    while (v >= 0x80) {
+        fputc((int)(v & 0x7F) | 0x80, fp);
+        v >>= 7;
+    }
+    fputc((int)v, fp);
+}
+
+static bool _c64_replay_varint(FILE* fp, uint64_t* v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const int c = fgetc(fp);
+        if (c == EOF) {
+            return false;
+        }
+        *v |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void _c64_rec_string(FILE* fp, const char* str) {
+    const size_t len = strlen(str);
+    _c64_rec_varint(fp, len);
+    fwrite(str, 1, len, fp);
+}
+
+static bool _c64_replay_string(FILE* fp, char* buf, size_t buf_size) {
+    uint64_t len;
+    if (!_c64_replay_varint(fp, &len) || (len >= buf_size) || (fread(buf, 1, (size_t)len, fp) != len)) {
+        return false;
+    }
+    buf[len] = 0;
+    return true;
+}
+
+uint32_t c64_rec_hash(c64_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    uint8_t regs[8] = {
+        m6502_a(&sys->cpu), m6502_x(&sys->cpu), m6502_y(&sys->cpu), m6502_s(&sys->cpu), m6502_p(&sys->cpu),
+        (uint8_t)m6502_pc(&sys->cpu), (uint8_t)(m6502_pc(&sys->cpu) >> 8), 0
+    };
+    uint32_t hash = chips_hash(CHIPS_HASH_INIT, sys->ram, sizeof(sys->ram));
+    hash = chips_hash(hash, regs, sizeof(regs));
+    for (int i = 0; i < sys->num_drives; i++) {
+        c1541_t* drive = c64_drive(sys, i);
+        uint8_t drive_regs[8] = {
+            m6502_a(&drive->cpu), m6502_x(&drive->cpu), m6502_y(&drive->cpu), m6502_s(&drive->cpu), m6502_p(&drive->cpu),
+            (uint8_t)m6502_pc(&drive->cpu), (uint8_t)(m6502_pc(&drive->cpu) >> 8), drive->half_track
+        };
+        hash = chips_hash(hash, drive->ram, sizeof(drive->ram));
+        hash = chips_hash(hash, drive_regs, sizeof(drive_regs));
+    }
+    return hash;
+}
+
+static void _c64_rec_flush_exec(c64_rec_t* rec) {
+    if (rec->exec_count) {
+        fputc(C64_REC_EXEC, rec->fp);
+        _c64_rec_varint(rec->fp, rec->exec_us);
+        _c64_rec_varint(rec->fp, rec->exec_count);
+        rec->exec_count = 0;
+    }
+}
+
+// flush the pending c64_exec() run and start an event
+static void _c64_rec_event(c64_rec_t* rec, c64_rec_event_type_t type) {
+    _c64_rec_flush_exec(rec);
+    fputc(type, rec->fp);
+}
+
+static void _c64_rec_check(c64_rec_t* rec, c64_t* sys) {
+    _c64_rec_event(rec, C64_REC_CHECK);
+    _c64_rec_varint(rec->fp, rec->cycle);
+    _c64_rec_varint(rec->fp, c64_rec_hash(sys));
+}
+
+bool c64_rec_open(c64_rec_t* rec, c64_t* sys, const char* filename, uint32_t flags, uint32_t check_interval) {
+    CHIPS_ASSERT(rec && sys && sys->valid && filename && (check_interval > 0));
+    memset(rec, 0, sizeof(*rec));
+    rec->fp = fopen(filename, "wb");
+    if (!rec->fp) {
+        return false;
+    }
+    c64_rec_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, C64_REC_MAGIC, sizeof(hdr.magic));
+    hdr.version = C64_REC_VERSION;
+    hdr.flags = flags;
+    if (sys->c1541.valid) {
+        hdr.flags |= C64_REC_FLAG_C1541 | (sys->drive_sleep ? C64_REC_FLAG_DRIVE_SLEEP : 0);
+        hdr.c1541_rom_hash = sys->c1541.rom_hash;
+        hdr.num_drives = (uint32_t)sys->num_drives;
+    }
+    hdr.c64_rom_hash = sys->roms.hash;
+    hdr.check_interval = check_interval;
+    fwrite(&hdr, sizeof(hdr), 1, rec->fp);
+    rec->check_interval = check_interval;
+    rec->next_check = check_interval;
+    return true;
+}
+
+void c64_rec_close(c64_rec_t* rec, c64_t* sys) {
+    CHIPS_ASSERT(rec && sys);
+    if (rec->fp) {
+        _c64_rec_check(rec, sys);
+        _c64_rec_event(rec, C64_REC_END);
+        fclose(rec->fp);
+        rec->fp = 0;
+    }
+}
+
+uint32_t c64_rec_exec(c64_rec_t* rec, c64_t* sys, uint32_t micro_seconds) {
+    CHIPS_ASSERT(rec);
+    const uint32_t ticks = c64_exec(sys, micro_seconds);
+    if (rec->fp) {
+        if (rec->exec_count && (rec->exec_us != micro_seconds)) {
+            _c64_rec_flush_exec(rec);
+        }
+        rec->exec_us = micro_seconds;
+        rec->exec_count++;
+        rec->cycle += ticks;
+        if (rec->cycle >= rec->next_check) {
+            _c64_rec_check(rec, sys);
+            rec->next_check = rec->cycle + rec->check_interval;
+        }
+    }
+    return ticks;
+}
+
+void c64_rec_key_down(c64_rec_t* rec, c64_t* sys, int key_code) {
+    CHIPS_ASSERT(rec);
+    if (rec->fp) {
+        _c64_rec_event(rec, C64_REC_KEY_DOWN);
+        _c64_rec_varint(rec->fp, (uint32_t)key_code);
+    }
+    c64_key_down(sys, key_code);
+}
+
+void c64_rec_key_up(c64_rec_t* rec, c64_t* sys, int key_code) {
+    CHIPS_ASSERT(rec);
+    if (rec->fp) {
+        _c64_rec_event(rec, C64_REC_KEY_UP);
+        _c64_rec_varint(rec->fp, (uint32_t)key_code);
+    }
+    c64_key_up(sys, key_code);
+}
+
+void c64_rec_joystick(c64_rec_t* rec, c64_t* sys, uint8_t joy1_mask, uint8_t joy2_mask) {
+    CHIPS_ASSERT(rec);
+    if (rec->fp) {
+        _c64_rec_event(rec, C64_REC_JOYSTICK);
+        fputc(joy1_mask, rec->fp);
+        fputc(joy2_mask, rec->fp);
+    }
+    c64_joystick(sys, joy1_mask, joy2_mask);
+}
+
+void c64_rec_set_joystick_type(c64_rec_t* rec, c64_t* sys, c64_joystick_type_t type) {
+    CHIPS_ASSERT(rec);
+    if (rec->fp) {
+        _c64_rec_event(rec, C64_REC_JOYSTICK_TYPE);
+        fputc(type, rec->fp);
+    }
+    c64_set_joystick_type(sys, type);
+}
+
+static void _c64_keybuf(c64_t* sys, const char* str) {
+    size_t len = strlen(str);
+    if (len > _C64_REC_KEYD_SIZE) {
+        len = _C64_REC_KEYD_SIZE;
+    }
+    sys->ram[_C64_REC_NDX] = (uint8_t)len;
+    memcpy(&sys->ram[_C64_REC_KEYD], str, len);
+}
+
+void c64_rec_keybuf(c64_rec_t* rec, c64_t* sys, const char* str) {
+    CHIPS_ASSERT(rec && sys && sys->valid && str);
+    if (rec->fp) {
+        _c64_rec_event(rec, C64_REC_KEYBUF);
+        _c64_rec_string(rec->fp, str);
+    }
+    _c64_keybuf(sys, str);
+}
+
+bool c64_rec_attach_disk(c64_rec_t* rec, c64_t* sys, const char* filename) {
+    CHIPS_ASSERT(rec && sys && sys->c1541.valid && filename);
+    if (rec->fp) {
+        _c64_rec_event(rec, C64_REC_ATTACH_DISK);
+        _c64_rec_string(rec->fp, filename);
+    }
+    return c1541_attach_disk(&sys->c1541, filename);
+}
+
+bool c64_rec_attach_drive_disk(c64_rec_t* rec, c64_t* sys, int index, const char* filename) {
+    CHIPS_ASSERT(rec && sys && sys->c1541.valid && filename);
+    if (rec->fp) {
+        _c64_rec_event(rec, C64_REC_ATTACH_DRIVE_DISK);
+        fputc(index, rec->fp);
+        _c64_rec_string(rec->fp, filename);
+    }
+    return c1541_attach_disk(c64_drive(sys, index), filename);
+}
+
+void c64_rec_remove_disk(c64_rec_t* rec, c64_t* sys) {
+    CHIPS_ASSERT(rec && sys && sys->c1541.valid);
+    if (rec->fp) {
+        _c64_rec_event(rec, C64_REC_REMOVE_DISK);
+    }
+    c1541_remove_disc(&sys->c1541);
+}
+
+void c64_rec_iec(c64_rec_t* rec, c64_t* sys, iecbus_device_t* host, uint8_t signals) {
+    CHIPS_ASSERT(rec && sys && host);
+    if (rec->fp) {
+        _c64_rec_event(rec, C64_REC_IEC);
+        fputc(signals, rec->fp);
+    }
+    iec_set_signals(sys->iec_bus, host, signals);
+}
+
+bool c64_replay_open(c64_replay_t* rp, const char* filename) {
+    CHIPS_ASSERT(rp && filename);
+    memset(rp, 0, sizeof(*rp));
+    rp->fp = fopen(filename, "rb");
+    if (!rp->fp) {
+        return false;
+    }
+    if ((1 != fread(&rp->header, sizeof(rp->header), 1, rp->fp)) ||
+        (0 != memcmp(rp->header.magic, C64_REC_MAGIC, sizeof(rp->header.magic))) ||
+        (rp->header.version < 1) || (rp->header.version > C64_REC_VERSION))
+    {
+        fclose(rp->fp);
+        rp->fp = 0;
+        return false;
+    }
+    if (rp->header.version == 1) {
+        // single drive only, the last header word was reserved
+        rp->header.num_drives = (rp->header.flags & C64_REC_FLAG_C1541) ? 1 : 0;
+    }
+    return true;
+}
+
+const char* c64_replay_check(const c64_replay_t* rp, c64_t* sys) {
+    CHIPS_ASSERT(rp && sys && sys->valid);
+    const uint32_t num_drives = sys->c1541.valid ? (uint32_t)sys->num_drives : 0;
+    const bool drive_sleep = sys->c1541.valid && sys->drive_sleep;
+    if ((sys->roms.hash != rp->header.c64_rom_hash) ||
+        (sys->c1541.valid && (sys->c1541.rom_hash != rp->header.c1541_rom_hash)))
+    {
+        return "recording was made with different ROMs";
+    }
+    if (num_drives != rp->header.num_drives) {
+        return "recording was made with a different number of drives";
+    }
+    if (drive_sleep != (0 != (rp->header.flags & C64_REC_FLAG_DRIVE_SLEEP))) {
+        return "recording was made with a different drive_sleep setting";
+    }
+    if ((rp->header.flags & C64_REC_FLAG_HOST_IEC) && !rp->host) {
+        return "recording needs a host IEC device";
+    }
+    return 0;
+}
+
+void c64_replay_close(c64_replay_t* rp) {
+    CHIPS_ASSERT(rp);
+    if (rp->fp) {
+        fclose(rp->fp);
+        rp->fp = 0;
+    }
+}
+
+c64_replay_status_t c64_replay_step(c64_replay_t* rp, c64_t* sys) {
+    CHIPS_ASSERT(rp && rp->fp && sys && sys->valid);
+    const int type = fgetc(rp->fp);
+    uint64_t a, b;
+    char str[256];
+    switch (type) {
+        case C64_REC_END:
+            return C64_REPLAY_END;
+        case C64_REC_EXEC:
+            if (!_c64_replay_varint(rp->fp, &a) || !_c64_replay_varint(rp->fp, &b)) {
+                return C64_REPLAY_ERROR;
+            }
+            for (uint64_t i = 0; i < b; i++) {
+                rp->cycle += c64_exec(sys, (uint32_t)a);
+            }
+            return C64_REPLAY_OK;
+        case C64_REC_KEY_DOWN:
+        case C64_REC_KEY_UP:
+            if (!_c64_replay_varint(rp->fp, &a)) {
+                return C64_REPLAY_ERROR;
+            }
+            if (type == C64_REC_KEY_DOWN) {
+                c64_key_down(sys, (int)a);
+            } else {
+                c64_key_up(sys, (int)a);
+            }
+            return C64_REPLAY_OK;
+        case C64_REC_JOYSTICK: {
+            const int joy1 = fgetc(rp->fp);
+            const int joy2 = fgetc(rp->fp);
+            if (joy2 == EOF) {
+                return C64_REPLAY_ERROR;
+            }
+            c64_joystick(sys, (uint8_t)joy1, (uint8_t)joy2);
+            return C64_REPLAY_OK;
+        }
+        case C64_REC_JOYSTICK_TYPE: {
+            const int joy_type = fgetc(rp->fp);
+            if (joy_type == EOF) {
+                return C64_REPLAY_ERROR;
+            }
+            c64_set_joystick_type(sys, (c64_joystick_type_t)joy_type);
+            return C64_REPLAY_OK;
+        }
+        case C64_REC_KEYBUF:
+            if (!_c64_replay_string(rp->fp, str, sizeof(str))) {
+                return C64_REPLAY_ERROR;
+            }
+            _c64_keybuf(sys, str);
+            return C64_REPLAY_OK;
+        case C64_REC_ATTACH_DISK:
+            if (!sys->c1541.valid || !_c64_replay_string(rp->fp, str, sizeof(str))) {
+                return C64_REPLAY_ERROR;
+            }
+            c1541_attach_disk(&sys->c1541, str);
+            return C64_REPLAY_OK;
+        case C64_REC_ATTACH_DRIVE_DISK: {
+            const int index = fgetc(rp->fp);
+            if ((index == EOF) || !sys->c1541.valid || (index >= sys->num_drives) ||
+                !_c64_replay_string(rp->fp, str, sizeof(str)))
+            {
+                return C64_REPLAY_ERROR;
+            }
+            c1541_attach_disk(c64_drive(sys, index), str);
+            return C64_REPLAY_OK;
+        }
+        case C64_REC_REMOVE_DISK:
+            if (!sys->c1541.valid) {
+                return C64_REPLAY_ERROR;
+            }
+            c1541_remove_disc(&sys->c1541);
+            return C64_REPLAY_OK;
+        case C64_REC_IEC: {
+            const int signals = fgetc(rp->fp);
+            if ((signals == EOF) || !rp->host) {
+                return C64_REPLAY_ERROR;
+            }
+            iec_set_signals(sys->iec_bus, rp->host, (uint8_t)signals);
+            return C64_REPLAY_OK;
+        }
+        case C64_REC_CHECK:
+            if (!_c64_replay_varint(rp->fp, &a) || !_c64_replay_varint(rp->fp, &b)) {
+                return C64_REPLAY_ERROR;
+            }
+            rp->expected_hash = (uint32_t)b;
+            rp->actual_hash = c64_rec_hash(sys);
+            if ((a != rp->cycle) || (rp->expected_hash != rp->actual_hash)) {
+                rp->fail_cycle = a;
+                return C64_REPLAY_MISMATCH;
+            }
+            rp->num_checks++;
+            return C64_REPLAY_OK;
+        default:
+            return C64_REPLAY_ERROR;
+    }
+}
+
+c64_replay_status_t c64_replay_run(c64_replay_t* rp, c64_t* sys) {
+    c64_replay_status_t status;
+    do {
+        status = c64_replay_step(rp, sys);
+    } while (status == C64_REPLAY_OK);
+    return status;
+}
+
+#endif /* CHIPS_IMPL */
@@ -272,18 +272,23 @@ static const char* opcode_list[] = {
     /* fe */  "%1$02X %2$02X %3$02X    INC $%3$02X%2$02X,X   ",
     /* ff */  "%1$02X %2$02X %3$02X    ISB $%3$02X%2$02X,X   "
 };
-static void _show_debug_trace(char device, m6502_t *cpu, float timestamp, uint8_t a, uint8_t b, uint8_t c) {
+// format one trace line, also used by tests/utils/trace_format.c
+static int _disass_trace_line(char* buf, size_t size, char device, uint16_t pc, uint8_t a, uint8_t x, uint8_t y, uint8_t s, uint8_t p, uint8_t b0, uint8_t b1, uint8_t b2, double timestamp) {
   // .C:08a9  CD 12 D0    CMP $D012     A:6f X:1b Y:00 SP:f6 ..-..I..      6795806
   char flags[] = "NV-.DIZC";
   for(int i = 0; i < 8; i++) {
     if(i==2 || i==3) continue;
-    if(!(cpu->P & (1<<(7-i)))) flags[i] = '.';
+    if(!(p & (1<<(7-i)))) flags[i] = '.';
   }
   char opc_decoded[30];
-  char debug_opc_decoded[80];
-  sprintf(opc_decoded, opcode_list[a], a, b, c, cpu->PC + ((int8_t)b) + 2);
-  sprintf(debug_opc_decoded,
-          ".%c:%04x  %s A:%02x X:%02x Y:%02x SP:%02x %s",
-          device, cpu->PC, opc_decoded, cpu->A, cpu->X, cpu->Y, cpu->S, flags);
-  printf("%s   %10.3f\n", debug_opc_decoded, timestamp);
+  snprintf(opc_decoded, sizeof(opc_decoded), opcode_list[b0], b0, b1, b2, pc + ((int8_t)b1) + 2);
+  return snprintf(buf, size, ".%c:%04x  %s A:%02x X:%02x Y:%02x SP:%02x %s   %10.3f\n",
+          device, pc, opc_decoded, a, x, y, s, flags, timestamp);
+}
+#ifdef M6502_SYNC
+static void _show_debug_trace(char device, m6502_t *cpu, float timestamp, uint8_t a, uint8_t b, uint8_t c) {
+  char line[128];
+  _disass_trace_line(line, sizeof(line), device, cpu->PC, cpu->A, cpu->X, cpu->Y, cpu->S, cpu->P, a, b, c, timestamp);
+  fputs(line, stdout);
 }
+#endif
@@ -72,7 +72,7 @@ extern "C" {
 
 #define IEC_ALL_LINES   (IECLINE_ATNA|IECLINE_RESET|IECLINE_SRQIN|IECLINE_DATA|IECLINE_CLK|IECLINE_ATN)
 
-#define IEC_BUS_MAX_DEVICES 4
+#define IEC_BUS_MAX_DEVICES 6
 
 typedef struct {
     // Each connected device pulls on its own end of the lines
@@ -82,11 +82,15 @@ typedef struct {
 } iecbus_device_t;
 
 typedef struct {
-    // Up to 4 independent devices on a single bus
+    // Up to 6 independent devices on a single bus (C64, drives 8..11 and a host device)
     iecbus_device_t devices[IEC_BUS_MAX_DEVICES];
     uint8_t usage_map;
     uint8_t lock;
     uint8_t master_tick;
+    // incremented whenever a device changes its signals
+    uint32_t edge_count;
+    // ticks of the system driving the bus, for debug output
+    uint64_t world_tick;
 } iecbus_t;
 
 // Attach device to virtual IEC bus
@@ -97,12 +101,14 @@ void iec_disconnect(iecbus_t* iec_bus, iecbus_device_t* iec_device);
 uint8_t iec_get_signals(iecbus_t* iec_bus);
 // Set a device's line status (active low)
 void iec_set_signals(iecbus_t* iec_bus, iecbus_device_t* iec_device, uint8_t signals);
+// Get number of signal changes so far, bus lines can only change if this changes
+uint32_t iec_get_edge_count(iecbus_t* iec_bus);
 
 void iec_get_status_text(iecbus_t* iec_bus, char* dest);
 void iec_get_device_status_text(iecbus_device_t* iec_device, char* dest);
 void iec_debug_print_device_signals(iecbus_device_t* device, char* prefix);
-void world_tick();
-uint64_t get_world_tick();
+void world_tick(iecbus_t *iec_bus);
+uint64_t get_world_tick(iecbus_t *iec_bus);
 void set_master_tick(iecbus_t *iec_bus);
 void clear_master_tick(iecbus_t *iec_bus);
 
@@ -138,8 +144,8 @@ iecbus_device_t* iec_connect(iecbus_t** iec_bus, bool have_atna_logic) {
       }
       *iec_bus = (iecbus_t*) mmap(NULL, sizeof(iecbus_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
       #else
-      *iec_bus = malloc(sizeof(iecbus_t));
-      CHIPS_ASSERT(iec_bus);
+      *iec_bus = calloc(1, sizeof(iecbus_t));
+      CHIPS_ASSERT(*iec_bus);
       #endif
     }
 
@@ -182,7 +188,10 @@ void iec_disconnect(iecbus_t* iec_bus, iecbus_device_t* iec_device) {
     #ifdef IECBUS_USE_SHM
     munmap(iec_bus, sizeof(*iec_bus));
     #else
-    free(iec_bus);
+    // the last device frees the bus
+    if (iec_bus->usage_map == 0) {
+        free(iec_bus);
+    }
     #endif
 }
 
@@ -220,7 +229,14 @@ uint8_t iec_get_signals(iecbus_t* iec_bus) {
 }
 
 void iec_set_signals(iecbus_t* iec_bus, iecbus_device_t* iec_device, uint8_t signals) {
-    iec_device->signals = signals;
+    if (iec_device->signals != signals) {
+        iec_device->signals = signals;
+        iec_bus->edge_count++;
+    }
+}
+
+uint32_t iec_get_edge_count(iecbus_t* iec_bus) {
+    return iec_bus->edge_count;
 }
 
 void iec_get_status_text(iecbus_t* iec_bus, char* dest) {
@@ -289,14 +305,12 @@ void iec_debug_print_device_signals(iecbus_device_t* device, char* prefix) {
     printf("\n");
 }
 
-uint64_t _world_tick = 0;
-
-void world_tick() {
-    _world_tick++;
+void world_tick(iecbus_t *iec_bus) {
+    iec_bus->world_tick++;
 }
 
-uint64_t get_world_tick() {
-    return _world_tick;
+uint64_t get_world_tick(iecbus_t *iec_bus) {
+    return iec_bus->world_tick;
 }
 
 #endif // CHIPS_IMPL
@@ -0,0 +1,369 @@
+#pragma once
+/*#
+    # rom_prof.h
+
+    Cycle profiler for 6502 code in terms of (ROM) routines.
+
+    Do this:
+    ~~~C
+    #define CHIPS_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    Routines are given as a sorted list of start addresses (see
+    c1541_routines in c1541_debug.h and c64_rom_routines in c64_debug.h),
+    a PC belongs to the routine with the next lower start address. Code
+    in front of the first routine (e.g. drive code uploaded by a fast
+    loader) is counted per 256 byte page ("$0700").
+
+    rom_prof_init() builds a flat 64K PC->routine index, so the per
+    instruction cost is a table lookup. The emulator calls rom_prof_instr()
+    at each opcode fetch with the device cycle counter, the cycles up to
+    the next opcode fetch are attributed to the routine of that
+    instruction (exclusive cycles) and to all routines on the call stack
+    (inclusive cycles). Calls are tracked via JSR and interrupts (3 bytes
+    pushed at once), returns via the stack pointer moving above the entry
+    stack pointer of a call (RTS, RTI, PLA/PLA plus RTS, TXS).
+
+    c64.h and c1541.h feed a rom_prof_t if C64_ENABLE_PROFILE or
+    C1541_ENABLE_PROFILE are defined and c64_desc_t.prof/c1541_desc_t.prof
+    is set.
+
+    Results:
+    - rom_prof_write_flat(): routines sorted by exclusive cycles
+    - rom_prof_write_folded(): one line per call stack with its cycles,
+      the input format of flamegraph.pl/speedscope/inferno
+
+    ## zlib/libpng license
+
+    Copyright (c) 2026 https://github.com/c1570
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ROM_PROF_MAX_ROUTINES (2048)    // including the 256 page routines
+#define ROM_PROF_MAX_DEPTH (64)         // tracked call depth
+#define ROM_PROF_MAX_NODES (16384)      // distinct call stacks for the folded output
+
+typedef struct {
+    const char* name;
+    uint16_t address;
+    uint64_t calls;
+    uint64_t exclusive_cycles;
+    uint64_t inclusive_cycles;
+    uint32_t active;            // number of frames on the call stack (recursion)
+} rom_prof_routine_t;
+
+// call tree node, one per distinct call stack
+typedef struct {
+    uint32_t parent;
+    uint16_t routine;
+    uint64_t cycles;
+} rom_prof_node_t;
+
+typedef struct {
+    uint16_t routine;
+    uint8_t sp;                 // stack pointer after entry
+    uint32_t node;
+    uint64_t start_cycle;
+} rom_prof_frame_t;
+
+typedef struct {
+    uint16_t* index;            // PC -> routine
+    rom_prof_routine_t* routines;
+    uint32_t num_routines;
+    rom_prof_node_t* nodes;     // node 0 is the root
+    uint32_t num_nodes;
+    uint32_t* node_hash;        // (parent, routine) -> node+1
+    uint64_t lost_cycles;       // call tree full
+    rom_prof_frame_t stack[ROM_PROF_MAX_DEPTH];
+    int depth;
+    uint64_t lost_calls;        // calls beyond ROM_PROF_MAX_DEPTH
+    bool started;
+    uint64_t last_cycle;
+    uint16_t cur_routine;
+    uint32_t cur_top;
+    uint32_t cur_node;
+    uint8_t last_opcode;
+    uint8_t last_sp;
+} rom_prof_t;
+
+// initialize a rom_prof_t instance, allocates the index and tables
+void rom_prof_init(rom_prof_t* prof);
+// free the tables
+void rom_prof_discard(rom_prof_t* prof);
+// add a routine, must be called in ascending address order
+void rom_prof_add_routine(rom_prof_t* prof, uint16_t address, const char* name);
+// clear all counters (keeps the routines)
+void rom_prof_reset(rom_prof_t* prof);
+// record an instruction at opcode fetch time
+void rom_prof_instr(rom_prof_t* prof, uint64_t cycle, uint16_t pc, uint8_t opcode, uint8_t sp);
+// write the flat profile (sorted by exclusive cycles)
+void rom_prof_write_flat(rom_prof_t* prof, FILE* fp);
+// write folded call stacks ("outer;inner cycles" per line)
+void rom_prof_write_folded(rom_prof_t* prof, FILE* fp);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_IMPL
+#include <stdlib.h>
+#include <string.h>
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+#define _ROM_PROF_HASH_SIZE (2 * ROM_PROF_MAX_NODES)
+#define _ROM_PROF_NUM_PAGES (256)
+
+void rom_prof_init(rom_prof_t* prof) {
+    CHIPS_ASSERT(prof);
+    memset(prof, 0, sizeof(*prof));
+    prof->index = (uint16_t*) malloc(0x10000 * sizeof(uint16_t));
+    prof->routines = (rom_prof_routine_t*) calloc(ROM_PROF_MAX_ROUTINES, sizeof(rom_prof_routine_t));
+    prof->nodes = (rom_prof_node_t*) calloc(ROM_PROF_MAX_NODES, sizeof(rom_prof_node_t));
+    prof->node_hash = (uint32_t*) calloc(_ROM_PROF_HASH_SIZE, sizeof(uint32_t));
+    CHIPS_ASSERT(prof->index && prof->routines && prof->nodes && prof->node_hash);
+    // one routine per page until routines are added
+    static char page_names[_ROM_PROF_NUM_PAGES][6];
+    for (int page = 0; page < _ROM_PROF_NUM_PAGES; page++) {
+        snprintf(page_names[page], sizeof(page_names[page]), "$%02X00", page);
+        prof->routines[page].name = page_names[page];
+        prof->routines[page].address = (uint16_t)(page << 8);
+    }
+    prof->num_routines = _ROM_PROF_NUM_PAGES;
+    for (uint32_t addr = 0; addr < 0x10000; addr++) {
+        prof->index[addr] = (uint16_t)(addr >> 8);
+    }
+    prof->num_nodes = 1;
+    prof->cur_routine = 0xFFFF;
+}
+
+void rom_prof_discard(rom_prof_t* prof) {
+    CHIPS_ASSERT(prof && prof->index);
+    free(prof->index);
+    free(prof->routines);
+    free(prof->nodes);
+    free(prof->node_hash);
+    prof->index = 0;
+}
+
+void rom_prof_add_routine(rom_prof_t* prof, uint16_t address, const char* name) {
+    CHIPS_ASSERT(prof && prof->index && name);
+    CHIPS_ASSERT(prof->num_routines < ROM_PROF_MAX_ROUTINES);
+    const uint16_t id = (uint16_t)prof->num_routines++;
+    CHIPS_ASSERT((id == _ROM_PROF_NUM_PAGES) || (prof->routines[id - 1].address < address));
+    prof->routines[id].name = name;
+    prof->routines[id].address = address;
+    // valid up to the next routine, which overwrites the rest
+    for (uint32_t addr = address; addr < 0x10000; addr++) {
+        prof->index[addr] = id;
+    }
+}
+
+void rom_prof_reset(rom_prof_t* prof) {
+    CHIPS_ASSERT(prof && prof->index);
+    for (uint32_t i = 0; i < prof->num_routines; i++) {
+        rom_prof_routine_t* r = &prof->routines[i];
+        r->calls = r->exclusive_cycles = r->inclusive_cycles = 0;
+        r->active = 0;
+    }
+    memset(prof->nodes, 0, ROM_PROF_MAX_NODES * sizeof(rom_prof_node_t));
+    memset(prof->node_hash, 0, _ROM_PROF_HASH_SIZE * sizeof(uint32_t));
+    prof->num_nodes = 1;
+    prof->lost_cycles = 0;
+    prof->depth = 0;
+    prof->lost_calls = 0;
+    prof->started = false;
+    prof->cur_routine = 0xFFFF;
+    prof->cur_node = 0;
+}
+
+// child node of a call tree node, 0 (root) if the tree is full
+static uint32_t _rom_prof_child(rom_prof_t* prof, uint32_t parent, uint16_t routine) {
+    uint32_t h = ((parent * 0x9E3779B1u) ^ (routine * 0x85EBCA6Bu)) & (_ROM_PROF_HASH_SIZE - 1);
+    while (prof->node_hash[h]) {
+        const uint32_t node = prof->node_hash[h] - 1;
+        if ((prof->nodes[node].parent == parent) && (prof->nodes[node].routine == routine)) {
+            return node;
+        }
+        h = (h + 1) & (_ROM_PROF_HASH_SIZE - 1);
+    }
+    if (prof->num_nodes == ROM_PROF_MAX_NODES) {
+        return 0;
+    }
+    const uint32_t node = prof->num_nodes++;
+    prof->nodes[node].parent = parent;
+    prof->nodes[node].routine = routine;
+    prof->node_hash[h] = node + 1;
+    return node;
+}
+
+static void _rom_prof_push(rom_prof_t* prof, uint64_t cycle, uint16_t routine, uint8_t sp) {
+    prof->routines[routine].calls++;
+    if (prof->depth == ROM_PROF_MAX_DEPTH) {
+        prof->lost_calls++;
+        return;
+    }
+    const uint32_t parent = prof->depth ? prof->stack[prof->depth - 1].node : 0;
+    rom_prof_frame_t* f = &prof->stack[prof->depth++];
+    f->routine = routine;
+    f->sp = sp;
+    f->node = _rom_prof_child(prof, parent, routine);
+    f->start_cycle = cycle;
+    prof->routines[routine].active++;
+}
+
+static void _rom_prof_pop(rom_prof_t* prof, uint64_t cycle) {
+    rom_prof_frame_t* f = &prof->stack[--prof->depth];
+    rom_prof_routine_t* r = &prof->routines[f->routine];
+    // only the outermost frame of a recursion counts
+    if (--r->active == 0) {
+        r->inclusive_cycles += cycle - f->start_cycle;
+    }
+}
+
+void rom_prof_instr(rom_prof_t* prof, uint64_t cycle, uint16_t pc, uint8_t opcode, uint8_t sp) {
+    if (prof->started) {
+        // cycles of the previous instruction
+        const uint64_t cycles = cycle - prof->last_cycle;
+        prof->routines[prof->cur_routine].exclusive_cycles += cycles;
+        if (prof->cur_node) {
+            prof->nodes[prof->cur_node].cycles += cycles;
+        } else {
+            prof->lost_cycles += cycles;
+        }
+        // calls and returns of the previous instruction
+        const uint8_t pushed = prof->last_sp - sp;
+        if ((pushed == 3) || ((pushed == 2) && (prof->last_opcode == 0x20))) {
+            // interrupt/BRK or JSR
+            _rom_prof_push(prof, cycle, prof->index[pc], sp);
+        } else {
+            while (prof->depth && (sp > prof->stack[prof->depth - 1].sp)) {
+                _rom_prof_pop(prof, cycle);
+            }
+        }
+    }
+    prof->started = true;
+    prof->last_cycle = cycle;
+    prof->last_opcode = opcode;
+    prof->last_sp = sp;
+    // call tree node of this instruction, a PC outside of the called
+    // routine (JMP, fall through) is a leaf of its own
+    const uint16_t routine = prof->index[pc];
+    const uint32_t top = prof->depth ? prof->stack[prof->depth - 1].node : 0;
+    if ((routine != prof->cur_routine) || (top != prof->cur_top)) {
+        prof->cur_routine = routine;
+        prof->cur_top = top;
+        if (prof->depth && (prof->stack[prof->depth - 1].routine == routine)) {
+            prof->cur_node = top;
+        } else {
+            prof->cur_node = _rom_prof_child(prof, top, routine);
+        }
+    }
+}
+
+static int _rom_prof_cmp_exclusive(const void* a, const void* b) {
+    const rom_prof_routine_t* ra = *(const rom_prof_routine_t* const*)a;
+    const rom_prof_routine_t* rb = *(const rom_prof_routine_t* const*)b;
+    if (ra->exclusive_cycles != rb->exclusive_cycles) {
+        return (ra->exclusive_cycles < rb->exclusive_cycles) ? 1 : -1;
+    }
+    return (ra->inclusive_cycles < rb->inclusive_cycles) ? 1 : (ra->inclusive_cycles > rb->inclusive_cycles) ? -1 : 0;
+}
+
+void rom_prof_write_flat(rom_prof_t* prof, FILE* fp) {
+    CHIPS_ASSERT(prof && prof->index && fp);
+    // inclusive cycles of routines still on the call stack
+    uint64_t open_cycles[ROM_PROF_MAX_ROUTINES];
+    memset(open_cycles, 0, sizeof(open_cycles));
+    for (int i = 0; i < prof->depth; i++) {
+        const rom_prof_frame_t* f = &prof->stack[i];
+        bool outermost = true;
+        for (int j = 0; j < i; j++) {
+            outermost &= (prof->stack[j].routine != f->routine);
+        }
+        if (outermost) {
+            open_cycles[f->routine] = prof->last_cycle - f->start_cycle;
+        }
+    }
+    const rom_prof_routine_t* sorted[ROM_PROF_MAX_ROUTINES];
+    uint64_t total = 0;
+    uint32_t num = 0;
+    for (uint32_t i = 0; i < prof->num_routines; i++) {
+        total += prof->routines[i].exclusive_cycles;
+        if (prof->routines[i].exclusive_cycles || prof->routines[i].inclusive_cycles || open_cycles[i]) {
+            sorted[num++] = &prof->routines[i];
+        }
+    }
+    qsort(sorted, num, sizeof(sorted[0]), _rom_prof_cmp_exclusive);
+    const double scale = total ? (100.0 / (double)total) : 0.0;
+    fprintf(fp, "%14s %7s %14s %7s %10s  %-5s %s\n", "exclusive", "%", "inclusive", "%", "calls", "addr", "routine");
+    for (uint32_t i = 0; i < num; i++) {
+        const rom_prof_routine_t* r = sorted[i];
+        const uint64_t incl = r->inclusive_cycles + open_cycles[r - prof->routines];
+        fprintf(fp, "%14llu %6.2f%% %14llu %6.2f%% %10llu  %04X  %s\n",
+            (unsigned long long)r->exclusive_cycles, (double)r->exclusive_cycles * scale,
+            (unsigned long long)incl, (double)incl * scale,
+            (unsigned long long)r->calls, r->address, r->name);
+    }
+    fprintf(fp, "%14llu cycles total\n", (unsigned long long)total);
+    if (prof->lost_cycles) {
+        fprintf(fp, "%14llu cycles not in the call tree (ROM_PROF_MAX_NODES)\n", (unsigned long long)prof->lost_cycles);
+    }
+    if (prof->lost_calls) {
+        fprintf(fp, "%14llu calls deeper than ROM_PROF_MAX_DEPTH\n", (unsigned long long)prof->lost_calls);
+    }
+}
+
+void rom_prof_write_folded(rom_prof_t* prof, FILE* fp) {
+    CHIPS_ASSERT(prof && prof->index && fp);
+    uint16_t path[ROM_PROF_MAX_NODES];
+    for (uint32_t n = 1; n < prof->num_nodes; n++) {
+        if (0 == prof->nodes[n].cycles) {
+            continue;
+        }
+        int len = 0;
+        for (uint32_t i = n; i != 0; i = prof->nodes[i].parent) {
+            path[len++] = prof->nodes[i].routine;
+        }
+        for (int i = len - 1; i >= 0; i--) {
+            fputs(prof->routines[path[i]].name, fp);
+            fputc(i ? ';' : ' ', fp);
+        }
+        fprintf(fp, "%llu\n", (unsigned long long)prof->nodes[n].cycles);
+    }
+}
+
+#endif /* CHIPS_IMPL */
@@ -0,0 +1,293 @@
+#pragma once
+/*#
+    # timeline.h
+
+    Drive and IEC bus activity events in emulated time, exported as Chrome
+    trace_event JSON (load in Perfetto or chrome://tracing).
+
+    Do this:
+    ~~~C
+    #define CHIPS_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    The emulator calls timeline_push() with compact events (a few per IEC
+    byte, none in idle ticks) into a single-producer/single-consumer ring
+    buffer, like trace.h. The consumer calls timeline_drain() off the hot path
+    (e.g. between frames) which formats the pending events as JSON:
+
+    - LED, motor and ATN on/off become complete ("X") slices
+    - the head position becomes a "half_track" counter
+    - the IEC lines become an "iec" counter with atn/clk/data (1 = active)
+    - each byte of the standard serial protocol (ready-to-send to the 8th bit
+      strobe) becomes an "iec byte" slice
+
+    A file is timeline_write_header(), any number of timeline_drain() and
+    timeline_write_footer() (which closes open slices).
+
+    Several devices (e.g. the drives of a multi-drive C64) can record into
+    the same timeline_t from one thread. Open slices are kept per device, so
+    the off event of one device never ends the slice of another.
+
+    c1541.h records into a timeline_t if C1541_ENABLE_TIMELINE is defined and
+    c1541_desc_t.timeline is set.
+
+    ## zlib/libpng license
+
+    Copyright (c) 2026 https://github.com/c1570
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// event types
+typedef enum {
+    TIMELINE_LED,           // value: 1 = on
+    TIMELINE_MOTOR,         // value: 1 = on
+    TIMELINE_ATN,           // value: 1 = asserted
+    TIMELINE_HALF_TRACK,    // value: half track under the head
+    TIMELINE_IEC_LINES,     // value: TIMELINE_IEC_* bits of the active lines
+    TIMELINE_IEC_BYTE,      // value: 1 = ready-to-send, 0 = 8th bit strobe
+    TIMELINE_NUM_TYPES,
+} timeline_type_t;
+
+// device numbers 0..30 as on the IEC bus
+#define TIMELINE_MAX_DEVICES (32)
+
+// TIMELINE_IEC_LINES value bits
+#define TIMELINE_IEC_ATN    (1<<0)
+#define TIMELINE_IEC_CLK    (1<<1)
+#define TIMELINE_IEC_DATA   (1<<2)
+
+typedef struct {
+    uint64_t cycle;         // clock cycle of the device
+    uint8_t type;           // timeline_type_t
+    uint8_t value;
+    uint8_t device;         // e.g. IEC device number, becomes the process id
+    uint8_t reserved[5];
+} timeline_event_t;
+
+// config params for timeline_init()
+typedef struct {
+    uint32_t num_events;    // ring buffer size, must be a power of 2
+    uint32_t frequency;     // device clock in Hz, for the microsecond timestamps
+} timeline_desc_t;
+
+// consumer side state of one device
+typedef struct {
+    uint64_t last_cycle;
+    uint64_t open[TIMELINE_NUM_TYPES];  // begin cycle + 1 of open slices, 0 if closed
+} timeline_device_t;
+
+typedef struct {
+    timeline_event_t* buf;
+    uint32_t mask;
+    uint32_t frequency;
+    _Atomic uint64_t head;  // next event written by the producer
+    _Atomic uint64_t tail;  // next event read by the consumer
+    uint64_t dropped;       // events lost because the buffer was full
+    // consumer side
+    bool first;             // no JSON event written yet
+    uint64_t named[4];      // devices with process/thread names written
+    timeline_device_t devices[TIMELINE_MAX_DEVICES];
+} timeline_t;
+
+// initialize a timeline_t instance, allocates the ring buffer
+void timeline_init(timeline_t* tl, const timeline_desc_t* desc);
+// free the ring buffer
+void timeline_discard(timeline_t* tl);
+// write the JSON header
+void timeline_write_header(timeline_t* tl, FILE* fp);
+// format all pending events as JSON, returns the number of events
+size_t timeline_drain(timeline_t* tl, FILE* fp);
+// close open slices and write the end of the JSON
+void timeline_write_footer(timeline_t* tl, FILE* fp);
+
+// record one event (producer side)
+static inline void timeline_push(timeline_t* tl, uint64_t cycle, uint8_t device, timeline_type_t type, uint8_t value) {
+    const uint64_t head = atomic_load_explicit(&tl->head, memory_order_relaxed);
+    if ((head - atomic_load_explicit(&tl->tail, memory_order_acquire)) > tl->mask) {
+        tl->dropped++;
+        return;
+    }
+    timeline_event_t* ev = &tl->buf[head & tl->mask];
+    ev->cycle = cycle;
+    ev->type = (uint8_t)type;
+    ev->value = value;
+    ev->device = device;
+    atomic_store_explicit(&tl->head, head + 1, memory_order_release);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_IMPL
+#include <stdlib.h>
+#include <string.h>
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+// thread ids (rows within a device) and slice names
+static const struct {
+    uint8_t tid;
+    const char* name;
+} _timeline_rows[TIMELINE_NUM_TYPES] = {
+    { 1, "LED" },
+    { 2, "motor" },
+    { 3, "ATN" },           // the bytes under ATN nest into the ATN slice
+    { 4, "half_track" },
+    { 5, "iec" },
+    { 3, "iec byte" },
+};
+
+void timeline_init(timeline_t* tl, const timeline_desc_t* desc) {
+    CHIPS_ASSERT(tl && desc);
+    CHIPS_ASSERT((desc->num_events > 0) && (0 == (desc->num_events & (desc->num_events - 1))));
+    CHIPS_ASSERT(desc->frequency > 0);
+    memset(tl, 0, sizeof(*tl));
+    tl->buf = (timeline_event_t*) calloc(desc->num_events, sizeof(timeline_event_t));
+    CHIPS_ASSERT(tl->buf);
+    tl->mask = desc->num_events - 1;
+    tl->frequency = desc->frequency;
+    tl->first = true;
+}
+
+void timeline_discard(timeline_t* tl) {
+    CHIPS_ASSERT(tl && tl->buf);
+    free(tl->buf);
+    tl->buf = 0;
+}
+
+static double _timeline_us(const timeline_t* tl, uint64_t cycle) {
+    return (double)cycle * 1000000.0 / (double)tl->frequency;
+}
+
+static void _timeline_sep(timeline_t* tl, FILE* fp) {
+    fputs(tl->first ? "\n" : ",\n", fp);
+    tl->first = false;
+}
+
+static void _timeline_slice(timeline_t* tl, FILE* fp, uint8_t device, timeline_type_t type, uint64_t begin, uint64_t end) {
+    _timeline_sep(tl, fp);
+    fprintf(fp, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+        _timeline_rows[type].name, device, _timeline_rows[type].tid,
+        _timeline_us(tl, begin), _timeline_us(tl, end - begin));
+}
+
+// process and thread name metadata, once per device
+static void _timeline_names(timeline_t* tl, FILE* fp, uint8_t device) {
+    if (tl->named[device >> 6] & (1ULL << (device & 63))) {
+        return;
+    }
+    tl->named[device >> 6] |= 1ULL << (device & 63);
+    _timeline_sep(tl, fp);
+    fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"drive %d\"}}", device, device);
+    for (int type = 0; type < TIMELINE_NUM_TYPES; type++) {
+        if (type != TIMELINE_IEC_BYTE) {
+            _timeline_sep(tl, fp);
+            fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                device, _timeline_rows[type].tid, _timeline_rows[type].name);
+        }
+    }
+}
+
+static void _timeline_event(timeline_t* tl, FILE* fp, const timeline_event_t* ev) {
+    CHIPS_ASSERT(ev->device < TIMELINE_MAX_DEVICES);
+    const timeline_type_t type = (timeline_type_t)ev->type;
+    timeline_device_t* dev = &tl->devices[ev->device];
+    _timeline_names(tl, fp, ev->device);
+    switch (type) {
+        case TIMELINE_LED:
+        case TIMELINE_MOTOR:
+        case TIMELINE_ATN:
+        case TIMELINE_IEC_BYTE:
+            if (ev->value) {
+                // an unfinished byte is dropped at the next ready-to-send
+                dev->open[type] = ev->cycle + 1;
+            } else if (dev->open[type]) {
+                _timeline_slice(tl, fp, ev->device, type, dev->open[type] - 1, ev->cycle);
+                dev->open[type] = 0;
+            }
+            break;
+        case TIMELINE_HALF_TRACK:
+            _timeline_sep(tl, fp);
+            fprintf(fp, "{\"name\":\"half_track\",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3f,\"args\":{\"half_track\":%d}}",
+                ev->device, _timeline_us(tl, ev->cycle), ev->value);
+            break;
+        case TIMELINE_IEC_LINES:
+            _timeline_sep(tl, fp);
+            fprintf(fp, "{\"name\":\"iec\",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3f,\"args\":{\"atn\":%d,\"clk\":%d,\"data\":%d}}",
+                ev->device, _timeline_us(tl, ev->cycle),
+                !!(ev->value & TIMELINE_IEC_ATN), !!(ev->value & TIMELINE_IEC_CLK), !!(ev->value & TIMELINE_IEC_DATA));
+            break;
+        default:
+            break;
+    }
+    dev->last_cycle = ev->cycle;
+}
+
+void timeline_write_header(timeline_t* tl, FILE* fp) {
+    CHIPS_ASSERT(tl && fp);
+    tl->first = true;
+    memset(tl->named, 0, sizeof(tl->named));
+    fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", fp);
+}
+
+size_t timeline_drain(timeline_t* tl, FILE* fp) {
+    CHIPS_ASSERT(tl && tl->buf && fp);
+    const uint64_t head = atomic_load_explicit(&tl->head, memory_order_acquire);
+    const uint64_t tail = atomic_load_explicit(&tl->tail, memory_order_relaxed);
+    for (uint64_t i = tail; i != head; i++) {
+        _timeline_event(tl, fp, &tl->buf[i & tl->mask]);
+    }
+    atomic_store_explicit(&tl->tail, head, memory_order_release);
+    return (size_t)(head - tail);
+}
+
+void timeline_write_footer(timeline_t* tl, FILE* fp) {
+    CHIPS_ASSERT(tl && fp);
+    for (int device = 0; device < TIMELINE_MAX_DEVICES; device++) {
+        timeline_device_t* dev = &tl->devices[device];
+        for (int type = 0; type < TIMELINE_NUM_TYPES; type++) {
+            if (dev->open[type] && (type != TIMELINE_IEC_BYTE)) {
+                _timeline_slice(tl, fp, (uint8_t)device, (timeline_type_t)type, dev->open[type] - 1, dev->last_cycle);
+            }
+            dev->open[type] = 0;
+        }
+    }
+    fputs("\n]}\n", fp);
+}
+
+#endif /* CHIPS_IMPL */
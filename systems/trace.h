@@ -0,0 +1,195 @@
+#pragma once
+/*#
+    # trace.h
+
+    Binary instruction trace of 6502-family CPUs, written into a lock-free
+    single-producer/single-consumer ring buffer.
+
+    Do this:
+    ~~~C
+    #define CHIPS_IMPL
+    ~~~
+    before you include this file in *one* C or C++ file to create the
+    implementation.
+
+    Optionally provide the following macros with your own implementation
+
+    ~~~C
+    CHIPS_ASSERT(c)
+    ~~~
+        your own assert macro (default: assert(c))
+
+    The emulator (producer) calls trace_push() once per instruction, the
+    consumer (e.g. a writer thread, or the emulator loop between frames)
+    calls trace_drain() to append the pending records to a file. A trace
+    file is a trace_file_header_t followed by trace_record_t items, use
+    tests/utils/trace_format.c to turn it into the `.C:`/`.8:` text format.
+
+    c64.h and c1541.h record into a trace_t if C64_ENABLE_TRACE or
+    C1541_ENABLE_TRACE are defined and c64_desc_t.trace/c1541_desc_t.trace
+    is set (with both defined, the C64 passes its trace on to the C1541).
+
+    ## zlib/libpng license
+
+    Copyright (c) 2026 https://github.com/c1570
+    This software is provided 'as-is', without any express or implied warranty.
+    In no event will the authors be held liable for any damages arising from the
+    use of this software.
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+        1. The origin of this software must not be misrepresented; you must not
+        claim that you wrote the original software. If you use this software in a
+        product, an acknowledgment in the product documentation would be
+        appreciated but is not required.
+        2. Altered source versions must be plainly marked as such, and must not
+        be misrepresented as being the original software.
+        3. This notice may not be removed or altered from any source
+        distribution.
+#*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_FILE_MAGIC "CHIPSTRC"
+#define TRACE_FILE_VERSION (1)
+
+// device ids
+#define TRACE_DEVICE_C64 ('C')
+#define TRACE_DEVICE_C1541 ('8')
+
+// one executed instruction, state at the opcode fetch
+typedef struct {
+    uint64_t cycle;         // clock cycle of the device
+    uint16_t pc;
+    uint8_t a, x, y, s, p;
+    uint8_t bytes[3];       // opcode and operand bytes at pc
+    uint8_t device;         // TRACE_DEVICE_*
+    uint8_t reserved[3];
+} trace_record_t;
+
+typedef struct {
+    char magic[8];          // TRACE_FILE_MAGIC
+    uint32_t version;       // TRACE_FILE_VERSION
+    uint32_t record_size;   // sizeof(trace_record_t)
+} trace_file_header_t;
+
+// config params for trace_init()
+typedef struct {
+    uint32_t num_records;   // ring buffer size, must be a power of 2
+    // keep the latest records instead of dropping new ones when the buffer
+    // is full (flight recorder), only drain after the producer stopped
+    bool overwrite;
+} trace_desc_t;
+
+typedef struct {
+    trace_record_t* buf;
+    uint32_t mask;
+    bool overwrite;
+    _Atomic uint64_t head;  // next record written by the producer
+    _Atomic uint64_t tail;  // next record read by the consumer
+    uint64_t dropped;       // records lost because the buffer was full
+} trace_t;
+
+// initialize a trace_t instance, allocates the ring buffer
+void trace_init(trace_t* trace, const trace_desc_t* desc);
+// free the ring buffer
+void trace_discard(trace_t* trace);
+// write a trace file header
+bool trace_write_header(FILE* fp);
+// read and check a trace file header
+bool trace_read_header(FILE* fp);
+// write all pending records to a file, returns the number of records
+size_t trace_drain(trace_t* trace, FILE* fp);
+
+// record one instruction (producer side)
+static inline void trace_push(trace_t* trace, const trace_record_t* rec) {
+    const uint64_t head = atomic_load_explicit(&trace->head, memory_order_relaxed);
+    if (!trace->overwrite && ((head - atomic_load_explicit(&trace->tail, memory_order_acquire)) > trace->mask)) {
+        trace->dropped++;
+        return;
+    }
+    trace->buf[head & trace->mask] = *rec;
+    atomic_store_explicit(&trace->head, head + 1, memory_order_release);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+/*-- IMPLEMENTATION ----------------------------------------------------------*/
+#ifdef CHIPS_IMPL
+#include <stdlib.h>
+#include <string.h>
+#ifndef CHIPS_ASSERT
+    #include <assert.h>
+    #define CHIPS_ASSERT(c) assert(c)
+#endif
+
+void trace_init(trace_t* trace, const trace_desc_t* desc) {
+    CHIPS_ASSERT(trace && desc);
+    CHIPS_ASSERT((desc->num_records > 0) && (0 == (desc->num_records & (desc->num_records - 1))));
+    memset(trace, 0, sizeof(*trace));
+    trace->buf = (trace_record_t*) calloc(desc->num_records, sizeof(trace_record_t));
+    CHIPS_ASSERT(trace->buf);
+    trace->mask = desc->num_records - 1;
+    trace->overwrite = desc->overwrite;
+}
+
+void trace_discard(trace_t* trace) {
+    CHIPS_ASSERT(trace && trace->buf);
+    free(trace->buf);
+    trace->buf = 0;
+}
+
+bool trace_write_header(FILE* fp) {
+    CHIPS_ASSERT(fp);
+    trace_file_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, TRACE_FILE_MAGIC, sizeof(hdr.magic));
+    hdr.version = TRACE_FILE_VERSION;
+    hdr.record_size = sizeof(trace_record_t);
+    return 1 == fwrite(&hdr, sizeof(hdr), 1, fp);
+}
+
+bool trace_read_header(FILE* fp) {
+    CHIPS_ASSERT(fp);
+    trace_file_header_t hdr;
+    if (1 != fread(&hdr, sizeof(hdr), 1, fp)) {
+        return false;
+    }
+    return (0 == memcmp(hdr.magic, TRACE_FILE_MAGIC, sizeof(hdr.magic))) &&
+           (hdr.version == TRACE_FILE_VERSION) &&
+           (hdr.record_size == sizeof(trace_record_t));
+}
+
+size_t trace_drain(trace_t* trace, FILE* fp) {
+    CHIPS_ASSERT(trace && trace->buf && fp);
+    const uint64_t head = atomic_load_explicit(&trace->head, memory_order_acquire);
+    uint64_t tail = atomic_load_explicit(&trace->tail, memory_order_relaxed);
+    const uint64_t size = (uint64_t)trace->mask + 1;
+    if ((head - tail) > size) {
+        // overwrite mode, older records are gone
+        trace->dropped += (head - tail) - size;
+        tail = head - size;
+    }
+    const size_t num = (size_t)(head - tail);
+    // write in at most two contiguous chunks
+    const uint32_t start = (uint32_t)(tail & trace->mask);
+    size_t first = size - start;
+    if (first > num) {
+        first = num;
+    }
+    fwrite(&trace->buf[start], sizeof(trace_record_t), first, fp);
+    fwrite(&trace->buf[0], sizeof(trace_record_t), num - first, fp);
+    atomic_store_explicit(&trace->tail, head, memory_order_release);
+    return num;
+}
+
+#endif /* CHIPS_IMPL */
@@ -0,0 +1,123 @@
+/*
+    c1541_core_equivalence.c
+
+    Runs the C1541 alone on the C64 IEC outputs logged by
+    c64_core_equivalence -i and prints a running checksum over the CPU bus
+    and register state of every drive tick. Build once against m6502.h and
+    m6522.h and once with -DUSE_C1541_CORE against the generated
+    m6502_c1541.h and m6522_fast.h (as in the RP2040 firmware), both
+    outputs must be identical. The drive RAM checksum of the last line is
+    the same as the one of the C64 run that wrote the log. See
+    run_core_equivalence.sh.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#ifdef USE_C1541_CORE
+#define likely(x) __builtin_expect(!!(x), 1)
+#include "../chips/m6502_c1541.h"
+#include "../chips/m6522_fast.h"
+#else
+#include "../chips/m6502.h"
+#include "../chips/m6522.h"
+#endif
+#include "../chips/clk.h"
+#include "../chips/mem.h"
+#include "../systems/c1541.h"
+#include "c1541-roms.h"
+
+// print a checksum line every N drive ticks
+#define REPORT_TICKS (20000)
+
+static c1541_t drive;
+static uint64_t hash = 0xcbf29ce484222325ULL;
+
+static inline void hash_byte(uint8_t b) {
+    hash = (hash ^ b) * 0x100000001b3ULL;
+}
+
+// called after each drive tick
+static void hash_tick(c1541_t* sys) {
+    const uint16_t addr = C1541_GET_ADDR(sys->pins, sys);
+    hash_byte(addr & 0xFF);
+    hash_byte(addr >> 8);
+    hash_byte(C1541_GET_DATA(sys->pins, sys));
+    hash_byte(((sys->pins & M6502_RW) ? 1 : 0) | ((sys->pins & M6502_SYNC) ? 2 : 0));
+    hash_byte(m6502_a(&sys->cpu));
+    hash_byte(m6502_x(&sys->cpu));
+    hash_byte(m6502_y(&sys->cpu));
+    hash_byte(m6502_s(&sys->cpu));
+    hash_byte(m6502_p(&sys->cpu));
+    hash_byte(m6502_pc(&sys->cpu) & 0xFF);
+    hash_byte(m6502_pc(&sys->cpu) >> 8);
+    hash_byte(sys->half_track);
+}
+
+static uint64_t hash_mem(const uint8_t* ptr, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ ptr[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+int main(int argc, char* argv[]) {
+    const char* disk_filename = NULL;
+    const char* log_filename = NULL;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc)) {
+            disk_filename = argv[++i];
+        } else if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc)) {
+            log_filename = argv[++i];
+        } else {
+            log_filename = NULL;
+            break;
+        }
+    }
+    if (!log_filename) {
+        fprintf(stderr, "Usage: %s -i IECLOG [-d FILENAME.g64]\n", argv[0]);
+        return 1;
+    }
+    FILE* log = fopen(log_filename, "rb");
+    if (!log) {
+        fprintf(stderr, "Cannot read IEC log: %s\n", log_filename);
+        return 1;
+    }
+    // the C64 side of the bus, connected first like in c64.h
+    iecbus_t* bus = NULL;
+    iecbus_device_t* host = iec_connect(&bus, false);
+    c1541_init(&drive, &(c1541_desc_t){
+        .iec_bus = bus,
+        .roms = {
+            .c000_dfff = { .ptr=dump_1541_c000_325302_01_bin, .size=sizeof(dump_1541_c000_325302_01_bin) },
+            .e000_ffff = { .ptr=dump_1541_e000_901229_06aa_bin, .size=sizeof(dump_1541_e000_901229_06aa_bin) }
+        },
+    });
+    if (disk_filename && !c1541_attach_disk(&drive, disk_filename)) {
+        fprintf(stderr, "Failed to attach disk image: %s\n", disk_filename);
+        return 1;
+    }
+    // each record is drive tick << 8 | C64 IEC outputs from that tick on,
+    // the last one gives the number of ticks
+    uint64_t rec, tick = 0;
+    while (1 == fread(&rec, sizeof(rec), 1, log)) {
+        for (; tick < (rec >> 8); tick++) {
+            c1541_tick(&drive);
+            hash_tick(&drive);
+            if (((tick + 1) % REPORT_TICKS) == 0) {
+                printf("%10llu 1541 %016llx pc %04x\n",
+                    (unsigned long long)(tick + 1), (unsigned long long)hash, m6502_pc(&drive.cpu));
+            }
+        }
+        iec_set_signals(bus, host, (uint8_t)rec);
+    }
+    fclose(log);
+    printf("ram 1541 %016llx\n", (unsigned long long)hash_mem(drive.ram, sizeof(drive.ram)));
+    c1541_discard(&drive);
+    iec_disconnect(bus, host);
+    return 0;
+}
@@ -0,0 +1,168 @@
+/*
+    c1541_gcrimg.c
+
+    Converts a .d64 or .g64 file into a GCR image (c1541_gcrimg_build() in
+    systems/c1541.h) for the flash image store of the RP2040 drive.
+
+    c1541_gcrimg [-u] IMAGE.d64 OUT       raw GCR image, or UF2 with -u
+    c1541_gcrimg -s TTY IMAGE.d64         upload to a running drive over UART
+
+    The UF2 places the image at the store address (GCRIMG_FLASH_OFFSET in
+    rp2040/c1541.c), so it can be flashed next to the firmware or loaded by
+    rp2_test_runner.js (C1541_IMAGE=OUT.uf2). The upload sends one flash
+    sector at a time and waits for the drive's '.' after each, the drive
+    answers "OK" or "ERR" at the end.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#include "../chips/m6502.h"
+#include "../chips/m6522.h"
+#include "../chips/mem.h"
+#include "../systems/c1541.h"
+
+#define GCRIMG_MAX_SIZE     (1024 * 1024)
+#define GCRIMG_FLASH_ADDR   (0x10000000 + GCRIMG_MAX_SIZE)
+#define GCRIMG_SECTOR_SIZE  (4096)
+
+#define UF2_MAGIC_START0    (0x0A324655)
+#define UF2_MAGIC_START1    (0x9E5D5157)
+#define UF2_MAGIC_END       (0x0AB16F30)
+#define UF2_FLAG_FAMILY_ID  (0x00002000)
+#define UF2_FAMILY_RP2040   (0xE48BFF56)
+#define UF2_PAYLOAD_SIZE    (256)
+
+static void usage(void) {
+    fprintf(stderr, "usage: c1541_gcrimg [-u] IMAGE.d64|.g64 OUT\n");
+    fprintf(stderr, "       c1541_gcrimg -s TTY IMAGE.d64|.g64\n");
+}
+
+static bool write_raw(FILE* fp, const uint8_t* image, size_t size) {
+    return fwrite(image, 1, size, fp) == size;
+}
+
+static void put_u32(uint8_t* dst, uint32_t v) {
+    dst[0] = v; dst[1] = v >> 8; dst[2] = v >> 16; dst[3] = v >> 24;
+}
+
+static bool write_uf2(FILE* fp, const uint8_t* image, size_t size) {
+    const uint32_t num_blocks = (size + UF2_PAYLOAD_SIZE - 1) / UF2_PAYLOAD_SIZE;
+    for (uint32_t i = 0; i < num_blocks; i++) {
+        uint8_t block[512] = {0};
+        const size_t offset = i * UF2_PAYLOAD_SIZE;
+        const size_t len = (size - offset) < UF2_PAYLOAD_SIZE ? (size - offset) : UF2_PAYLOAD_SIZE;
+        put_u32(block + 0, UF2_MAGIC_START0);
+        put_u32(block + 4, UF2_MAGIC_START1);
+        put_u32(block + 8, UF2_FLAG_FAMILY_ID);
+        put_u32(block + 12, GCRIMG_FLASH_ADDR + offset);
+        put_u32(block + 16, UF2_PAYLOAD_SIZE);
+        put_u32(block + 20, i);
+        put_u32(block + 24, num_blocks);
+        put_u32(block + 28, UF2_FAMILY_RP2040);
+        memcpy(block + 32, image + offset, len);
+        put_u32(block + 508, UF2_MAGIC_END);
+        if (fwrite(block, 1, sizeof(block), fp) != sizeof(block)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool upload(const char* tty, const uint8_t* image, size_t size) {
+    const int fd = open(tty, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "c1541_gcrimg: failed to open %s\n", tty);
+        return false;
+    }
+    struct termios tio;
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    cfsetspeed(&tio, B115200);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 50;   // 5 s, erasing a sector takes up to 400 ms
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+
+    bool ok = true;
+    for (size_t offset = 0; ok && (offset < size); offset += GCRIMG_SECTOR_SIZE) {
+        const size_t len = (size - offset) < GCRIMG_SECTOR_SIZE ? (size - offset) : GCRIMG_SECTOR_SIZE;
+        ok = write(fd, image + offset, len) == (ssize_t)len;
+        // skip other UART output of the drive up to the sector ack
+        char c = 0;
+        while (ok && (c != '.')) {
+            ok = read(fd, &c, 1) == 1;
+        }
+        fprintf(stderr, "\r%zu / %zu", offset + len, size);
+    }
+    fprintf(stderr, "\n");
+    char reply[8] = {0};
+    for (int i = 0; ok && (i < 7); i++) {
+        ok = read(fd, &reply[i], 1) == 1;
+        if (reply[i] == '\n') {
+            break;
+        }
+    }
+    close(fd);
+    if (!ok || (0 != strncmp(reply, "OK", 2))) {
+        fprintf(stderr, "c1541_gcrimg: upload failed\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool uf2 = false;
+    const char* tty = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "us:")) != -1) {
+        switch (opt) {
+            case 'u': uf2 = true; break;
+            case 's': tty = optarg; break;
+            default: usage(); return 2;
+        }
+    }
+    if ((argc - optind) != (tty ? 1 : 2)) {
+        usage();
+        return 2;
+    }
+    uint8_t* image = aligned_alloc(4, GCRIMG_MAX_SIZE);
+    if (!image) {
+        return 2;
+    }
+    const size_t size = c1541_gcrimg_build(argv[optind], image, GCRIMG_MAX_SIZE);
+    if ((0 == size) || !c1541_gcrimg_check((chips_range_t){ .ptr = image, .size = size })) {
+        fprintf(stderr, "c1541_gcrimg: failed to convert %s\n", argv[optind]);
+        free(image);
+        return 1;
+    }
+    const c1541_gcrimg_header_t* hdr = (const c1541_gcrimg_header_t*)image;
+    int num_tracks = 0;
+    for (int i = 0; i < C1541_GCRIMG_HALF_TRACKS; i++) {
+        num_tracks += (0 != hdr->tracks[i].offset);
+    }
+    fprintf(stderr, "c1541_gcrimg: %zu bytes, %d half-tracks, hash %08x\n", size, num_tracks, hdr->hash);
+
+    bool ok;
+    if (tty) {
+        ok = upload(tty, image, size);
+    }
+    else {
+        FILE* fp = fopen(argv[optind + 1], "wb");
+        if (!fp) {
+            fprintf(stderr, "c1541_gcrimg: failed to create %s\n", argv[optind + 1]);
+            free(image);
+            return 2;
+        }
+        ok = uf2 ? write_uf2(fp, image, size) : write_raw(fp, image, size);
+        ok &= (0 == fclose(fp));
+    }
+    free(image);
+    return ok ? 0 : 1;
+}
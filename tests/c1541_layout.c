@@ -0,0 +1,69 @@
+/*
+    c1541_layout.c
+
+    Checks the memory layout of c1541_t: the per-tick state must stay within
+    the first two cache lines, directly followed by the chips, and the bulk
+    data (track buffer, memory map, disk file name, ROM copy) must stay out
+    of the struct so that many drive instances can be packed closely.
+
+    Build with the same flags as the emulator (e.g. -DUSE_CONNOMORE_M6502,
+    -DUSE_FAST_M6522), prints the layout and returns 1 on a violation.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "../chips/chips_common.h"
+#ifdef USE_CONNOMORE_M6502
+#define likely(x) __builtin_expect(!!(x), 1)
+#include "../chips/m6502_connomore64.h"
+#else
+#include "../chips/m6502.h"
+#endif
+#ifdef USE_FAST_M6522
+#include "../chips/m6522_fast.h"
+#else
+#include "../chips/m6522.h"
+#endif
+#include "../chips/mem.h"
+#include "../systems/c1541.h"
+
+#define CACHE_LINE (64)
+// per-tick state in front of the CPU
+#define MAX_HOT_BYTES (2 * CACHE_LINE)
+// everything except the bulk storage: the drive RAM plus 1 KB
+#define MAX_SIZE (0x0800 + 1024)
+
+static int errors = 0;
+
+static void check(bool cond, const char* msg) {
+    if (!cond) {
+        printf("FAIL: %s\n", msg);
+        errors++;
+    }
+}
+
+int main() {
+    printf("sizeof(c1541_t)         %5zu\n", sizeof(c1541_t));
+    printf("alignof(c1541_t)        %5zu\n", _Alignof(c1541_t));
+    printf("sizeof(c1541_storage_t) %5zu\n", sizeof(c1541_storage_t));
+    printf("hot state               %5zu\n", offsetof(c1541_t, cpu));
+    printf("cpu                     %5zu +%zu\n", offsetof(c1541_t, cpu), sizeof(m6502_t));
+    printf("via_1                   %5zu +%zu\n", offsetof(c1541_t, via_1), sizeof(m6522_t));
+    printf("via_2                   %5zu +%zu\n", offsetof(c1541_t, via_2), sizeof(m6522_t));
+    printf("ram                     %5zu +%zu\n", offsetof(c1541_t, ram), sizeof(((c1541_t*)0)->ram));
+    printf("cold state              %5zu\n", offsetof(c1541_t, valid));
+
+    check((_Alignof(c1541_t) % CACHE_LINE) == 0, "c1541_t is not cache line aligned");
+    check(offsetof(c1541_t, pins) == 0, "pins is not the first member");
+    check(offsetof(c1541_t, cpu) <= MAX_HOT_BYTES, "per-tick state exceeds two cache lines");
+    check(offsetof(c1541_t, via_1) < offsetof(c1541_t, ram), "VIAs are not in front of the RAM");
+    check(offsetof(c1541_t, via_2) < offsetof(c1541_t, ram), "VIAs are not in front of the RAM");
+    check(offsetof(c1541_t, ram) < offsetof(c1541_t, valid), "cold state is not behind the RAM");
+    check(sizeof(c1541_t) <= MAX_SIZE, "c1541_t contains bulk data");
+    if (errors == 0) {
+        printf("OK\n");
+    }
+    return errors ? 1 : 0;
+}
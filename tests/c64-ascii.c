@@ -24,22 +24,66 @@
 #include "../chips/clk.h"
 #include "../systems/c1530.h"
 #include "../chips/m6522.h"
-static bool drive_led_status = 0;
-static bool drive_motor_status = 1;
-static int drive_current_halftrack;
-#define C1541_TRACK_CHANGED_HOOK(s,v) drive_current_halftrack=v
-#define C1541_MOTOR_CHANGED_HOOK(s,v) drive_motor_status=v
-#define C1541_LED_CHANGED_HOOK(s,v) drive_led_status=v
 //#define C64_ENABLE_DEBUG
 //#define C1541_ENABLE_DEBUG
+// binary instruction trace (-t FILENAME), see tests/utils/trace_format.c
+//#define C64_ENABLE_TRACE
+//#define C1541_ENABLE_TRACE
+// ROM routine profile (-p PREFIX), writes PREFIX.c64/.c1541 flat profiles and .folded call stacks
+//#define C64_ENABLE_PROFILE
+//#define C1541_ENABLE_PROFILE
+// drive and IEC bus activity as Chrome trace_event JSON (-e FILENAME), see systems/timeline.h
+//#define C1541_ENABLE_TIMELINE
 #include "../systems/c1541.h"
 #include "../systems/disass.h"
 #include "../systems/c1541_debug.h"
 #include "../systems/c64.h"
+#include "../systems/c64_rec.h"
+#ifdef C64_ENABLE_PROFILE
+#include "../systems/c64_debug.h"
+#endif
 #include "c64-roms.h"
 #include "c1541-roms.h"
 
 static c64_t c64;
+// input recording (-R FILENAME), replay with c64_replay
+static c64_rec_t input_rec;
+static const char* rec_filename;
+#if defined(C64_ENABLE_TRACE) || defined(C1541_ENABLE_TRACE)
+#define TRACE_ENABLED
+static trace_t instr_trace;
+static FILE* trace_file;
+#endif
+#if defined(C64_ENABLE_PROFILE) || defined(C1541_ENABLE_PROFILE)
+#define PROFILE_ENABLED
+static const char* prof_prefix;
+
+static void write_profile(rom_prof_t* prof, const char* name) {
+    char filename[1024];
+    snprintf(filename, sizeof(filename), "%s.%s.txt", prof_prefix, name);
+    FILE* fp = fopen(filename, "w");
+    if (fp) {
+        rom_prof_write_flat(prof, fp);
+        fclose(fp);
+    }
+    snprintf(filename, sizeof(filename), "%s.%s.folded", prof_prefix, name);
+    fp = fopen(filename, "w");
+    if (fp) {
+        rom_prof_write_folded(prof, fp);
+        fclose(fp);
+    }
+}
+#endif
+#ifdef C1541_ENABLE_TIMELINE
+static timeline_t drive_timeline;
+static FILE* timeline_file;
+#endif
+#ifdef C64_ENABLE_PROFILE
+static rom_prof_t c64_prof;
+#endif
+#ifdef C1541_ENABLE_PROFILE
+static rom_prof_t c1541_prof;
+#endif
 
 // run the emulator and render-loop at 30fps
 #define FRAME_USEC (33333)
@@ -88,8 +132,7 @@ static void init_c64_colors(void) {
 }
 
 void set_keybuf(char* str) {
-    c64.ram[198] = strlen(str);
-    for(uint i=0; i<c64.ram[198]; i++) { c64.ram[631+i]=str[i]; };
+    c64_rec_keybuf(&input_rec, &c64, str);
 }
 
 void update_screen(c64_t* c64) {
@@ -144,10 +187,10 @@ void update_screen(c64_t* c64) {
     }
     attron(A_REVERSE);
     attron(COLOR_PAIR(231*16));
-    mvaddch(25+BORDER_VERT+3, 99, drive_led_status ? 'X' : '.');
-    mvaddch(25+BORDER_VERT+3, 97, drive_motor_status ? 'O' : '.');
+    mvaddch(25+BORDER_VERT+3, 99, c1541_led_on(&c64->c1541) ? 'X' : '.');
+    mvaddch(25+BORDER_VERT+3, 97, c1541_motor_on(&c64->c1541) ? 'O' : '.');
     char str_track[10];
-    sprintf(str_track, "%4.1f", ((float)drive_current_halftrack)/2.0);
+    sprintf(str_track, "%4.1f", ((float)c64->c1541.half_track)/2.0);
     mvaddstr(25+BORDER_VERT+3, 92, str_track);
     attroff(A_REVERSE);
     refresh();
@@ -155,6 +198,10 @@ void update_screen(c64_t* c64) {
 
 int main(int argc, char* argv[]) {
     const char* disk_filename = NULL;
+    // disk images of the extra drives (device 9..)
+    const char* ext_disk_filenames[C64_MAX_DRIVES - 1] = {0};
+    int num_drives = 1;
+    bool drive_sleep = false;
     bool enable_curses = 1;
 
     // Parse command line arguments
@@ -166,12 +213,54 @@ int main(int argc, char* argv[]) {
                 fprintf(stderr, "Error: %s requires a filename argument\n", argv[i]);
                 return 1;
             }
+        } else if ((strcmp(argv[i], "-D") == 0) && (i + 1 < argc)) {
+            if (num_drives == C64_MAX_DRIVES) {
+                fprintf(stderr, "Error: at most %d drives\n", C64_MAX_DRIVES);
+                return 1;
+            }
+            ext_disk_filenames[num_drives++ - 1] = argv[++i];
+        } else if (strcmp(argv[i], "-S") == 0) {
+            drive_sleep = true;
         } else if (strcmp(argv[i], "-c") == 0) {
             enable_curses = 0;
+        } else if ((strcmp(argv[i], "-R") == 0) && (i + 1 < argc)) {
+            rec_filename = argv[++i];
+        #ifdef TRACE_ENABLED
+        } else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) {
+            trace_file = fopen(argv[++i], "wb");
+            if (!trace_file || !trace_write_header(trace_file)) {
+                fprintf(stderr, "Error: cannot write trace file %s\n", argv[i]);
+                return 1;
+            }
+        #endif
+        #ifdef PROFILE_ENABLED
+        } else if ((strcmp(argv[i], "-p") == 0) && (i + 1 < argc)) {
+            prof_prefix = argv[++i];
+        #endif
+        #ifdef C1541_ENABLE_TIMELINE
+        } else if ((strcmp(argv[i], "-e") == 0) && (i + 1 < argc)) {
+            timeline_file = fopen(argv[++i], "w");
+            if (!timeline_file) {
+                fprintf(stderr, "Error: cannot write timeline file %s\n", argv[i]);
+                return 1;
+            }
+        #endif
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             printf("Usage: %s [-d|--disk FILENAME] [-h|--help]\n", argv[0]);
             printf("  -d, --disk FILENAME  Attach G64 disk image\n");
+            printf("  -D FILENAME          Add a drive (device 9..11) with a disk image\n");
+            printf("  -S                   Let idle drives sleep (approximate, see c64_desc_t.drive_sleep)\n");
             printf("  -c,                  Disable ncurses\n");
+            printf("  -R FILENAME          Record inputs for c64_replay\n");
+            #ifdef TRACE_ENABLED
+            printf("  -t FILENAME          Write binary instruction trace\n");
+            #endif
+            #ifdef PROFILE_ENABLED
+            printf("  -p PREFIX            Write ROM routine profiles to PREFIX.*.txt/.folded\n");
+            #endif
+            #ifdef C1541_ENABLE_TIMELINE
+            printf("  -e FILENAME          Write drive/IEC timeline as trace_event JSON\n");
+            #endif
             printf("  -h, --help           Show this help message\n");
             return 0;
         } else {
@@ -191,16 +280,63 @@ int main(int argc, char* argv[]) {
                 .e000_ffff = { .ptr=dump_1541_e000_901229_06aa_bin, .size=sizeof(dump_1541_e000_901229_06aa_bin) }
             }
         },
-        .c1541_enabled = 1
+        .c1541_enabled = 1,
+        .num_drives = num_drives,
+        .drive_sleep = drive_sleep
     });
 
+    if (rec_filename && !c64_rec_open(&input_rec, &c64, rec_filename, 0, C64_FREQUENCY)) {
+        fprintf(stderr, "Error: cannot write input recording %s\n", rec_filename);
+        return 1;
+    }
+
     // Attach disk image if specified
     if (disk_filename != NULL) {
-        if (!c1541_attach_disk(&c64.c1541, disk_filename)) {
+        if (!c64_rec_attach_disk(&input_rec, &c64, disk_filename)) {
             fprintf(stderr, "Warning: Failed to attach disk image: %s\n", disk_filename);
         }
     }
-    drive_current_halftrack = c64.c1541.half_track;
+    for (int i = 1; i < num_drives; i++) {
+        if (!c64_rec_attach_drive_disk(&input_rec, &c64, i, ext_disk_filenames[i - 1])) {
+            fprintf(stderr, "Warning: Failed to attach disk image: %s\n", ext_disk_filenames[i - 1]);
+        }
+    }
+    #ifdef TRACE_ENABLED
+    if (trace_file) {
+        // one frame is ~33k C64 cycles plus the drive
+        trace_init(&instr_trace, &(trace_desc_t){ .num_records = 1<<17 });
+        #ifdef C64_ENABLE_TRACE
+        c64.trace = &instr_trace;
+        #endif
+        #ifdef C1541_ENABLE_TRACE
+        c64.c1541.trace = &instr_trace;
+        #endif
+    }
+    #endif
+    #ifdef C1541_ENABLE_TIMELINE
+    if (timeline_file) {
+        timeline_init(&drive_timeline, &(timeline_desc_t){ .num_events = 1<<16, .frequency = C1541_FREQUENCY });
+        timeline_write_header(&drive_timeline, timeline_file);
+        // one process per drive, see timeline.h
+        for (int i = 0; i < num_drives; i++) {
+            c64_drive(&c64, i)->timeline = &drive_timeline;
+        }
+    }
+    #endif
+    #ifdef PROFILE_ENABLED
+    if (prof_prefix) {
+        #ifdef C64_ENABLE_PROFILE
+        rom_prof_init(&c64_prof);
+        c64_prof_add_routines(&c64_prof);
+        c64.prof = &c64_prof;
+        #endif
+        #ifdef C1541_ENABLE_PROFILE
+        rom_prof_init(&c1541_prof);
+        c1541_prof_add_routines(&c1541_prof);
+        c64.c1541.prof = &c1541_prof;
+        #endif
+    }
+    #endif
 
     // install a Ctrl-C signal handler
     signal(SIGINT, catch_sigint);
@@ -222,7 +358,17 @@ int main(int argc, char* argv[]) {
     // run the emulation/input/render loop
     while (!quit_requested) {
         // tick the emulator for 1 frame
-        c64_ticks += c64_exec(&c64, FRAME_USEC);
+        c64_ticks += c64_rec_exec(&input_rec, &c64, FRAME_USEC);
+        #ifdef TRACE_ENABLED
+        if (trace_file) {
+            trace_drain(&instr_trace, trace_file);
+        }
+        #endif
+        #ifdef C1541_ENABLE_TIMELINE
+        if (timeline_file) {
+            timeline_drain(&drive_timeline, timeline_file);
+        }
+        #endif
 
         #ifdef PRGDEBUG
         if(c64_ticks > 150000 && keysim_state == 0) {
@@ -253,8 +399,8 @@ int main(int argc, char* argv[]) {
                 }
             }
             if (ch < 256) {
-                c64_key_down(&c64, ch);
-                c64_key_up(&c64, ch);
+                c64_rec_key_down(&input_rec, &c64, ch);
+                c64_rec_key_up(&input_rec, &c64, ch);
             }
         }
         if (enable_curses) {
@@ -270,6 +416,33 @@ int main(int argc, char* argv[]) {
     if (enable_curses) {
         endwin();
     }
+    c64_rec_close(&input_rec, &c64);
+    #ifdef TRACE_ENABLED
+    if (trace_file) {
+        fclose(trace_file);
+        trace_discard(&instr_trace);
+    }
+    #endif
+    #ifdef C1541_ENABLE_TIMELINE
+    if (timeline_file) {
+        timeline_drain(&drive_timeline, timeline_file);
+        timeline_write_footer(&drive_timeline, timeline_file);
+        fclose(timeline_file);
+        timeline_discard(&drive_timeline);
+    }
+    #endif
+    #ifdef PROFILE_ENABLED
+    if (prof_prefix) {
+        #ifdef C64_ENABLE_PROFILE
+        write_profile(&c64_prof, "c64");
+        rom_prof_discard(&c64_prof);
+        #endif
+        #ifdef C1541_ENABLE_PROFILE
+        write_profile(&c1541_prof, "c1541");
+        rom_prof_discard(&c1541_prof);
+        #endif
+    }
+    #endif
     printf("Stopped at tick %d\n", c64_ticks);
     return 0;
 }
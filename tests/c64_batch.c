@@ -0,0 +1,417 @@
+/*
+    c64_batch.c
+
+    Runs many independent C64+C1541 machines on a pool of worker threads,
+    e.g. for regression runs on a many-core box. The job file has one job
+    per line (# starts a comment):
+
+    IMAGE SCRIPT
+
+    IMAGE is a .d64/.g64 file attached before the start, or - for none.
+    SCRIPT is either an input recording (.rec, see systems/c64_rec.h, its
+    checkpoints must match, the machine gets the drives of the recording)
+    or a text file with one command per line:
+
+    ready [SECONDS]     run until READY. is printed (default: 60 s)
+    type TEXT           type TEXT (escapes: \r \n \\ \xNN), waits for
+                        the keyboard buffer between chunks of 10 chars
+    run SECONDS         run for SECONDS emulated seconds
+
+    The jobs are dealt round-robin to per-worker deques, a worker runs its
+    own jobs newest first and steals the oldest job of another worker when
+    it runs out. Each worker owns one c64_t, which is re-initialized per job.
+    One JSON object per job is printed in job order, with the final state
+    hash (c64_rec_hash()), the emulated cycles and the host time.
+
+    Build with the same flags as the emulator (e.g. -DUSE_CONNOMORE_M6502,
+    -DUSE_FAST_M6522), see the batch target in the Makefile.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#ifdef USE_CONNOMORE_M6502
+#define likely(x) __builtin_expect(!!(x), 1)
+#include "../chips/m6502_connomore64.h"
+#else
+#include "../chips/m6502.h"
+#endif
+#include "../chips/m6526.h"
+#include "../chips/m6569.h"
+#include "../chips/m6581.h"
+#include "../chips/kbd.h"
+#include "../chips/mem.h"
+#include "../chips/clk.h"
+#include "../systems/c1530.h"
+#ifdef USE_FAST_M6522
+#include "../chips/m6522_fast.h"
+#else
+#include "../chips/m6522.h"
+#endif
+#include "../systems/c1541.h"
+#include "../systems/c64.h"
+#include "../systems/c64_rec.h"
+#include "c64-roms.h"
+#include "c1541-roms.h"
+
+// emulated time per c64_exec() call
+#define SLICE_USEC (1000)
+#define MAX_WORKERS (256)
+#define MAX_LINE (1024)
+
+typedef struct {
+    char* image;            // NULL for none
+    char* script;
+    // result
+    bool ok;
+    const char* error;
+    uint64_t cycles;
+    uint32_t hash;
+    uint64_t ns;
+    int worker;
+    bool stolen;
+} job_t;
+
+// jobs of one worker, the owner pops at the tail, thieves take from the head
+typedef struct {
+    pthread_mutex_t lock;
+    int* jobs;
+    int head;
+    int tail;
+} job_deque_t;
+
+typedef struct {
+    int index;
+    pthread_t thread;
+    c64_t* c64;
+} worker_t;
+
+static job_t* jobs;
+static int num_jobs;
+static job_deque_t deques[MAX_WORKERS];
+static worker_t workers[MAX_WORKERS];
+static int num_workers;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool pop_job(job_deque_t* dq, int* job) {
+    pthread_mutex_lock(&dq->lock);
+    const bool res = dq->tail > dq->head;
+    if (res) {
+        *job = dq->jobs[--dq->tail];
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return res;
+}
+
+static bool steal_job(job_deque_t* dq, int* job) {
+    pthread_mutex_lock(&dq->lock);
+    const bool res = dq->tail > dq->head;
+    if (res) {
+        *job = dq->jobs[dq->head++];
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return res;
+}
+
+// decode the escapes of a type command in place, returns the length
+static size_t unescape(char* str) {
+    char* dst = str;
+    for (const char* src = str; *src; src++) {
+        if ((src[0] == '\\') && src[1]) {
+            src++;
+            switch (*src) {
+                case 'r': *dst++ = '\r'; break;
+                case 'n': *dst++ = '\n'; break;
+                case 'x': {
+                    char hex[3] = { src[1], src[1] ? src[2] : 0, 0 };
+                    *dst++ = (char)strtoul(hex, NULL, 16);
+                    src += strlen(hex);
+                    break;
+                }
+                default: *dst++ = *src; break;
+            }
+        } else {
+            *dst++ = *src;
+        }
+    }
+    *dst = 0;
+    return (size_t)(dst - str);
+}
+
+// run until a stop condition holds or max_cycles passed, without a condition
+// (NULL) for max_cycles
+static bool run_until(c64_t* sys, uint64_t* cycles, uint64_t max_cycles, const c64_cond_t* cond) {
+    c64_until_t until;
+    c64_until_compile(&until, cond, cond ? 1 : 0);
+    const uint64_t end = *cycles + max_cycles;
+    while (*cycles < end) {
+        c64_until_type_t hit;
+        *cycles += c64_exec_until(sys, SLICE_USEC, &until, &hit);
+        if (hit != C64_UNTIL_NONE) {
+            return true;
+        }
+    }
+    return !cond;
+}
+
+static bool run_script(job_t* job, c64_t* sys, FILE* fp) {
+    char line[MAX_LINE];
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\r\n")] = 0;
+        char* cmd = line + strspn(line, " \t");
+        char* arg = cmd + strcspn(cmd, " \t");
+        if (*arg) {
+            *arg++ = 0;
+            arg += strspn(arg, " \t");
+        }
+        if ((*cmd == 0) || (*cmd == '#')) {
+            continue;
+        } else if (0 == strcmp(cmd, "ready")) {
+            const uint32_t seconds = *arg ? (uint32_t)atoi(arg) : 60;
+            const c64_cond_t ready = { .type = C64_UNTIL_SCREEN, .text = "READY." };
+            if (!run_until(sys, &job->cycles, (uint64_t)seconds * C64_FREQUENCY, &ready)) {
+                job->error = "timeout waiting for READY.";
+                return false;
+            }
+        } else if (0 == strcmp(cmd, "type")) {
+            const size_t len = unescape(arg);
+            for (size_t pos = 0; pos < len; pos += 10) {
+                const c64_cond_t keybuf_empty = { .type = C64_UNTIL_MEM, .addr = 198, .value = 0 };
+                if (!run_until(sys, &job->cycles, 10 * C64_FREQUENCY, &keybuf_empty)) {
+                    job->error = "keyboard buffer not read";
+                    return false;
+                }
+                const size_t n = ((len - pos) < 10) ? (len - pos) : 10;
+                memcpy(&sys->ram[631], &arg[pos], n);
+                sys->ram[198] = (uint8_t)n;
+            }
+        } else if (0 == strcmp(cmd, "run")) {
+            run_until(sys, &job->cycles, (uint64_t)(atof(arg) * C64_FREQUENCY), NULL);
+        } else {
+            job->error = "unknown script command";
+            return false;
+        }
+    }
+    return true;
+}
+
+// sys is set up from the header of the opened recording, see run_job()
+static bool run_recording(job_t* job, c64_t* sys, c64_replay_t* rp) {
+    if (rp->header.flags & C64_REC_FLAG_HOST_IEC) {
+        rp->host = iec_connect(&sys->iec_bus, false);
+    }
+    job->error = c64_replay_check(rp, sys);
+    const c64_replay_status_t status = job->error ? C64_REPLAY_ERROR : c64_replay_run(rp, sys);
+    if (rp->host) {
+        // c64_discard() frees the bus only once all devices are gone
+        iec_disconnect(sys->iec_bus, rp->host);
+    }
+    job->cycles = rp->cycle;
+    if (job->error) {
+        return false;
+    } else if (status == C64_REPLAY_MISMATCH) {
+        job->error = "checkpoint mismatch";
+    } else if (status != C64_REPLAY_END) {
+        job->error = "broken recording";
+    }
+    return status == C64_REPLAY_END;
+}
+
+static bool is_recording(const char* filename) {
+    const char* ext = strrchr(filename, '.');
+    return ext && (0 == strcmp(ext, ".rec"));
+}
+
+static void run_job(job_t* job, c64_t* sys) {
+    const uint64_t t0 = now_ns();
+    // a recording brings its own drive setup
+    c64_replay_t rp = { 0 };
+    const bool recording = is_recording(job->script);
+    if (recording && !c64_replay_open(&rp, job->script)) {
+        job->error = "cannot read recording";
+    } else if (recording && (rp.header.num_drives > C64_MAX_DRIVES)) {
+        job->error = "recording needs too many drives";
+    }
+    const bool replay = recording && !job->error;
+    c64_init(sys, &(c64_desc_t){
+        .roms = {
+            .chars = { .ptr=dump_c64_char_bin, .size=sizeof(dump_c64_char_bin) },
+            .basic = { .ptr=dump_c64_basic_bin, .size=sizeof(dump_c64_basic_bin) },
+            .kernal = { .ptr=dump_c64_kernalv3_bin, .size=sizeof(dump_c64_kernalv3_bin) },
+            .c1541 = {
+                .c000_dfff = { .ptr=dump_1541_c000_325302_01_bin, .size=sizeof(dump_1541_c000_325302_01_bin) },
+                .e000_ffff = { .ptr=dump_1541_e000_901229_06aa_bin, .size=sizeof(dump_1541_e000_901229_06aa_bin) }
+            }
+        },
+        .c1541_enabled = replay ? (rp.header.num_drives > 0) : true,
+        .num_drives = replay ? (int)rp.header.num_drives : 1,
+        .drive_sleep = replay && (rp.header.flags & C64_REC_FLAG_DRIVE_SLEEP),
+        .shared_roms = true,    // all machines read the same ROM images
+    });
+    if (job->error) {
+        job->ok = false;
+    } else if (job->image && (!sys->c1541.valid || !c1541_attach_disk(&sys->c1541, job->image))) {
+        job->error = "cannot attach image";
+    } else if (replay) {
+        job->ok = run_recording(job, sys, &rp);
+    } else {
+        FILE* fp = fopen(job->script, "r");
+        if (fp) {
+            job->ok = run_script(job, sys, fp);
+            fclose(fp);
+        } else {
+            job->error = "cannot read script";
+        }
+    }
+    if (rp.fp) {
+        c64_replay_close(&rp);
+    }
+    job->hash = c64_rec_hash(sys);
+    c64_discard(sys);
+    job->ns = now_ns() - t0;
+}
+
+static void* worker_func(void* arg) {
+    worker_t* w = (worker_t*) arg;
+    int job;
+    for (;;) {
+        bool stolen = false;
+        if (!pop_job(&deques[w->index], &job)) {
+            // no jobs are added after the start, so all deques empty means done
+            for (int i = 1; i < num_workers; i++) {
+                if (steal_job(&deques[(w->index + i) % num_workers], &job)) {
+                    stolen = true;
+                    break;
+                }
+            }
+            if (!stolen) {
+                return 0;
+            }
+        }
+        jobs[job].worker = w->index;
+        jobs[job].stolen = stolen;
+        run_job(&jobs[job], w->c64);
+    }
+}
+
+static bool read_jobs(const char* filename, int copies) {
+    FILE* fp = fopen(filename, "r");
+    if (!fp) {
+        return false;
+    }
+    char line[MAX_LINE];
+    int max_jobs = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        char image[MAX_LINE], script[MAX_LINE];
+        if ((line[0] == '#') || (2 != sscanf(line, "%1023s %1023s", image, script))) {
+            continue;
+        }
+        for (int i = 0; i < copies; i++) {
+            if (num_jobs == max_jobs) {
+                max_jobs = max_jobs ? 2 * max_jobs : 64;
+                jobs = realloc(jobs, max_jobs * sizeof(job_t));
+                CHIPS_ASSERT(jobs);
+            }
+            jobs[num_jobs++] = (job_t){
+                .image = strcmp(image, "-") ? strdup(image) : NULL,
+                .script = strdup(script),
+            };
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* job_filename = NULL;
+    const char* out_filename = NULL;
+    int copies = 1;
+    num_workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc)) {
+            num_workers = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) {
+            copies = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) {
+            out_filename = argv[++i];
+        } else if ((argv[i][0] != '-') && !job_filename) {
+            job_filename = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s [-j THREADS] [-n COPIES] [-o FILENAME.json] JOBFILE\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!job_filename || !read_jobs(job_filename, (copies > 0) ? copies : 1)) {
+        fprintf(stderr, "Error: cannot read job file\n");
+        return 2;
+    }
+    if (num_workers < 1) {
+        num_workers = 1;
+    } else if (num_workers > MAX_WORKERS) {
+        num_workers = MAX_WORKERS;
+    }
+    FILE* out = stdout;
+    if (out_filename) {
+        out = fopen(out_filename, "w");
+        if (!out) {
+            fprintf(stderr, "Error: cannot write %s\n", out_filename);
+            return 2;
+        }
+    }
+
+    for (int i = 0; i < num_workers; i++) {
+        pthread_mutex_init(&deques[i].lock, NULL);
+        deques[i].jobs = malloc((num_jobs / num_workers + 1) * sizeof(int));
+        CHIPS_ASSERT(deques[i].jobs);
+    }
+    // round-robin, pushed in reverse so that each owner starts with its first job
+    for (int job = num_jobs - 1; job >= 0; job--) {
+        job_deque_t* dq = &deques[job % num_workers];
+        dq->jobs[dq->tail++] = job;
+    }
+    const uint64_t t0 = now_ns();
+    for (int i = 0; i < num_workers; i++) {
+        workers[i].index = i;
+        workers[i].c64 = (c64_t*) aligned_alloc(_Alignof(c64_t), sizeof(c64_t));
+        CHIPS_ASSERT(workers[i].c64);
+        pthread_create(&workers[i].thread, NULL, worker_func, &workers[i]);
+    }
+    for (int i = 0; i < num_workers; i++) {
+        pthread_join(workers[i].thread, NULL);
+        free(workers[i].c64);
+    }
+    const uint64_t ns = now_ns() - t0;
+
+    int num_ok = 0;
+    uint64_t total_cycles = 0;
+    for (int i = 0; i < num_jobs; i++) {
+        const job_t* job = &jobs[i];
+        fprintf(out, "{\"job\":%d,\"image\":\"%s\",\"script\":\"%s\",\"ok\":%s,", i,
+            job->image ? job->image : "-", job->script, job->ok ? "true" : "false");
+        if (job->error) {
+            fprintf(out, "\"error\":\"%s\",", job->error);
+        }
+        fprintf(out, "\"cycles\":%llu,\"hash\":\"%08X\",\"ms\":%.1f,\"worker\":%d,\"stolen\":%s}\n",
+            (unsigned long long)job->cycles, job->hash, job->ns * 1e-6, job->worker, job->stolen ? "true" : "false");
+        num_ok += job->ok;
+        total_cycles += job->cycles;
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    fprintf(stderr, "%d/%d jobs ok, %d workers, %.1f emulated s in %.2f s (%.1f MHz aggregate)\n",
+        num_ok, num_jobs, num_workers, (double)total_cycles / C64_FREQUENCY, ns * 1e-9,
+        (double)total_cycles * 1e3 / (double)ns);
+    return (num_ok == num_jobs) ? 0 : 1;
+}
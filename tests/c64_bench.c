@@ -0,0 +1,380 @@
+/*
+    c64_bench.c
+
+    Headless C64+C1541 benchmark. Runs a few fixed scenarios from a cold
+    start and prints one JSON object per scenario and line:
+
+    boot    cold boot to READY.
+    dir     LOAD"$",8 from docs/1541_test_demo.d64
+    load    LOAD"*",8,1 from docs/1541_test_demo.g64
+    idle    boot with a disk inserted, then 10 emulated seconds of idling
+
+    The time spent in the drive is measured separately: during a first,
+    untimed run the C64 side IEC signals are recorded per drive cycle, the
+    drive is then run again on its own with the recorded signals. The C64
+    time is the remainder of the full system run. Each run is repeated, the
+    median is reported. The drive activity counters of the replay
+    (c1541_stats()) are added as "drive_stats".
+
+    Build with the same flags as the emulator (e.g. -DUSE_CONNOMORE_M6502,
+    -DUSE_FAST_M6522), see the bench target in the Makefile. With
+    -DC1541_ENABLE_PERF, the per-stage drive times of the last replay
+    are added as "drive_stages".
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#ifdef USE_CONNOMORE_M6502
+#define likely(x) __builtin_expect(!!(x), 1)
+#include "../chips/m6502_connomore64.h"
+#else
+#include "../chips/m6502.h"
+#endif
+#include "../chips/m6526.h"
+#include "../chips/m6569.h"
+#include "../chips/m6581.h"
+#include "../chips/kbd.h"
+#include "../chips/mem.h"
+#include "../chips/clk.h"
+#include "../systems/c1530.h"
+#ifdef USE_FAST_M6522
+#include "../chips/m6522_fast.h"
+#else
+#include "../chips/m6522.h"
+#endif
+#include "../systems/c1541.h"
+
+// drive cycle counter and IEC recorder, hooked into the drive ticks of c64.h
+typedef struct {
+    uint64_t cycle;
+    uint8_t signals;
+} iec_event_t;
+
+static struct {
+    uint64_t drive_cycles;
+    iecbus_device_t* host;      // the C64 IEC port while recording, else NULL
+    uint8_t last_signals;
+    iec_event_t* events;
+    size_t num_events;
+    size_t max_events;
+} rec;
+
+static inline void _bench_c1541_tick(c1541_t* sys) {
+    if (rec.host && (rec.host->signals != rec.last_signals)) {
+        if (rec.num_events == rec.max_events) {
+            rec.max_events = rec.max_events ? 2 * rec.max_events : 1024;
+            rec.events = realloc(rec.events, rec.max_events * sizeof(iec_event_t));
+            CHIPS_ASSERT(rec.events);
+        }
+        rec.last_signals = rec.host->signals;
+        rec.events[rec.num_events++] = (iec_event_t){ rec.drive_cycles, rec.last_signals };
+    }
+    rec.drive_cycles++;
+    c1541_tick(sys);
+}
+#define c1541_tick(sys) _bench_c1541_tick(sys)
+
+#include "../systems/c64.h"
+#include "c64-roms.h"
+#include "c1541-roms.h"
+
+#ifdef USE_CONNOMORE_M6502
+#define BENCH_CPU "m6502_connomore64"
+#else
+#define BENCH_CPU "m6502"
+#endif
+#ifdef USE_FAST_M6522
+#define BENCH_VIA "m6522_fast"
+#else
+#define BENCH_VIA "m6522"
+#endif
+
+// emulated time per c64_exec() call
+#define SLICE_USEC (1000)
+#define MAX_RUNS (64)
+
+typedef struct {
+    const char* name;
+    const char* disk;           // file name in the disk directory, or NULL
+    const char* command;        // typed once the C64 is READY, or NULL
+    uint32_t idle_seconds;      // emulated seconds to run after READY
+    uint32_t max_seconds;       // give up after this many emulated seconds
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "boot", NULL, NULL, 0, 10 },
+    { "dir", "1541_test_demo.d64", "L\x6f\"$\",8\r", 0, 60 },
+    { "load", "1541_test_demo.g64", "L\x6f\"*\",8,1\r", 0, 120 },
+    { "idle", "1541_test_demo.d64", NULL, 10, 30 },
+};
+#define NUM_SCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+typedef struct {
+    bool ok;
+    uint64_t c64_cycles;
+    uint64_t drive_cycles;
+    uint64_t drive_hash;
+} run_result_t;
+
+static c64_t c64;
+static c1541_t drive;
+static c1541_stats_t drive_stats;
+#ifdef C1541_ENABLE_PERF
+static c1541_perf_t drive_perf;
+#endif
+static const char* disk_dir = "../docs";
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t hash_drive(c1541_t* sys) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < sizeof(sys->ram); i++) {
+        h = (h ^ sys->ram[i]) * 0x100000001b3ULL;
+    }
+    h = (h ^ m6502_pc(&sys->cpu)) * 0x100000001b3ULL;
+    return h;
+}
+
+// row of the first "READY." at or below min_row, or -1
+static int find_ready(int min_row) {
+    static const uint8_t ready[6] = { 18, 5, 1, 4, 25, 46 };
+    for (int row = min_row; row < 25; row++) {
+        for (int col = 0; col <= 40 - 6; col++) {
+            if (0 == memcmp(&c64.ram[0x0400 + row * 40 + col], ready, sizeof(ready))) {
+                return row;
+            }
+        }
+    }
+    return -1;
+}
+
+static void set_keybuf(const char* str) {
+    c64.ram[198] = strlen(str);
+    for (uint i = 0; i < c64.ram[198]; i++) { c64.ram[631+i] = str[i]; }
+}
+
+static bool attach_disk(c1541_t* sys, const scenario_t* sc) {
+    if (!sc->disk) {
+        return true;
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", disk_dir, sc->disk);
+    return c1541_attach_disk(sys, path);
+}
+
+// full C64+C1541 run from a cold start
+static run_result_t run_system(const scenario_t* sc, bool record) {
+    run_result_t res = { 0 };
+    c64_init(&c64, &(c64_desc_t){
+        .roms = {
+            .chars = { .ptr=dump_c64_char_bin, .size=sizeof(dump_c64_char_bin) },
+            .basic = { .ptr=dump_c64_basic_bin, .size=sizeof(dump_c64_basic_bin) },
+            .kernal = { .ptr=dump_c64_kernalv3_bin, .size=sizeof(dump_c64_kernalv3_bin) },
+            .c1541 = {
+                .c000_dfff = { .ptr=dump_1541_c000_325302_01_bin, .size=sizeof(dump_1541_c000_325302_01_bin) },
+                .e000_ffff = { .ptr=dump_1541_e000_901229_06aa_bin, .size=sizeof(dump_1541_e000_901229_06aa_bin) }
+            }
+        },
+        .c1541_enabled = 1,
+    });
+    if (!attach_disk(&c64.c1541, sc)) {
+        c64_discard(&c64);
+        return res;
+    }
+    rec.drive_cycles = 0;
+    rec.num_events = 0;
+    rec.host = record ? c64.iec_device : NULL;
+    rec.last_signals = 0;
+
+    const uint64_t max_cycles = (uint64_t)sc->max_seconds * C64_FREQUENCY;
+    uint64_t idle_until = 0;
+    int ready_row = -1;
+    bool command_entered = false;
+    while (res.c64_cycles < max_cycles) {
+        res.c64_cycles += c64_exec(&c64, SLICE_USEC);
+        if (ready_row < 0) {
+            // waiting for the boot to finish
+            ready_row = find_ready(0);
+            if (ready_row >= 0) {
+                if (sc->command) {
+                    set_keybuf(sc->command);
+                    command_entered = true;
+                } else if (sc->idle_seconds) {
+                    idle_until = res.c64_cycles + (uint64_t)sc->idle_seconds * C64_FREQUENCY;
+                } else {
+                    res.ok = true;
+                    break;
+                }
+            }
+        } else if (command_entered) {
+            // the command is echoed in the line below READY, wait for the next READY
+            if (find_ready(ready_row + 2) >= 0) {
+                res.ok = true;
+                break;
+            }
+        } else if (res.c64_cycles >= idle_until) {
+            res.ok = true;
+            break;
+        }
+    }
+    rec.host = NULL;
+    res.drive_cycles = rec.drive_cycles;
+    res.drive_hash = hash_drive(&c64.c1541);
+    c64_discard(&c64);
+    return res;
+}
+
+// the drive alone, fed with the recorded C64 IEC signals
+static uint64_t run_drive(const scenario_t* sc, uint64_t num_cycles) {
+    c1541_init(&drive, &(c1541_desc_t){
+        .roms = {
+            .c000_dfff = { .ptr=dump_1541_c000_325302_01_bin, .size=sizeof(dump_1541_c000_325302_01_bin) },
+            .e000_ffff = { .ptr=dump_1541_e000_901229_06aa_bin, .size=sizeof(dump_1541_e000_901229_06aa_bin) }
+        },
+        #ifdef C1541_ENABLE_PERF
+        .perf = &drive_perf,
+        #endif
+    });
+    #ifdef C1541_ENABLE_PERF
+    c1541_perf_reset(&drive_perf);
+    #endif
+    iecbus_device_t* host = iec_connect(&drive.iec_bus, false);
+    CHIPS_ASSERT(host);
+    attach_disk(&drive, sc);
+    size_t ev = 0;
+    for (uint64_t cycle = 0; cycle < num_cycles; cycle++) {
+        while ((ev < rec.num_events) && (rec.events[ev].cycle == cycle)) {
+            iec_set_signals(drive.iec_bus, host, rec.events[ev++].signals);
+        }
+        (c1541_tick)(&drive);
+    }
+    uint64_t h = hash_drive(&drive);
+    drive_stats = *c1541_stats(&drive);
+    iec_disconnect(drive.iec_bus, host);
+    c1541_discard(&drive);
+    return h;
+}
+
+static int cmp_u64(const void* a, const void* b) {
+    const uint64_t x = *(const uint64_t*)a;
+    const uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t median(uint64_t* values, int num) {
+    qsort(values, num, sizeof(uint64_t), cmp_u64);
+    return values[num / 2];
+}
+
+static bool bench(FILE* out, const scenario_t* sc, int num_runs) {
+    // untimed run which records the drive input and counts cycles
+    const run_result_t ref = run_system(sc, true);
+    if (!ref.ok) {
+        fprintf(out, "{\"scenario\":\"%s\",\"ok\":false,\"c64_cycles\":%llu}\n",
+            sc->name, (unsigned long long)ref.c64_cycles);
+        fflush(out);
+        return false;
+    }
+    uint64_t system_ns[MAX_RUNS];
+    uint64_t drive_ns[MAX_RUNS];
+    bool replay_ok = true;
+    for (int i = 0; i < num_runs; i++) {
+        uint64_t t0 = now_ns();
+        run_system(sc, false);
+        uint64_t t1 = now_ns();
+        replay_ok &= (run_drive(sc, ref.drive_cycles) == ref.drive_hash);
+        uint64_t t2 = now_ns();
+        system_ns[i] = t1 - t0;
+        drive_ns[i] = t2 - t1;
+    }
+    const uint64_t sys_ns = median(system_ns, num_runs);
+    const uint64_t drv_ns = median(drive_ns, num_runs);
+    const uint64_t c64_ns = (sys_ns > drv_ns) ? (sys_ns - drv_ns) : 0;
+    const double emu_mhz = (double)ref.c64_cycles * 1000.0 / (double)sys_ns;
+    fprintf(out, "{\"scenario\":\"%s\",\"ok\":true,\"cpu\":\"" BENCH_CPU "\",\"via\":\"" BENCH_VIA "\","
+        "\"runs\":%d,\"c64_cycles\":%llu,\"drive_cycles\":%llu,\"system_ns\":%llu,\"drive_ns\":%llu,"
+        "\"c64_ns_per_cycle\":%.3f,\"drive_ns_per_cycle\":%.3f,\"emulated_mhz\":%.3f,\"realtime\":%.2f,"
+        "\"drive_replay_ok\":%s",
+        sc->name, num_runs,
+        (unsigned long long)ref.c64_cycles, (unsigned long long)ref.drive_cycles,
+        (unsigned long long)sys_ns, (unsigned long long)drv_ns,
+        (double)c64_ns / (double)ref.c64_cycles,
+        (double)drv_ns / (double)ref.drive_cycles,
+        emu_mhz, emu_mhz * 1000000.0 / C64_FREQUENCY,
+        replay_ok ? "true" : "false");
+    fprintf(out, ",\"drive_stats\":{\"half_track_steps\":%llu,\"track_fetches\":%llu,\"track_fetch_max_ns\":%llu,"
+        "\"syncs\":%llu,\"gcr_bytes\":%llu,\"byte_ready\":%llu,\"motor_on_cycles\":%llu,\"iec_bytes\":%llu,\"atn_sequences\":%llu}",
+        (unsigned long long)drive_stats.half_track_steps, (unsigned long long)drive_stats.track_fetches,
+        (unsigned long long)drive_stats.track_fetch_max_ns, (unsigned long long)drive_stats.syncs,
+        (unsigned long long)drive_stats.gcr_bytes, (unsigned long long)drive_stats.byte_ready,
+        (unsigned long long)drive_stats.motor_on_cycles, (unsigned long long)drive_stats.iec_bytes,
+        (unsigned long long)drive_stats.atn_sequences);
+    #ifdef C1541_ENABLE_PERF
+    {
+        static const char* names[C1541_PERF_NUM_STAGES] = { "tick", "cpu", "via1", "via2", "track_fetch" };
+        const double ns_per_tick = 1e9 / (double)drive_perf.frequency;
+        fprintf(out, ",\"drive_stages\":{");
+        for (int i = 0; i < C1541_PERF_NUM_STAGES; i++) {
+            const c1541_perf_counter_t* c = &drive_perf.stage[i];
+            fprintf(out, "%s\"%s\":{\"count\":%llu,\"total_ns\":%.0f,\"avg_ns\":%.3f}", i ? "," : "", names[i],
+                (unsigned long long)c->count, (double)c->total * ns_per_tick,
+                c->count ? ((double)c->total * ns_per_tick / (double)c->count) : 0.0);
+        }
+        fprintf(out, "}");
+    }
+    #endif
+    fprintf(out, "}\n");
+    fflush(out);
+    return replay_ok;
+}
+
+int main(int argc, char* argv[]) {
+    const char* only = NULL;
+    const char* out_filename = NULL;
+    int num_runs = 3;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) {
+            only = argv[++i];
+        } else if ((strcmp(argv[i], "-r") == 0) && (i + 1 < argc)) {
+            num_runs = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc)) {
+            disk_dir = argv[++i];
+        } else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) {
+            out_filename = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [-s boot|dir|load|idle] [-r RUNS] [-i DISK_DIR] [-o FILENAME.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((num_runs < 1) || (num_runs > MAX_RUNS)) {
+        fprintf(stderr, "RUNS must be 1..%d\n", MAX_RUNS);
+        return 1;
+    }
+    // the emulator logs to stdout, so results can go to a file
+    FILE* out = stdout;
+    if (out_filename && !(out = fopen(out_filename, "w"))) {
+        fprintf(stderr, "Failed to open %s\n", out_filename);
+        return 1;
+    }
+    bool all_ok = true;
+    for (size_t i = 0; i < NUM_SCENARIOS; i++) {
+        if (only && strcmp(only, scenarios[i].name)) {
+            continue;
+        }
+        all_ok &= bench(out, &scenarios[i], num_runs);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(rec.events);
+    return all_ok ? 0 : 1;
+}
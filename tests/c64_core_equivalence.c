@@ -0,0 +1,233 @@
+/*
+    c64_core_equivalence.c
+
+    Headless C64+C1541 run (boot, then LOAD"*",8,1) which prints a running
+    checksum over the CPU bus and register state of every C64 tick.
+
+    Build once against m6502.h and once with -DUSE_CONNOMORE_M6502 against
+    m6502_connomore64.h, both outputs must be identical. Same with
+    -DUSE_FAST_M6522 to check m6522_fast.h (and lazy VIA1 ticking)
+    against m6522.h, and with -DUSE_ROTOR_CORE (disk rotor on a second
+    thread, as on core 1 of the RP2040) against the single-threaded drive.
+    With -p the C64 runs on the plain c64_exec() path without the debug
+    callback, and the checksum is taken after each c64_exec() call only,
+    the last line must be the same as with the callback. With -i FILENAME
+    it logs the C64 IEC outputs seen by each drive tick for
+    c1541_core_equivalence.c. See run_core_equivalence.sh.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef USE_ROTOR_CORE
+#include <pthread.h>
+#include <sched.h>
+#define C1541_ENABLE_ROTOR_CORE
+#define C1541_ROTOR_WAIT_HOOK(s) sched_yield()
+#endif
+static void iec_log_tick(void);
+#define C1541_TICK_HOOK(s) iec_log_tick()
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#ifdef USE_CONNOMORE_M6502
+#define likely(x) __builtin_expect(!!(x), 1)
+#include "../chips/m6502_connomore64.h"
+#else
+#include "../chips/m6502.h"
+#endif
+#include "../chips/m6526.h"
+#include "../chips/m6569.h"
+#include "../chips/m6581.h"
+#include "../chips/kbd.h"
+#include "../chips/mem.h"
+#include "../chips/clk.h"
+#include "../systems/c1530.h"
+#ifdef USE_FAST_M6522
+#include "../chips/m6522_fast.h"
+#else
+#include "../chips/m6522.h"
+#endif
+#include "../systems/c1541.h"
+#include "../systems/c64.h"
+#include "c64-roms.h"
+#include "c1541-roms.h"
+
+// print a checksum line every N ticks
+#define REPORT_TICKS (20000)
+// enter LOAD command once the C64 is booted
+#define LOAD_TICKS (150000)
+
+static c64_t c64;
+static bool stopped = false;
+static uint64_t hash = 0xcbf29ce484222325ULL;
+static uint64_t num_ticks = 0;
+// C64 IEC output log: drive tick << 8 | signals on each change (host byte order)
+static FILE* iec_log;
+static uint64_t num_drive_ticks = 0;
+static int iec_log_signals = -1;
+#ifdef USE_ROTOR_CORE
+static c1541_rotor_link_t rotor_link;
+static atomic_bool rotor_quit;
+
+static void* rotor_thread(void* arg) {
+    (void)arg;
+    while (!atomic_load(&rotor_quit)) {
+        if (!c1541_rotor_poll(&rotor_link)) {
+            sched_yield();
+        }
+    }
+    return 0;
+}
+#endif
+
+static void iec_log_write(void) {
+    const uint64_t rec = (num_drive_ticks << 8) | (uint8_t)iec_log_signals;
+    fwrite(&rec, sizeof(rec), 1, iec_log);
+}
+
+// called at the start of each drive tick
+static void iec_log_tick(void) {
+    if (iec_log && (c64.iec_device->signals != iec_log_signals)) {
+        iec_log_signals = c64.iec_device->signals;
+        iec_log_write();
+    }
+    num_drive_ticks++;
+}
+
+static inline void hash_byte(uint8_t b) {
+    hash = (hash ^ b) * 0x100000001b3ULL;
+}
+
+static void hash_cpu(m6502_t* cpu, uint16_t addr, uint8_t data, bool rw, bool sync) {
+    hash_byte(addr & 0xFF);
+    hash_byte(addr >> 8);
+    hash_byte(data);
+    hash_byte((rw ? 1 : 0) | (sync ? 2 : 0));
+    hash_byte(m6502_a(cpu));
+    hash_byte(m6502_x(cpu));
+    hash_byte(m6502_y(cpu));
+    hash_byte(m6502_s(cpu));
+    hash_byte(m6502_p(cpu));
+    hash_byte(m6502_pc(cpu) & 0xFF);
+    hash_byte(m6502_pc(cpu) >> 8);
+}
+
+static void report(c64_t* sys) {
+    printf("%10llu c64 %016llx pc %04x 1541 pc %04x\n",
+        (unsigned long long)num_ticks, (unsigned long long)hash,
+        m6502_pc(&sys->cpu), m6502_pc(&sys->c1541.cpu));
+}
+
+// called after each C64 tick
+static void debug_tick(void* user_data, uint64_t pins) {
+    c64_t* sys = (c64_t*) user_data;
+    hash_cpu(&sys->cpu, C64_GET_ADDR(pins, sys), C64_GET_DATA(pins, sys), pins & M6502_RW, pins & M6502_SYNC);
+    // the drive is caught up lazily, its PC shows how far it went
+    hash_byte(m6502_pc(&sys->c1541.cpu) & 0xFF);
+    hash_byte(m6502_pc(&sys->c1541.cpu) >> 8);
+    num_ticks++;
+    if ((num_ticks % REPORT_TICKS) == 0) {
+        report(sys);
+    }
+}
+
+// plain path: called after each c64_exec() call
+static void exec_done(c64_t* sys, uint32_t ticks) {
+    hash_cpu(&sys->cpu, 0, 0, false, false);
+    hash_byte(m6502_pc(&sys->c1541.cpu) & 0xFF);
+    hash_byte(m6502_pc(&sys->c1541.cpu) >> 8);
+    const uint64_t prev_ticks = num_ticks;
+    num_ticks += ticks;
+    if ((prev_ticks / REPORT_TICKS) != (num_ticks / REPORT_TICKS)) {
+        report(sys);
+    }
+}
+
+static void set_keybuf(const char* str) {
+    c64.ram[198] = strlen(str);
+    for (uint i = 0; i < c64.ram[198]; i++) { c64.ram[631+i] = str[i]; }
+}
+
+static uint64_t hash_mem(const uint8_t* ptr, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        h = (h ^ ptr[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+int main(int argc, char* argv[]) {
+    const char* disk_filename = NULL;
+    uint64_t max_ticks = 10000000;
+    bool plain = false;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc)) {
+            disk_filename = argv[++i];
+        } else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) {
+            max_ticks = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-p") == 0) {
+            plain = true;
+        } else if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc)) {
+            iec_log = fopen(argv[++i], "wb");
+            if (!iec_log) {
+                fprintf(stderr, "Cannot write IEC log: %s\n", argv[i]);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [-d FILENAME.g64] [-t TICKS] [-p] [-i IECLOG]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    c64_init(&c64, &(c64_desc_t){
+        .roms = {
+            .chars = { .ptr=dump_c64_char_bin, .size=sizeof(dump_c64_char_bin) },
+            .basic = { .ptr=dump_c64_basic_bin, .size=sizeof(dump_c64_basic_bin) },
+            .kernal = { .ptr=dump_c64_kernalv3_bin, .size=sizeof(dump_c64_kernalv3_bin) },
+            .c1541 = {
+                .c000_dfff = { .ptr=dump_1541_c000_325302_01_bin, .size=sizeof(dump_1541_c000_325302_01_bin) },
+                .e000_ffff = { .ptr=dump_1541_e000_901229_06aa_bin, .size=sizeof(dump_1541_e000_901229_06aa_bin) }
+            }
+        },
+        .c1541_enabled = 1,
+        .debug = {
+            .callback = { .func = plain ? 0 : debug_tick, .user_data = &c64 },
+            .stopped = plain ? 0 : &stopped,
+        },
+    });
+    if (disk_filename && !c1541_attach_disk(&c64.c1541, disk_filename)) {
+        fprintf(stderr, "Failed to attach disk image: %s\n", disk_filename);
+        return 1;
+    }
+    #ifdef USE_ROTOR_CORE
+    c1541_rotor_attach(&c64.c1541, &rotor_link);
+    pthread_t rotor;
+    pthread_create(&rotor, NULL, rotor_thread, NULL);
+    #endif
+
+    bool load_entered = false;
+    while (num_ticks < max_ticks) {
+        const uint32_t ticks = c64_exec(&c64, 1000);
+        if (plain) {
+            exec_done(&c64, ticks);
+        }
+        if (!load_entered && (num_ticks > LOAD_TICKS)) {
+            load_entered = true;
+            set_keybuf("L\x6f\"*\",8,1\r");
+        }
+    }
+    #ifdef USE_ROTOR_CORE
+    atomic_store(&rotor_quit, true);
+    pthread_join(rotor, NULL);
+    #endif
+    if (iec_log) {
+        // the last record gives the number of drive ticks
+        iec_log_write();
+        fclose(iec_log);
+    }
+    printf("ram c64 %016llx 1541 %016llx\n",
+        (unsigned long long)hash_mem(c64.ram, sizeof(c64.ram)),
+        (unsigned long long)hash_mem(c64.c1541.ram, sizeof(c64.c1541.ram)));
+    return 0;
+}
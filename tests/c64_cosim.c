@@ -0,0 +1,227 @@
+/*
+    c64_cosim.c
+
+    Checks the batched co-simulation of c64_emulation_wrapper.c
+    (c64_cosim_run()/c64_cosim_commit()) against the per-tick calls of
+    rp2_test_runner.js, and measures both without the FFI.
+
+    The drive side is a listener model in place of the RP2040: it pulls
+    DATA a few ticks after it sees CLK asserted, releases it a few ticks
+    after CLK is released and then waits until it sees DATA released on the
+    bus. The C64 runs a loop that toggles CLK and stores the sampled port A
+    in RAM. Both modes must give the same drive input on every tick and the
+    same C64 state. Prints the run times and OK, or the first failure.
+
+    Usage: c64_cosim [-t TICKS] [-w WINDOW]
+*/
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "c64_emulation_wrapper.c"
+
+#define DRIVE_PULL_DELAY (7)
+#define DRIVE_RELEASE_DELAY (13)
+#define MAX_EDGES (256)
+
+typedef enum { WAIT_CLK_ASSERTED, WAIT_CLK_RELEASED, WAIT_DATA_RELEASED } drive_state_t;
+
+typedef struct {
+    drive_state_t state;
+    int delay;
+    uint8_t out;            // IECLINE_* outputs, 0 = asserted
+    uint8_t in;             // bus lines as seen on the inputs
+    uint64_t in_hash;       // of the inputs on every tick
+} drive_t;
+
+typedef struct {
+    uint64_t in_hash;
+    uint32_t ram_hash;
+    uint64_t windows;
+    uint64_t early_ends;
+    double seconds;
+} result_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// one drive tick on the current inputs, returns the outputs
+static uint8_t drive_tick(drive_t* d) {
+    d->in_hash = (d->in_hash ^ d->in) * 0x100000001B3ULL;
+    switch (d->state) {
+        case WAIT_CLK_ASSERTED:
+            if (!(d->in & IECLINE_CLK) && (--d->delay <= 0)) {
+                d->out &= ~IECLINE_DATA;
+                d->state = WAIT_CLK_RELEASED;
+                d->delay = DRIVE_RELEASE_DELAY;
+            }
+            break;
+        case WAIT_CLK_RELEASED:
+            if ((d->in & IECLINE_CLK) && (--d->delay <= 0)) {
+                d->out |= IECLINE_DATA;
+                d->state = WAIT_DATA_RELEASED;
+            }
+            break;
+        case WAIT_DATA_RELEASED:
+            if (d->in & IECLINE_DATA) {
+                d->state = WAIT_CLK_ASSERTED;
+                d->delay = DRIVE_PULL_DELAY;
+            }
+            break;
+    }
+    return d->out;
+}
+
+// toggles CLK and stores the sampled port A at 0x2000.., with varying delays
+static const uint8_t c64_prog[] = {
+    0x78,                   // 1000 SEI
+    0xA9, 0x7F,             // 1001 LDA #$7F
+    0x8D, 0x0D, 0xDC,       // 1003 STA $DC0D
+    0x8D, 0x0D, 0xDD,       // 1006 STA $DD0D
+    0xA9, 0x00,             // 1009 LDA #$00
+    0x8D, 0x1A, 0xD0,       // 100B STA $D01A
+    0xA9, 0x3F,             // 100E LDA #$3F
+    0x8D, 0x02, 0xDD,       // 1010 STA $DD02
+    0xA0, 0x00,             // 1013 LDY #$00
+    0xA9, 0x13,             // 1015 LDA #$13    ; CLK asserted
+    0x8D, 0x00, 0xDD,       // 1017 STA $DD00
+    0x20, 0x40, 0x10,       // 101A JSR $1040
+    0xAD, 0x00, 0xDD,       // 101D LDA $DD00
+    0x99, 0x00, 0x20,       // 1020 STA $2000,Y
+    0xC8,                   // 1023 INY
+    0xA9, 0x03,             // 1024 LDA #$03    ; CLK released
+    0x8D, 0x00, 0xDD,       // 1026 STA $DD00
+    0x20, 0x40, 0x10,       // 1029 JSR $1040
+    0xAD, 0x00, 0xDD,       // 102C LDA $DD00
+    0x99, 0x00, 0x20,       // 102F STA $2000,Y
+    0xC8,                   // 1032 INY
+    0x4C, 0x15, 0x10,       // 1033 JMP $1015
+    0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, 0xEA, // 1036..
+    0xE6, 0xFB,             // 1040 INC $FB
+    0xA6, 0xFB,             // 1042 LDX $FB
+    0xCA,                   // 1044 DEX
+    0xD0, 0xFD,             // 1045 BNE $1044
+    0x60,                   // 1047 RTS
+};
+
+static void start(void) {
+    c64_emulation_init();
+    c64_exec(&c64, 10);
+    memcpy(&c64.ram[0x1000], c64_prog, sizeof(c64_prog));
+    // goto 0x1000, see m6502.h
+    uint64_t pins = M6502_SYNC;
+    M6502_SET_ADDR(pins, 0x1000);
+    M6502_SET_DATA(pins, c64.ram[0x1000]);
+    m6502_set_pc(&c64.cpu, 0x1000);
+    c64.pins = pins;
+}
+
+// like tickC64() in rp2_test_runner.js
+static void run_per_tick(uint64_t num_ticks, drive_t* d, result_t* res) {
+    uint8_t last = 0xFF;
+    for (uint64_t i = 0; i < num_ticks; i++) {
+        const uint8_t out = drive_tick(d);
+        if (out != last) {
+            c64_set_iec_gpio(out);
+            last = out;
+        }
+        c64_emulation_tick();
+        d->in = c64_get_iec_bus();
+    }
+    res->windows = num_ticks;
+}
+
+// like tickC64Batched() in rp2_test_runner.js
+static void run_batched(uint64_t num_ticks, uint32_t window, drive_t* d, result_t* res) {
+    static uint32_t edges[MAX_EDGES];
+    uint8_t last = 0xFF;
+    uint32_t ticks = 0, tick = 0, edge = 0;
+    for (uint64_t i = 0; i < num_ticks; i++) {
+        const uint8_t out = drive_tick(d);
+        if ((out != last) || (tick == ticks)) {
+            res->early_ends += (tick < ticks);
+            c64_cosim_commit(tick, out);
+            last = out;
+            ticks = c64_cosim_run(window, edges, MAX_EDGES);
+            tick = edge = 0;
+            res->windows++;
+        }
+        if ((edges[edge] != C64_COSIM_END) && ((edges[edge] >> 8) == tick)) {
+            d->in = edges[edge++] & 0xFF;
+        }
+        tick++;
+    }
+    c64_cosim_commit(tick, last);
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t num_ticks = 2000000;
+    uint32_t window = 1000;
+    for (int i = 1; i < argc; i++) {
+        if ((0 == strcmp(argv[i], "-t")) && (i + 1 < argc)) {
+            num_ticks = strtoull(argv[++i], 0, 10);
+        } else if ((0 == strcmp(argv[i], "-w")) && (i + 1 < argc)) {
+            window = (uint32_t)atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [-t TICKS] [-w WINDOW]\n", argv[0]);
+            return 2;
+        }
+    }
+    // the wrapper has one global C64, run each mode in its own process
+    result_t results[2];
+    for (int mode = 0; mode < 2; mode++) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return 2;
+        }
+        fflush(stdout);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            result_t res = { 0 };
+            drive_t d = { .out = 0xFF, .in = 0xFF, .delay = DRIVE_PULL_DELAY };
+            start();
+            const uint64_t t0 = now_ns();
+            if (mode == 0) {
+                run_per_tick(num_ticks, &d, &res);
+            } else {
+                run_batched(num_ticks, window, &d, &res);
+            }
+            res.seconds = (now_ns() - t0) * 1e-9;
+            res.in_hash = d.in_hash;
+            res.ram_hash = chips_hash(CHIPS_HASH_INIT, c64.ram, sizeof(c64.ram));
+            write(fds[1], &res, sizeof(res));
+            _exit(0);
+        }
+        close(fds[1]);
+        const bool ok = (pid > 0) && (sizeof(results[mode]) == read(fds[0], &results[mode], sizeof(results[mode])));
+        close(fds[0]);
+        waitpid(pid, 0, 0);
+        if (!ok) {
+            printf("FAIL: mode %d didn't finish\n", mode);
+            return 2;
+        }
+    }
+    const result_t* a = &results[0];
+    const result_t* b = &results[1];
+    printf("per tick: %.3f s, %.0f ns per tick, 3 calls per tick\n", a->seconds, a->seconds * 1e9 / num_ticks);
+    printf("batched:  %.3f s, %.0f ns per tick, %llu windows (%llu ended early), %zu KB copied per window\n",
+        b->seconds, b->seconds * 1e9 / num_ticks, (unsigned long long)b->windows, (unsigned long long)b->early_ends,
+        (offsetof(c64_t, fb) + offsetof(c1530_t, buf) + sizeof(c64_t) - offsetof(c64_t, c1541)) / 1024);
+    const double saved_calls = 3.0 * num_ticks - 2.0 * b->windows;
+    if (saved_calls > 0) {
+        printf("batching pays off above %.0f ns per FFI call\n", (b->seconds - a->seconds) * 1e9 / saved_calls);
+    }
+    if (a->in_hash != b->in_hash) {
+        printf("FAIL: the drive saw different bus lines\n");
+        return 1;
+    }
+    if (a->ram_hash != b->ram_hash) {
+        printf("FAIL: the C64 state differs\n");
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -8,6 +8,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
+#include <stddef.h>
 
 #define CHIPS_IMPL
 #include "../chips/chips_common.h"
@@ -23,6 +25,7 @@
 #include "../systems/c1541.h"
 #include "../systems/c64.h"
 #include "../systems/iecbus.h"
+#include "../systems/c64_rec.h"
 #include "c64-roms.h"
 #include "c1541-roms.h"
 
@@ -31,6 +34,8 @@ static c64_t c64;
 static bool initialized = false;
 static iecbus_device_t* host_iec = NULL;  // C64's IEC device
 static uint64_t c64_tick_count = 0;        // Counter for C64 ticks
+static c64_rec_t input_rec;                 // input recording, see c64_record_start()
+static c64_rec_t no_rec;                    // runs that are not recorded (c64_cosim_run())
 
 // Initialize C64 WITHOUT C1541 emulation
 void c64_emulation_init() {
@@ -50,8 +55,27 @@ void c64_emulation_init() {
 }
 
 void set_keybuf(char* str) {
-    c64.ram[198] = strlen(str);
-    for(uint i=0; i<c64.ram[198]; i++) { c64.ram[631+i]=str[i]; };
+    c64_rec_keybuf(&input_rec, &c64, str);
+}
+
+// Record all inputs (ticks, keys, IEC GPIO) from now on, replay with tests/c64_replay
+// Call right after c64_emulation_init(), returns false if the file cannot be written
+bool c64_record_start(const char* filename) {
+    if (!initialized) return false;
+    return c64_rec_open(&input_rec, &c64, filename, C64_REC_FLAG_HOST_IEC, C64_FREQUENCY);
+}
+
+void c64_record_stop() {
+    if (!initialized) return;
+    c64_rec_close(&input_rec, &c64);
+}
+
+static void _c64_emulation_step(c64_rec_t* rec) {
+    c64_tick_count += c64_rec_exec(rec, &c64, 2);  // Execute for 1 tick (2µS, rounded down)
+
+    if(c64_tick_count == 150000) {
+      c64_rec_keybuf(rec, &c64, "L\x6f\"$\",8\r");
+    }
 }
 
 // Tick C64 emulation (called on STROBE rising edge from RP2040)
@@ -61,10 +85,78 @@ void c64_emulation_tick() {
 
     // Tick the C64 for a small amount of time
     // This gets called frequently by the RP2040's STROBE pin
-    c64_tick_count += c64_exec(&c64, 2);  // Execute for 1 tick (2µS, rounded down)
+    _c64_emulation_step(&input_rec);
+}
 
-    if(c64_tick_count == 150000) {
-      set_keybuf("L\x6f\"$\",8\r");
+// Batched co-simulation, one call per window instead of per drive tick (see
+// rp2_test_runner.js, C64_COSIM_US). Like c64_emulation_tick(), the C64 does one
+// tick per drive tick. c64_cosim_run() runs the C64 ahead for up to `ticks` ticks
+// with the drive lines unchanged and returns the bus edges of the window, each
+// (tick << 8) | bus lines, ended by C64_COSIM_END. An edge is a change against
+// the bus lines last sent to the drive, so changes caused by the drive's own new
+// output are sent back too. The drive side applies each edge after its tick and
+// ends the window with c64_cosim_commit() at its first own output edge, or at the
+// end. If that is earlier, the C64 is rewound to that tick, so both sides see the
+// same bus as with one call per tick.
+#define C64_COSIM_END (0xFFFFFFFF)
+static c64_t cosim_c64;                     // C64 and bus at the window start
+static iecbus_t cosim_bus;
+static uint64_t cosim_tick_count;
+static uint32_t cosim_ticks;                // ticks run ahead in the window
+static uint8_t cosim_gpio = 0xFF;           // drive lines of the window
+static int cosim_sent = -1;                 // bus lines last sent to the drive, -1 for none
+
+void c64_set_iec_gpio(uint8_t gpio_state);
+
+// Copy the C64 state for a rewind, without the frame buffer (the replay draws
+// the same pixels again) and the tape data (only read), ~120 KB instead of ~800 KB
+static void _c64_cosim_copy(c64_t* dst, const c64_t* src) {
+    memcpy(dst, src, offsetof(c64_t, fb));
+    memcpy(&dst->c1530, &src->c1530, offsetof(c1530_t, buf));
+    memcpy(&dst->c1541, &src->c1541, sizeof(c64_t) - offsetof(c64_t, c1541));
+}
+
+// returns the number of ticks run, less than `ticks` if `edges` got full
+uint32_t c64_cosim_run(uint32_t ticks, uint32_t* edges, uint32_t max_edges) {
+    if (!initialized || (max_edges == 0)) return 0;
+    _c64_cosim_copy(&cosim_c64, &c64);
+    memcpy(&cosim_bus, c64.iec_bus, sizeof(iecbus_t));
+    cosim_tick_count = c64_tick_count;
+    int lines = cosim_sent;
+    uint32_t num_edges = 0;
+    for (cosim_ticks = 0; (cosim_ticks < ticks) && (num_edges < (max_edges - 1)); cosim_ticks++) {
+        _c64_emulation_step(&no_rec);
+        const uint8_t bus = iec_get_signals(c64.iec_bus);
+        if (bus != lines) {
+            edges[num_edges++] = (cosim_ticks << 8) | bus;
+            lines = bus;
+        }
+    }
+    edges[num_edges] = C64_COSIM_END;
+    return cosim_ticks;
+}
+
+// end the window after `ticks` drive ticks, then the drive lines are gpio_state
+void c64_cosim_commit(uint32_t ticks, uint8_t gpio_state) {
+    if (!initialized) return;
+    CHIPS_ASSERT(ticks <= cosim_ticks);
+    // rewind if the drive ended the window early, and to record the window
+    if ((cosim_ticks > 0) && ((ticks < cosim_ticks) || input_rec.fp)) {
+        _c64_cosim_copy(&c64, &cosim_c64);
+        memcpy(c64.iec_bus, &cosim_bus, sizeof(iecbus_t));
+        c64_tick_count = cosim_tick_count;
+        for (uint32_t i = 0; i < ticks; i++) {
+            _c64_emulation_step(&input_rec);
+        }
+    }
+    if (ticks > 0) {
+        // the drive has applied the edges up to here
+        cosim_sent = iec_get_signals(c64.iec_bus);
+    }
+    cosim_ticks = 0;
+    if (gpio_state != cosim_gpio) {
+        cosim_gpio = gpio_state;
+        c64_set_iec_gpio(gpio_state);
     }
 }
 
@@ -79,11 +171,11 @@ void c64_get_video_buffer(const uint8_t** fb, const uint8_t** color_ram,
 
 // Send keypress to C64 (wrapper that calls the actual c64 function)
 void c64_key_down_wrapper(int key_code) {
-    c64_key_down(&c64, key_code);
+    c64_rec_key_down(&input_rec, &c64, key_code);
 }
 
 void c64_key_up_wrapper(int key_code) {
-    c64_key_up(&c64, key_code);
+    c64_rec_key_up(&input_rec, &c64, key_code);
 }
 
 // IEC GPIO Interface - Called by RP2040 GPIO changes
@@ -92,7 +184,7 @@ void c64_key_up_wrapper(int key_code) {
 void c64_set_iec_gpio(uint8_t gpio_state) {
     // Directly set C64's IEC device signals from GPIO state
     // gpio_state format matches IECLINE_* bits exactly
-    iec_set_signals(c64.iec_bus, host_iec, gpio_state);
+    c64_rec_iec(&input_rec, &c64, host_iec, gpio_state);
 }
 
 // Get combined IEC bus state (C64 + RP2040 + any other devices)
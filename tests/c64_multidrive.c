@@ -0,0 +1,214 @@
+/*
+    c64_multidrive.c
+
+    Checks loading from another drive than device 8. Boots a C64 with one
+    drive and loads the disk image with LOAD"*",8,1, then boots it with
+    four drives (with and without c64_desc_t.drive_sleep) and loads the
+    same image from device 9, while devices 8, 10 and 11 stay empty. In
+    the four drive runs a host IEC device is connected as well, like the
+    one of c64_replay and c64_batch. The loaded program must be the same
+    in all runs.
+
+    The four drive run with drive_sleep is recorded (systems/c64_rec.h)
+    and replayed into a machine set up from the recording header, which
+    must pass all checkpoints, and into a single drive machine, which
+    c64_replay_check() must refuse. Prints OK or the first failure.
+
+    Usage: c64_multidrive [-d FILENAME.g64]
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#ifdef USE_CONNOMORE_M6502
+#define likely(x) __builtin_expect(!!(x), 1)
+#include "../chips/m6502_connomore64.h"
+#else
+#include "../chips/m6502.h"
+#endif
+#include "../chips/m6526.h"
+#include "../chips/m6569.h"
+#include "../chips/m6581.h"
+#include "../chips/kbd.h"
+#include "../chips/mem.h"
+#include "../chips/clk.h"
+#include "../systems/c1530.h"
+#ifdef USE_FAST_M6522
+#include "../chips/m6522_fast.h"
+#else
+#include "../chips/m6522.h"
+#endif
+#include "../systems/c1541.h"
+#include "../systems/c64.h"
+#include "../systems/c64_rec.h"
+#include "c64-roms.h"
+#include "c1541-roms.h"
+
+#define REC_FILENAME "c64_multidrive.rec"
+#define STEP_USEC (20000)
+#define BOOT_USEC (3000000)
+#define MAX_LOAD_USEC (120000000)
+
+// RAM above the screen, only the load changes it
+#define LOAD_AREA (0x0800)
+
+typedef struct {
+    uint16_t end;           // end of the loaded program
+    uint32_t hash;          // of the RAM from LOAD_AREA on
+    uint8_t status;         // KERNAL status byte
+} load_t;
+
+static c64_t c64;
+
+static void init(c64_t* sys, int num_drives, bool drive_sleep) {
+    c64_init(sys, &(c64_desc_t){
+        .roms = {
+            .chars = { .ptr=dump_c64_char_bin, .size=sizeof(dump_c64_char_bin) },
+            .basic = { .ptr=dump_c64_basic_bin, .size=sizeof(dump_c64_basic_bin) },
+            .kernal = { .ptr=dump_c64_kernalv3_bin, .size=sizeof(dump_c64_kernalv3_bin) },
+            .c1541 = {
+                .c000_dfff = { .ptr=dump_1541_c000_325302_01_bin, .size=sizeof(dump_1541_c000_325302_01_bin) },
+                .e000_ffff = { .ptr=dump_1541_e000_901229_06aa_bin, .size=sizeof(dump_1541_e000_901229_06aa_bin) }
+            }
+        },
+        .c1541_enabled = true,
+        .num_drives = num_drives,
+        .drive_sleep = drive_sleep,
+    });
+}
+
+// number of READY. prompts on the screen
+static int num_ready(c64_t* sys) {
+    static const uint8_t ready[6] = { 0x12, 0x05, 0x01, 0x04, 0x19, 0x2E };
+    int n = 0;
+    for (int addr = 0x0400; addr <= (0x07E8 - (int)sizeof(ready)); addr++) {
+        n += (0 == memcmp(&sys->ram[addr], ready, sizeof(ready)));
+    }
+    return n;
+}
+
+// boots, loads from the device and waits for the READY. after the load
+static bool run_load(c64_t* sys, c64_rec_t* rec, int device, load_t* res) {
+    for (uint32_t us = 0; us < BOOT_USEC; us += STEP_USEC) {
+        c64_rec_exec(rec, sys, STEP_USEC);
+    }
+    char cmd[16];
+    snprintf(cmd, sizeof(cmd), "L\x6f\"*\",%d,1\r", device);
+    c64_rec_keybuf(rec, sys, cmd);
+    for (uint32_t us = 0; us < MAX_LOAD_USEC; us += STEP_USEC) {
+        c64_rec_exec(rec, sys, STEP_USEC);
+        if (num_ready(sys) >= 2) {
+            res->end = sys->ram[0xAE] | (sys->ram[0xAF] << 8);
+            res->status = sys->ram[0x90];
+            res->hash = chips_hash(CHIPS_HASH_INIT, &sys->ram[LOAD_AREA], sizeof(sys->ram) - LOAD_AREA);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool check_load(const char* name, const load_t* res, const load_t* ref) {
+    if ((res->end != ref->end) || (res->hash != ref->hash) || (res->status != ref->status)) {
+        printf("FAIL: %s loaded up to %04X, hash %08X, status %02X, device 8 alone up to %04X, hash %08X, status %02X\n",
+            name, res->end, res->hash, res->status, ref->end, ref->hash, ref->status);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* disk_filename = "../docs/1541_test_demo.g64";
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc)) {
+            disk_filename = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [-d FILENAME.g64]\n", argv[0]);
+            return 2;
+        }
+    }
+    c64_rec_t no_rec = { 0 };
+
+    // reference: single drive
+    load_t ref = { 0 };
+    init(&c64, 1, false);
+    if (!c1541_attach_disk(&c64.c1541, disk_filename)) {
+        fprintf(stderr, "Error: cannot attach disk image %s\n", disk_filename);
+        return 2;
+    }
+    const bool ref_ok = run_load(&c64, &no_rec, 8, &ref);
+    c64_discard(&c64);
+    // anything but EOI is an error
+    if (!ref_ok || (ref.status & 0xBF)) {
+        printf("FAIL: no load from device 8 alone (status %02X)\n", ref.status);
+        return 1;
+    }
+    printf("device 8 alone: loaded up to %04X\n", ref.end);
+
+    // four drives, image in device 9, the run with drive_sleep is recorded
+    for (int sleep = 0; sleep < 2; sleep++) {
+        const char* name = sleep ? "device 9 of 4 (drive_sleep)" : "device 9 of 4";
+        c64_rec_t rec = { 0 };
+        load_t res = { 0 };
+        init(&c64, C64_MAX_DRIVES, sleep);
+        iecbus_device_t* host = iec_connect(&c64.iec_bus, false);
+        if (!host) {
+            printf("FAIL: no IEC bus slot for a host device next to %d drives\n", C64_MAX_DRIVES);
+            return 1;
+        }
+        if (sleep && !c64_rec_open(&rec, &c64, REC_FILENAME, C64_REC_FLAG_HOST_IEC, C64_FREQUENCY / 10)) {
+            fprintf(stderr, "Error: cannot write %s\n", REC_FILENAME);
+            return 2;
+        }
+        c64_rec_attach_drive_disk(&rec, &c64, 1, disk_filename);
+        const bool ok = run_load(&c64, &rec, 9, &res);
+        c64_rec_close(&rec, &c64);
+        iec_disconnect(c64.iec_bus, host);
+        c64_discard(&c64);
+        if (!ok) {
+            printf("FAIL: %s didn't finish loading\n", name);
+            return 1;
+        }
+        if (!check_load(name, &res, &ref)) {
+            return 1;
+        }
+        printf("%s: loaded up to %04X\n", name, res.end);
+    }
+
+    // replay with the setup of the recording header
+    c64_replay_t rp;
+    if (!c64_replay_open(&rp, REC_FILENAME)) {
+        printf("FAIL: cannot read back %s\n", REC_FILENAME);
+        return 1;
+    }
+    init(&c64, (int)rp.header.num_drives, 0 != (rp.header.flags & C64_REC_FLAG_DRIVE_SLEEP));
+    rp.host = iec_connect(&c64.iec_bus, false);
+    const char* error = c64_replay_check(&rp, &c64);
+    const c64_replay_status_t status = error ? C64_REPLAY_ERROR : c64_replay_run(&rp, &c64);
+    iec_disconnect(c64.iec_bus, rp.host);
+    c64_replay_close(&rp);
+    c64_discard(&c64);
+    if (status != C64_REPLAY_END) {
+        printf("FAIL: replay %s after %u checkpoints\n", error ? error : "failed", rp.num_checks);
+        return 1;
+    }
+    printf("replay: %u checkpoints\n", rp.num_checks);
+
+    // a single drive machine must be refused, not replayed into a mismatch
+    c64_replay_open(&rp, REC_FILENAME);
+    init(&c64, 1, false);
+    rp.host = iec_connect(&c64.iec_bus, false);
+    error = c64_replay_check(&rp, &c64);
+    iec_disconnect(c64.iec_bus, rp.host);
+    c64_replay_close(&rp);
+    c64_discard(&c64);
+    remove(REC_FILENAME);
+    if (!error) {
+        printf("FAIL: replay into a single drive machine not refused\n");
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+    c64_replay.c
+
+    Headless replay of an input recording (systems/c64_rec.h), written by
+    c64-ascii -R or the c64_record_start() call of the emulation wrapper.
+    The machine gets the drives and drive_sleep setting of the recording.
+    Runs at full speed, compares every checkpoint hash and exits with 0 if
+    all of them match, 1 on the first mismatch and 2 on errors.
+
+    Build with the same flags as the recording emulator (e.g.
+    -DUSE_CONNOMORE_M6502, -DUSE_FAST_M6522), see the replay target in the
+    Makefile.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#ifdef USE_CONNOMORE_M6502
+#define likely(x) __builtin_expect(!!(x), 1)
+#include "../chips/m6502_connomore64.h"
+#else
+#include "../chips/m6502.h"
+#endif
+#include "../chips/m6526.h"
+#include "../chips/m6569.h"
+#include "../chips/m6581.h"
+#include "../chips/kbd.h"
+#include "../chips/mem.h"
+#include "../chips/clk.h"
+#include "../systems/c1530.h"
+#ifdef USE_FAST_M6522
+#include "../chips/m6522_fast.h"
+#else
+#include "../chips/m6522.h"
+#endif
+#include "../systems/c1541.h"
+#include "../systems/c64.h"
+#include "../systems/c64_rec.h"
+#include "c64-roms.h"
+#include "c1541-roms.h"
+
+static c64_t c64;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s FILENAME.rec\n", argv[0]);
+        return 2;
+    }
+    c64_replay_t rp;
+    if (!c64_replay_open(&rp, argv[1])) {
+        fprintf(stderr, "Error: cannot read recording %s\n", argv[1]);
+        return 2;
+    }
+    if (rp.header.num_drives > C64_MAX_DRIVES) {
+        fprintf(stderr, "Error: recording needs %u drives, at most %d are supported\n", rp.header.num_drives, C64_MAX_DRIVES);
+        return 2;
+    }
+    c64_init(&c64, &(c64_desc_t){
+        .roms = {
+            .chars = { .ptr=dump_c64_char_bin, .size=sizeof(dump_c64_char_bin) },
+            .basic = { .ptr=dump_c64_basic_bin, .size=sizeof(dump_c64_basic_bin) },
+            .kernal = { .ptr=dump_c64_kernalv3_bin, .size=sizeof(dump_c64_kernalv3_bin) },
+            .c1541 = {
+                .c000_dfff = { .ptr=dump_1541_c000_325302_01_bin, .size=sizeof(dump_1541_c000_325302_01_bin) },
+                .e000_ffff = { .ptr=dump_1541_e000_901229_06aa_bin, .size=sizeof(dump_1541_e000_901229_06aa_bin) }
+            }
+        },
+        .c1541_enabled = rp.header.num_drives > 0,
+        .num_drives = (int)rp.header.num_drives,
+        .drive_sleep = 0 != (rp.header.flags & C64_REC_FLAG_DRIVE_SLEEP),
+    });
+    if (rp.header.flags & C64_REC_FLAG_HOST_IEC) {
+        rp.host = iec_connect(&c64.iec_bus, false);
+    }
+    const char* error = c64_replay_check(&rp, &c64);
+    if (error) {
+        fprintf(stderr, "Error: %s\n", error);
+        return 2;
+    }
+
+    const uint64_t t0 = now_ns();
+    const c64_replay_status_t status = c64_replay_run(&rp, &c64);
+    const uint64_t ns = now_ns() - t0;
+    if (rp.host) {
+        iec_disconnect(c64.iec_bus, rp.host);
+    }
+    c64_replay_close(&rp);
+    c64_discard(&c64);
+
+    const double emulated_s = (double)rp.cycle / C64_FREQUENCY;
+    switch (status) {
+        case C64_REPLAY_END:
+            printf("OK: %u checkpoints, %llu cycles (%.1f s emulated) in %.2f s (%.1fx realtime)\n",
+                rp.num_checks, (unsigned long long)rp.cycle, emulated_s, ns * 1e-9, emulated_s / (ns * 1e-9));
+            return 0;
+        case C64_REPLAY_MISMATCH:
+            printf("MISMATCH at checkpoint %u: recorded cycle %llu hash %08X, replayed cycle %llu hash %08X\n",
+                rp.num_checks, (unsigned long long)rp.fail_cycle, rp.expected_hash,
+                (unsigned long long)rp.cycle, rp.actual_hash);
+            return 1;
+        default:
+            printf("ERROR: broken recording after %llu cycles\n", (unsigned long long)rp.cycle);
+            return 2;
+    }
+}
@@ -0,0 +1,146 @@
+/*
+    c64_snapshot.c
+
+    Checks c64_save_snapshot()/c64_load_snapshot() across instances: a
+    snapshot of machine A (two drives) is loaded into machine B, which
+    has its own IEC bus. B must stay on its own bus, and A and B must then
+    run in lockstep (same c64_rec_hash()). Discarding B must leave A's
+    bus intact.
+
+    A copies the ROMs, B uses shared ROMs (c64_desc_t.shared_roms) with
+    the two C1541 ROM halves in separate allocations, so B must not hold
+    any ROM copies. Prints OK or the first failure.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#ifdef USE_CONNOMORE_M6502
+#define likely(x) __builtin_expect(!!(x), 1)
+#include "../chips/m6502_connomore64.h"
+#else
+#include "../chips/m6502.h"
+#endif
+#include "../chips/m6526.h"
+#include "../chips/m6569.h"
+#include "../chips/m6581.h"
+#include "../chips/kbd.h"
+#include "../chips/mem.h"
+#include "../chips/clk.h"
+#include "../systems/c1530.h"
+#ifdef USE_FAST_M6522
+#include "../chips/m6522_fast.h"
+#else
+#include "../chips/m6522.h"
+#endif
+#include "../systems/c1541.h"
+#include "../systems/c64.h"
+#include "../systems/c64_rec.h"
+#include "c64-roms.h"
+#include "c1541-roms.h"
+
+#define NUM_DRIVES (2)
+
+static c64_t machine_a, machine_b, snapshot;
+
+static void init(c64_t* sys, bool shared_roms, const uint8_t* c1541_c000, const uint8_t* c1541_e000) {
+    c64_init(sys, &(c64_desc_t){
+        .roms = {
+            .chars = { .ptr=dump_c64_char_bin, .size=sizeof(dump_c64_char_bin) },
+            .basic = { .ptr=dump_c64_basic_bin, .size=sizeof(dump_c64_basic_bin) },
+            .kernal = { .ptr=dump_c64_kernalv3_bin, .size=sizeof(dump_c64_kernalv3_bin) },
+            .c1541 = {
+                .c000_dfff = { .ptr=(void*)c1541_c000, .size=0x2000 },
+                .e000_ffff = { .ptr=(void*)c1541_e000, .size=0x2000 }
+            }
+        },
+        .c1541_enabled = 1,
+        .num_drives = NUM_DRIVES,
+        .drive_sleep = true,
+        .shared_roms = shared_roms,
+    });
+}
+
+// all devices of the machine are on its own bus
+static bool on_own_bus(c64_t* sys, iecbus_t* bus) {
+    if ((sys->iec_bus != bus) || (sys->iec_device < bus->devices) || (sys->iec_device >= bus->devices + IEC_BUS_MAX_DEVICES)) {
+        return false;
+    }
+    for (int i = 0; i < sys->num_drives; i++) {
+        c1541_t* drive = c64_drive(sys, i);
+        if ((drive->iec_bus != bus) || (drive->iec_device < bus->devices) || (drive->iec_device >= bus->devices + IEC_BUS_MAX_DEVICES)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int fail(const char* msg) {
+    printf("FAIL: %s\n", msg);
+    return 1;
+}
+
+int main(void) {
+    // the C1541 ROM halves of B, not adjacent in memory
+    uint8_t* c1541_e000 = malloc(0x2000);
+    uint8_t* gap = malloc(0x100);
+    uint8_t* c1541_c000 = malloc(0x2000);
+    memcpy(c1541_c000, dump_1541_c000_325302_01_bin, 0x2000);
+    memcpy(c1541_e000, dump_1541_e000_901229_06aa_bin, 0x2000);
+    init(&machine_a, false, dump_1541_c000_325302_01_bin, dump_1541_e000_901229_06aa_bin);
+    init(&machine_b, true, c1541_c000, c1541_e000);
+    if (!machine_a.rom_copy || machine_b.rom_copy) {
+        return fail("ROM copies don't match shared_roms");
+    }
+    for (int i = 0; i < NUM_DRIVES; i++) {
+        if (c64_drive(&machine_b, i)->rom_copy || (c64_drive(&machine_b, i)->rom[1] != c1541_e000)) {
+            return fail("drive of the shared ROM machine doesn't use the caller's ROM");
+        }
+    }
+    if ((machine_a.roms.hash != machine_b.roms.hash) || (machine_a.c1541.rom_hash != machine_b.c1541.rom_hash)) {
+        return fail("ROM hashes differ");
+    }
+    iecbus_t* bus_a = machine_a.iec_bus;
+    iecbus_t* bus_b = machine_b.iec_bus;
+    const uint8_t usage_a = bus_a->usage_map;
+    if (bus_a == bus_b) {
+        return fail("machines share an IEC bus");
+    }
+    // run B elsewhere, so that the load has to replace all of its state
+    c64_exec(&machine_a, 2000000);
+    c64_exec(&machine_b, 500000);
+
+    const uint32_t version = c64_save_snapshot(&machine_a, &snapshot);
+    if (!c64_load_snapshot(&machine_b, version, &snapshot)) {
+        return fail("snapshot not loaded");
+    }
+    if (!on_own_bus(&machine_b, bus_b) || !on_own_bus(&machine_a, bus_a)) {
+        return fail("loaded machine is on the wrong IEC bus");
+    }
+    if (iec_get_signals(bus_a) != iec_get_signals(bus_b)) {
+        return fail("IEC lines differ after the load");
+    }
+    for (int frame = 0; frame < 100; frame++) {
+        c64_exec(&machine_a, 20000);
+        c64_exec(&machine_b, 20000);
+        if (c64_rec_hash(&machine_a) != c64_rec_hash(&machine_b)) {
+            printf("FAIL: state differs in frame %d\n", frame);
+            return 1;
+        }
+    }
+
+    c64_discard(&machine_b);
+    if (bus_a->usage_map != usage_a) {
+        return fail("discarding the loaded machine changed the other bus");
+    }
+    c64_exec(&machine_a, 20000);
+    c64_discard(&machine_a);
+    free(c1541_c000);
+    free(gap);
+    free(c1541_e000);
+    printf("OK\n");
+    return 0;
+}
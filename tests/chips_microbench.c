@@ -0,0 +1,350 @@
+/*
+    chips_microbench.c
+
+    Microbenchmarks of the per-tick hot paths, driven by synthetic pin
+    streams instead of a running system:
+
+    m6502_tick          CPU running a small instruction mix from a flat 64 KB RAM
+    m6522_tick          VIA with a register access every 16 ticks
+    _m6522_tick         VIA without register accesses (as ticked by c1541.h)
+    c1541_via2_motor_off / _on
+                        _c1541_tick_via2() with the drive motor off / on
+                        (rotor and GCR shift register running on a synthetic track)
+    iec_get_signals_N   iec_get_signals() with N = 1..4 connected devices
+
+    Each benchmark is repeated, one JSON line per benchmark reports the
+    median, minimum and maximum ticks per second and the spread
+    ((max-min)/median) of the runs.
+
+    Build once as is and once with -DUSE_CONNOMORE_M6502 -DUSE_FAST_M6522
+    to compare the chip variants, see the microbench target in the Makefile.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#ifdef USE_CONNOMORE_M6502
+#define likely(x) __builtin_expect(!!(x), 1)
+#include "../chips/m6502_connomore64.h"
+#define CPU_IMPL "m6502_connomore64"
+#else
+#include "../chips/m6502.h"
+#define CPU_IMPL "m6502"
+#endif
+#ifdef USE_FAST_M6522
+#include "../chips/m6522_fast.h"
+#define VIA_IMPL "m6522_fast"
+#else
+#include "../chips/m6522.h"
+#define VIA_IMPL "m6522"
+#endif
+#include "../chips/mem.h"
+#include "../systems/c1541.h"
+
+#define MAX_RUNS (64)
+
+typedef struct {
+    const char* name;
+    const char* impl;
+    void (*setup)(int arg);
+    uint64_t (*run)(uint64_t num_ticks);
+    int arg;
+    uint64_t num_ticks;
+} bench_t;
+
+// keeps the compiler from dropping the benchmarked work
+static volatile uint64_t sink;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*=== m6502 =================================================================*/
+static m6502_t cpu;
+static uint8_t cpu_mem[1<<16];
+#ifdef HAVE_CONNOMORE_M6502H
+static uint32_t cpu_pins;
+#else
+static uint64_t cpu_pins;
+#endif
+
+// instruction mix: immediate, zero page, absolute indexed, indirect indexed,
+// stack, JSR/RTS, branches
+static const uint8_t cpu_prog[] = {
+    0xA9, 0x01,         // 0400: LDA #$01
+    0x85, 0x10,         // 0402: STA $10
+    0xA6, 0x10,         // 0404: LDX $10
+    0xE8,               // 0406: INX
+    0x9D, 0x00, 0x03,   // 0407: STA $0300,X
+    0xC8,               // 040A: INY
+    0x71, 0x20,         // 040B: ADC ($20),Y
+    0x48,               // 040D: PHA
+    0x68,               // 040E: PLA
+    0x20, 0x20, 0x04,   // 040F: JSR $0420
+    0xD0, 0x02,         // 0412: BNE $0416
+    0xEA,               // 0414: NOP
+    0xEA,               // 0415: NOP
+    0x4C, 0x00, 0x04,   // 0416: JMP $0400
+};
+static const uint8_t cpu_sub[] = {
+    0xE6, 0x11,         // 0420: INC $11
+    0x60,               // 0422: RTS
+};
+
+static void setup_m6502(int arg) {
+    (void)arg;
+    memset(cpu_mem, 0, sizeof(cpu_mem));
+    memcpy(&cpu_mem[0x0400], cpu_prog, sizeof(cpu_prog));
+    memcpy(&cpu_mem[0x0420], cpu_sub, sizeof(cpu_sub));
+    cpu_mem[0x20] = 0x00; cpu_mem[0x21] = 0x05;
+    cpu_mem[0xFFFC] = 0x00; cpu_mem[0xFFFD] = 0x04;
+    cpu_pins = m6502_init(&cpu, &(m6502_desc_t){0});
+}
+
+static uint64_t run_m6502(uint64_t num_ticks) {
+    for (uint64_t i = 0; i < num_ticks; i++) {
+        cpu_pins = m6502_tick(&cpu, cpu_pins);
+#ifdef HAVE_CONNOMORE_M6502H
+        if (cpu_pins & M6502_RW) {
+            cpu.bus_data = cpu_mem[cpu.bus_addr];
+        } else {
+            cpu_mem[cpu.bus_addr] = cpu.bus_data;
+        }
+#else
+        const uint16_t addr = M6502_GET_ADDR(cpu_pins);
+        if (cpu_pins & M6502_RW) {
+            M6502_SET_DATA(cpu_pins, cpu_mem[addr]);
+        } else {
+            cpu_mem[addr] = M6502_GET_DATA(cpu_pins);
+        }
+#endif
+    }
+    return m6502_pc(&cpu);
+}
+
+/*=== m6522 =================================================================*/
+static m6522_t via;
+
+// register accesses cycled through by the m6522_tick benchmark
+static const struct {
+    uint8_t reg;
+    bool write;
+    uint8_t data;
+} via_accesses[] = {
+    { M6522_REG_DDRB, true, 0x1A },
+    { M6522_REG_IER, true, 0xC0 },
+    { M6522_REG_T1CL, true, 0x40 },
+    { M6522_REG_T1CH, true, 0x00 },     // start T1
+    { M6522_REG_RB, true, 0x08 },
+    { M6522_REG_RA, false, 0 },
+    { M6522_REG_IFR, false, 0 },
+    { M6522_REG_T1CL, false, 0 },       // clear T1 IRQ
+};
+#define NUM_VIA_ACCESSES (sizeof(via_accesses) / sizeof(via_accesses[0]))
+
+static void setup_m6522(int arg) {
+    (void)arg;
+    m6522_init(&via);
+    m6522_reset(&via);
+    // free-running T1
+    _m6522_write(&via, M6522_REG_ACR, 0x40);
+}
+
+// synthetic port input: slowly changing PA/PB, CA1 edges
+static inline uint64_t via_input_pins(uint64_t i) {
+    uint64_t pins = 0;
+    M6522_SET_PAB(pins, i >> 8, (i >> 10) & 0x85);
+    if (i & 0x200) {
+        pins |= M6522_CA1;
+    }
+    return pins;
+}
+
+static uint64_t run_m6522(uint64_t num_ticks) {
+    uint64_t acc = 0;
+    for (uint64_t i = 0; i < num_ticks; i++) {
+        uint64_t pins = via_input_pins(i);
+        if ((i & 15) == 0) {
+            const uint32_t a = (i >> 4) % NUM_VIA_ACCESSES;
+            pins |= M6522_CS1 | via_accesses[a].reg;
+            if (via_accesses[a].write) {
+                M6522_SET_DATA(pins, via_accesses[a].data);
+            } else {
+                pins |= M6522_RW;
+            }
+        }
+        pins = m6522_tick(&via, pins);
+        acc += pins & M6522_IRQ;
+    }
+    return acc;
+}
+
+static uint64_t run_m6522_internal(uint64_t num_ticks) {
+    uint64_t acc = 0;
+    for (uint64_t i = 0; i < num_ticks; i++) {
+        const uint64_t pins = _m6522_tick(&via, via_input_pins(i));
+        acc += pins & M6522_IRQ;
+    }
+    return acc;
+}
+
+/*=== C1541 VIA2 ============================================================*/
+static c1541_t drive;
+static uint8_t drive_rom[0x4000];
+
+static void setup_c1541_via2(int motor_on) {
+    if (drive.valid) {
+        c1541_discard(&drive);
+    }
+    c1541_init(&drive, &(c1541_desc_t){
+        .roms = {
+            .c000_dfff = { .ptr=&drive_rom[0x0000], .size=0x2000 },
+            .e000_ffff = { .ptr=&drive_rom[0x2000], .size=0x2000 },
+        },
+    });
+    // synthetic track: sync marks followed by GCR-like data
+    uint8_t* gcr = drive.storage->gcr_bytes;
+    for (uint32_t i = 0; i < 7692; i++) {
+        gcr[i] = ((i % 360) < 5) ? 0xFF : (uint8_t)((0x52 + i * 0x1D) | 0x01);
+    }
+    gcr[7692] = 0;
+    drive.gcr_size = 7692;
+    drive.nanoseconds_per_bit = 3250;
+    // head on track 18 with the stepper phase matching port B, motor on
+    // PB2, read mode (CB2 high)
+    drive.half_track = 36;
+    drive.via_2.pb.ddr = 0x6F;
+    drive.via_2.pb.outr = motor_on ? 0x04 : 0x00;
+    _m6522_write(&drive.via_2, M6522_REG_PCR, 0xEE);
+    drive.via_2.pins = _m6522_tick(&drive.via_2, 0);
+}
+
+static uint64_t run_c1541_via2(uint64_t num_ticks) {
+    uint64_t acc = 0;
+    for (uint64_t i = 0; i < num_ticks; i++) {
+        acc += _c1541_tick_via2(&drive);
+    }
+    return acc + drive.rotor.output_data;
+}
+
+/*=== IEC bus ===============================================================*/
+static iecbus_t* iec_bus;
+static iecbus_device_t* iec_devices[4];
+static int num_iec_devices;
+
+static void setup_iec(int num_devices) {
+    for (int i = 0; i < num_iec_devices; i++) {
+        iec_disconnect(iec_bus, iec_devices[i]);
+    }
+    iec_bus = NULL;
+    num_iec_devices = num_devices;
+    for (int i = 0; i < num_devices; i++) {
+        // the first device is the host, drives have ATNA logic
+        iec_devices[i] = iec_connect(&iec_bus, i > 0);
+        CHIPS_ASSERT(iec_devices[i]);
+    }
+}
+
+static uint64_t run_iec(uint64_t num_ticks) {
+    uint64_t acc = 0;
+    for (uint64_t i = 0; i < num_ticks; i++) {
+        // one device changes its lines every 8 ticks
+        if ((i & 7) == 0) {
+            const int dev = (int)((i >> 3) % num_iec_devices);
+            iec_set_signals(iec_bus, iec_devices[dev], (uint8_t)(IEC_ALL_LINES & ~((i >> 5) & (IECLINE_ATN|IECLINE_CLK|IECLINE_DATA|IECLINE_ATNA))));
+        }
+        acc += iec_get_signals(iec_bus);
+    }
+    return acc;
+}
+
+/*=== runner ================================================================*/
+static const bench_t benches[] = {
+    { "m6502_tick", CPU_IMPL, setup_m6502, run_m6502, 0, 20000000 },
+    { "m6522_tick", VIA_IMPL, setup_m6522, run_m6522, 0, 20000000 },
+    { "_m6522_tick", VIA_IMPL, setup_m6522, run_m6522_internal, 0, 20000000 },
+    { "c1541_via2_motor_off", VIA_IMPL, setup_c1541_via2, run_c1541_via2, 0, 20000000 },
+    { "c1541_via2_motor_on", VIA_IMPL, setup_c1541_via2, run_c1541_via2, 1, 20000000 },
+    { "iec_get_signals_1", "iecbus", setup_iec, run_iec, 1, 50000000 },
+    { "iec_get_signals_2", "iecbus", setup_iec, run_iec, 2, 50000000 },
+    { "iec_get_signals_3", "iecbus", setup_iec, run_iec, 3, 50000000 },
+    { "iec_get_signals_4", "iecbus", setup_iec, run_iec, 4, 50000000 },
+};
+#define NUM_BENCHES (sizeof(benches) / sizeof(benches[0]))
+
+static int cmp_double(const void* a, const void* b) {
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void run(FILE* out, const bench_t* b, int num_runs, double scale) {
+    const uint64_t num_ticks = (uint64_t)(b->num_ticks * scale) + 1;
+    double ticks_per_sec[MAX_RUNS];
+    b->setup(b->arg);
+    // warm up caches and branch predictors
+    sink += b->run(num_ticks / 10);
+    for (int i = 0; i < num_runs; i++) {
+        const uint64_t t0 = now_ns();
+        sink += b->run(num_ticks);
+        const uint64_t t1 = now_ns();
+        ticks_per_sec[i] = (double)num_ticks * 1e9 / (double)(t1 - t0);
+    }
+    qsort(ticks_per_sec, num_runs, sizeof(double), cmp_double);
+    const double median = ticks_per_sec[num_runs / 2];
+    const double min = ticks_per_sec[0];
+    const double max = ticks_per_sec[num_runs - 1];
+    fprintf(out, "{\"bench\":\"%s\",\"impl\":\"%s\",\"ticks\":%llu,\"runs\":%d,"
+        "\"median_ticks_per_sec\":%.0f,\"min_ticks_per_sec\":%.0f,\"max_ticks_per_sec\":%.0f,"
+        "\"ns_per_tick\":%.3f,\"spread_pct\":%.2f}\n",
+        b->name, b->impl, (unsigned long long)num_ticks, num_runs,
+        median, min, max, 1e9 / median, 100.0 * (max - min) / median);
+    fflush(out);
+}
+
+int main(int argc, char* argv[]) {
+    const char* only = NULL;
+    const char* out_filename = NULL;
+    int num_runs = 9;
+    double scale = 1.0;
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc)) {
+            only = argv[++i];
+        } else if ((strcmp(argv[i], "-r") == 0) && (i + 1 < argc)) {
+            num_runs = atoi(argv[++i]);
+        } else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) {
+            scale = atof(argv[++i]);
+        } else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) {
+            out_filename = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [-b BENCH_PREFIX] [-r RUNS] [-s TICK_SCALE] [-o FILENAME.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((num_runs < 1) || (num_runs > MAX_RUNS) || (scale <= 0.0)) {
+        fprintf(stderr, "RUNS must be 1..%d, TICK_SCALE > 0\n", MAX_RUNS);
+        return 1;
+    }
+    // the IEC bus logs to stdout, so results can go to a file
+    FILE* out = stdout;
+    if (out_filename && !(out = fopen(out_filename, "w"))) {
+        fprintf(stderr, "Failed to open %s\n", out_filename);
+        return 1;
+    }
+    for (size_t i = 0; i < NUM_BENCHES; i++) {
+        if (only && strncmp(benches[i].name, only, strlen(only))) {
+            continue;
+        }
+        run(out, &benches[i], num_runs, scale);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+    m6522_timer_wrap.c
+
+    Runs a free-running T1 of the event driven m6522_fast.h past the 2^31
+    and 2^32 tick boundaries of its 32-bit tick counter (~72 minutes of
+    drive time at 1 MHz) and checks that every T1 interrupt comes exactly
+    latch+2 ticks after the previous one, and that a T2 loaded after the
+    boundaries still fires. Like VIA1 in c1541.h, idle ticks only advance
+    the tick counter, here in one step up to the next timer event. Prints
+    OK or the first failure.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define CHIPS_IMPL
+#include "../chips/chips_common.h"
+#include "../chips/m6522_fast.h"
+
+#define T1_LATCH        (0x8000)
+#define T2_COUNT        (1000)
+#define NUM_TICKS       ((1ULL << 32) + (1ULL << 21))
+
+static m6522_t via;
+
+int main(void) {
+    m6522_init(&via);
+    m6522_reset(&via);
+    _m6522_write(&via, M6522_REG_ACR, 0x40);    // T1 free-running
+    _m6522_write(&via, M6522_REG_IER, 0x80 | M6522_IRQ_T1 | M6522_IRQ_T2);
+    _m6522_write(&via, M6522_REG_T1LL, T1_LATCH & 0xFF);
+    _m6522_write(&via, M6522_REG_T1CL, T1_LATCH & 0xFF);
+    _m6522_write(&via, M6522_REG_T1CH, T1_LATCH >> 8);
+
+    uint64_t last_t1 = 0;
+    uint64_t num_t1 = 0;
+    uint64_t t2_loaded = 0;
+    bool t2_done = true;
+    int t2_checks = 0;
+    for (uint64_t i = 0; i < NUM_TICKS; i++) {
+        if (m6522_idle(&via, 0)) {
+            // skip the idle ticks (see _c1541_tick_via1())
+            const uint32_t n = via.next_event - via.ticks;
+            via.ticks += n;
+            i += n - 1;
+            continue;
+        }
+        const uint64_t pins = m6522_tick(&via, 0);
+        if (!(pins & M6522_IRQ)) {
+            continue;
+        }
+        if (via.intr.ifr & M6522_IRQ_T1) {
+            if (num_t1 && ((i - last_t1) != (T1_LATCH + 2))) {
+                printf("FAIL: T1 interrupt after %llu ticks at tick %llu\n",
+                    (unsigned long long)(i - last_t1), (unsigned long long)i);
+                return 1;
+            }
+            last_t1 = i;
+            num_t1++;
+            _m6522_read(&via, M6522_REG_T1CL);      // clear T1 interrupt
+            // load T2 past each boundary
+            const uint64_t boundary = (t2_checks == 0) ? (1ULL << 31) : (1ULL << 32);
+            if (t2_done && (t2_checks < 2) && (i > boundary)) {
+                _m6522_write(&via, M6522_REG_T2CL, T2_COUNT & 0xFF);
+                _m6522_write(&via, M6522_REG_T2CH, T2_COUNT >> 8);
+                t2_loaded = i;
+                t2_done = false;
+            }
+        }
+        if (via.intr.ifr & M6522_IRQ_T2) {
+            // the interrupt shows on the pin one tick after the flag
+            if ((i - t2_loaded) > (T2_COUNT + 3)) {
+                printf("FAIL: T2 interrupt after %llu ticks at tick %llu\n",
+                    (unsigned long long)(i - t2_loaded), (unsigned long long)i);
+                return 1;
+            }
+            _m6522_read(&via, M6522_REG_T2CL);      // clear T2 interrupt
+            t2_done = true;
+            t2_checks++;
+        }
+    }
+    if ((num_t1 != (NUM_TICKS / (T1_LATCH + 2))) && (num_t1 != (NUM_TICKS / (T1_LATCH + 2) + 1))) {
+        printf("FAIL: %llu T1 interrupts\n", (unsigned long long)num_t1);
+        return 1;
+    }
+    if (t2_checks != 2) {
+        printf("FAIL: T2 didn't fire after the boundaries\n");
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
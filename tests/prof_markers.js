@@ -0,0 +1,125 @@
+/**
+ * Cycle profile of the PROF_TP markers (rp2040/cycle_tracing.h) caught by rp2040js
+ *
+ * Each marker is recorded with the simulated RP2040 cycle count:
+ *  - "tag"     point marker, histogram of the cycles between two of them
+ *              (e.g. "tick": RP2040 cycles per emulated drive cycle)
+ *  - ">name"   begin and "<name" end of a region, regions nest per core and
+ *              are keyed by their path (e.g. "drive/rotor")
+ *  - spans "a:b" histogram of the cycles from a marker "a" to the next "b"
+ *              (e.g. "track:byte": track change to the next byte ready)
+ * Markers of core 1 are keyed as "tag@1".
+ */
+
+// log2 histogram with exact count, min, max and mean
+class Histogram {
+  constructor() {
+    this.count = 0;
+    this.sum = 0;
+    this.min = Infinity;
+    this.max = 0;
+    this.buckets = [];    // bucket k: 2^(k-1) < cycles <= 2^k
+  }
+
+  add(cycles) {
+    this.count++;
+    this.sum += cycles;
+    if (cycles < this.min) this.min = cycles;
+    if (cycles > this.max) this.max = cycles;
+    const k = cycles <= 1 ? 0 : Math.ceil(Math.log2(cycles));
+    this.buckets[k] = (this.buckets[k] || 0) + 1;
+  }
+
+  // upper bound of the bucket holding the given fraction of the samples
+  percentile(p) {
+    let n = 0;
+    for (let k = 0; k < this.buckets.length; k++) {
+      n += this.buckets[k] || 0;
+      if (n >= p * this.count) return Math.min(2 ** k, this.max);
+    }
+    return this.max;
+  }
+
+  toJSON() {
+    const hist = {};
+    this.buckets.forEach((n, k) => { if (n) hist[`${2 ** k}`] = n; });
+    return {
+      count: this.count, min: this.min, max: this.max,
+      mean: this.count ? this.sum / this.count : 0,
+      p50: this.percentile(0.5), p99: this.percentile(0.99), hist,
+    };
+  }
+}
+
+export class MarkerProfile {
+  // spans: list of "a:b" strings
+  constructor(spans = []) {
+    this.hists = new Map();     // "kind name" -> Histogram
+    this.last = new Map();      // point marker -> cycles of the last one
+    this.stacks = [[], []];     // open regions per core
+    this.spans = spans.map((s) => s.split(':'));
+    this.spanStart = new Map(); // "a:b" -> cycles of the pending "a"
+  }
+
+  hist(kind, name) {
+    const key = `${kind} ${name}`;
+    let h = this.hists.get(key);
+    if (!h) {
+      h = new Histogram();
+      this.hists.set(key, h);
+    }
+    return h;
+  }
+
+  mark(cycles, core, tag) {
+    tag = tag.trim();
+    const suffix = core ? `@${core}` : '';
+    const stack = this.stacks[core];
+    if (tag.startsWith('>')) {
+      stack.push({ name: tag.slice(1), start: cycles });
+    } else if (tag.startsWith('<')) {
+      // an end without a matching begin is ignored, unclosed inner regions are dropped
+      const name = tag.slice(1);
+      const i = stack.map((r) => r.name).lastIndexOf(name);
+      if (i >= 0) {
+        const path = stack.slice(0, i + 1).map((r) => r.name).join('/');
+        this.hist('region', path + suffix).add(cycles - stack[i].start);
+        stack.length = i;
+      }
+    } else {
+      const name = tag + suffix;
+      if (this.last.has(name)) {
+        this.hist('interval', name).add(cycles - this.last.get(name));
+      }
+      this.last.set(name, cycles);
+    }
+    for (const [a, b] of this.spans) {
+      const key = `${a}:${b}`;
+      if ((tag === b) && this.spanStart.has(key)) {
+        this.hist('span', key).add(cycles - this.spanStart.get(key));
+        this.spanStart.delete(key);
+      }
+      if (tag === a) {
+        this.spanStart.set(key, cycles);
+      }
+    }
+  }
+
+  // one JSON line per histogram
+  toJSONLines() {
+    return [...this.hists].map(([key, h]) => {
+      const [kind, name] = key.split(' ');
+      return JSON.stringify({ kind, name, ...h.toJSON() });
+    }).join('\n') + '\n';
+  }
+
+  report() {
+    const rows = [...this.hists].sort(([a], [b]) => a.localeCompare(b)).map(([key, h]) => {
+      const j = h.toJSON();
+      return `${key.padEnd(28)} ${String(j.count).padStart(9)} ${String(j.min).padStart(9)} ` +
+        `${j.mean.toFixed(1).padStart(11)} ${String(j.p50).padStart(9)} ${String(j.p99).padStart(9)} ${String(j.max).padStart(9)}`;
+    });
+    return `${'RP2040 cycles'.padEnd(28)} ${'count'.padStart(9)} ${'min'.padStart(9)} ${'mean'.padStart(11)} ` +
+      `${'p50'.padStart(9)} ${'p99'.padStart(9)} ${'max'.padStart(9)}\n` + rows.join('\n') + '\n';
+  }
+}
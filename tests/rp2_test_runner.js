@@ -14,6 +14,7 @@ import * as path from 'path';
 import { fileURLToPath } from 'url';
 import { decodeBlock } from 'uf2';
 import { createRequire } from 'module';
+import { MarkerProfile } from './prof_markers.js';
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
@@ -61,11 +62,27 @@ const c64_get_iec = lib.func('uint8_t c64_get_iec_bus()');
 const c64_get_tick_count = lib.func('uint64_t c64_get_tick_count()');
 const c64_print_tick_count = lib.func('void c64_print_tick_count()');
 const c64_print_screen = lib.func('void c64_print_screen()');
+const c64_record_start = lib.func('bool c64_record_start(const char* filename)');
+const c64_record_stop = lib.func('void c64_record_stop()');
+const c64_cosim_run = lib.func('uint32_t c64_cosim_run(uint32_t ticks, _Out_ uint32_t* edges, uint32_t max_edges)');
+const c64_cosim_commit = lib.func('void c64_cosim_commit(uint32_t ticks, uint8_t gpio_state)');
 
 // Initialize C64
 console.log('Initializing C64 emulator...');
 c64_init();
 
+// C64_RECORD=FILENAME records the C64 inputs (incl. the RP2040 IEC lines) for c64_replay
+if (process.env.C64_RECORD) {
+  if (!c64_record_start(process.env.C64_RECORD)) {
+    console.error(`Cannot write input recording ${process.env.C64_RECORD}`);
+    process.exit(1);
+  }
+  process.on('SIGINT', () => {
+    c64_record_stop();
+    process.exit(0);
+  });
+}
+
 // Initialize RP2040
 console.log('Initializing RP2040...');
 const mcu = new RP2040();
@@ -73,11 +90,28 @@ mcu.loadBootrom(bootromB1);
 
 let doTickC64 = false;
 
+// C1541_PROF=1 (or a file name for JSON lines) profiles the PROF_TP markers, see prof_markers.js,
+// C1541_PROF_SPANS="track:byte,..." adds spans from one marker to the next of another
+const profile = process.env.C1541_PROF ?
+  new MarkerProfile((process.env.C1541_PROF_SPANS || 'track:byte').split(',').filter((s) => s)) : null;
+if (profile) {
+  process.on('exit', () => {
+    console.log(profile.report());
+    if (process.env.C1541_PROF !== '1') {
+      fs.writeFileSync(process.env.C1541_PROF, profile.toJSONLines());
+    }
+  });
+  process.on('SIGINT', () => process.exit(0));
+}
+
 mcu.onTrace = function(coreNumber, pc, tag) {
+  if (profile) {
+    profile.mark(mcu.cycles, coreNumber, tag);
+  }
   if(tag == "tick ") {
     doTickC64 = true;
-  } else {
-    console.log(`${mcu.cycles} PC 0x${pc.toString(16)} tag ${tag}`);
+  } else if (!profile) {
+    console.log(`${mcu.cycles} core ${coreNumber} PC 0x${pc.toString(16)} tag ${tag}`);
   }
 }
 
@@ -102,6 +136,18 @@ if (fs.existsSync(FIRMWARE_PATH)) {
   process.exit(1);
 }
 
+// GCR image for the flash image store (c1541_gcrimg), raw or as UF2
+const GCRIMG_FLASH_OFFSET = 0x100000;
+if (process.env.C1541_IMAGE) {
+  const image = process.env.C1541_IMAGE;
+  if (image.endsWith('.uf2')) {
+    loadUF2(image, mcu);
+  } else {
+    mcu.flash.set(fs.readFileSync(image), GCRIMG_FLASH_OFFSET);
+  }
+  console.log(`GCR image loaded from ${image}`);
+}
+
 // Set up UART output
 mcu.uart[0].onByte = (value) => {
   process.stdout.write(new Uint8Array([value]));
@@ -113,8 +159,8 @@ mcu.core0.PC = INITIAL_PC;
 // GPIO tracking for IEC signals
 let lastIecState = 0xFF;
 
-function tickC64() {
-  // Read RP2040 IEC GPIO outputs
+// RP2040 IEC outputs in IECLINE_* format (0=active, 1=inactive)
+function readDriveIec() {
   // GPIO value: Low=active (0), High=inactive (1)
   // IEC format uses: 0=active, 1=inactive - same as GPIO direction logic!
   const dataOut  = mcu.gpio[IEC_GPIO_DATA].value !== GPIOPinState.Low;
@@ -128,6 +174,19 @@ function tickC64() {
   if (!clkOut)   iecState &= ~IECLINE_CLK;    // Bit 1
   if (!atnOut)   iecState &= ~IECLINE_ATN;    // Bit 2
   if (!resetOut) iecState &= ~IECLINE_RESET;  // Bit 4
+  return iecState;
+}
+
+// Apply IEC bus state to RP2040 GPIO inputs
+function writeDriveIec(busState) {
+  mcu.gpio[IEC_GPIO_DATA].setInputValue((busState & IECLINE_DATA) !== 0);
+  mcu.gpio[IEC_GPIO_CLK].setInputValue((busState & IECLINE_CLK) !== 0);
+  mcu.gpio[IEC_GPIO_ATN].setInputValue((busState & IECLINE_ATN) !== 0);
+  mcu.gpio[IEC_GPIO_RESET].setInputValue((busState & IECLINE_RESET) !== 0);
+}
+
+function tickC64() {
+  const iecState = readDriveIec();
 
   // Send RP2040's IEC signals to C64
   if (iecState !== lastIecState) {
@@ -138,17 +197,43 @@ function tickC64() {
   c64_tick();
 
   // Get combined IEC bus state (C64 + RP2040)
-  const busState = c64_get_iec();
+  writeDriveIec(c64_get_iec());
+}
 
-  // Apply IEC bus state to RP2040 GPIO inputs
-  mcu.gpio[IEC_GPIO_DATA].setInputValue((busState & IECLINE_DATA) !== 0);
-  mcu.gpio[IEC_GPIO_CLK].setInputValue((busState & IECLINE_CLK) !== 0);
-  mcu.gpio[IEC_GPIO_ATN].setInputValue((busState & IECLINE_ATN) !== 0);
-  mcu.gpio[IEC_GPIO_RESET].setInputValue((busState & IECLINE_RESET) !== 0);
+// C64_COSIM_US=N: batched co-simulation (see c64_cosim_run() in c64_emulation_wrapper.c),
+// one pair of FFI calls per window of up to N drive µs instead of three calls per µs.
+// A window ends early at each RP2040 IEC output edge, where the C64 is rewound to.
+const COSIM_US = parseInt(process.env.C64_COSIM_US || '0');
+const COSIM_END = 0xFFFFFFFF;
+const cosimEdges = new Uint32Array(256);
+let cosimTicks = 0;   // length of the current window
+let cosimTick = 0;    // drive ticks done in the window
+let cosimEdge = 0;    // next C64 edge in cosimEdges
+
+function tickC64Batched() {
+  const iecState = readDriveIec();
+  if ((iecState !== lastIecState) || (cosimTick === cosimTicks)) {
+    c64_cosim_commit(cosimTick, iecState);
+    lastIecState = iecState;
+    cosimTicks = c64_cosim_run(COSIM_US, cosimEdges, cosimEdges.length);
+    cosimTick = 0;
+    cosimEdge = 0;
+  }
+  // C64 bus edge of this tick
+  const edge = cosimEdges[cosimEdge];
+  if ((edge !== COSIM_END) && ((edge >>> 8) === cosimTick)) {
+    writeDriveIec(edge & 0xFF);
+    cosimEdge++;
+  }
+  cosimTick++;
 }
 
 let frameCount = 0;
 
+// C1541_RUN_US=N stops after N drive µs (e.g. for comparable C1541_PROF runs)
+const RUN_US = parseInt(process.env.C1541_RUN_US || '0');
+let driveUs = 0;
+
 function runEmulation() {
   const startTime = Date.now();
 
@@ -163,9 +248,17 @@ function runEmulation() {
     const elapsed = mcu.cycles - startCycles;
 
     if (doTickC64) {
-      tickC64();
+      if (COSIM_US > 0) {
+        tickC64Batched();
+      } else {
+        tickC64();
+      }
       c64TickCount++;
       doTickC64 = false;
+      if ((RUN_US > 0) && (++driveUs >= RUN_US)) {
+        console.log(`Stopped after ${driveUs} drive µs`);
+        process.exit(0);
+      }
     }
 
     cyclesRun += elapsed;
@@ -0,0 +1,75 @@
+#!/bin/bash
+
+# Checks that the C64+C1541 emulation behaves cycle-for-cycle the same on
+# m6502.h and m6502_connomore64.h, and on m6522.h and m6522_fast.h, and
+# with the disk rotor on a second thread (C1541_ENABLE_ROTOR_CORE).
+# The drive of the RP2040 firmware (m6502_c1541.h with m6522_fast.h) can't
+# share a binary with the C64, so it runs alone on the logged C64 IEC
+# outputs of the reference run (c1541_core_equivalence.c).
+# Each C64 variant runs with the per-tick debug callback and on the plain
+# c64_exec() path (-p), which must end in the same state.
+# The default disk is the test demo, so that the LOAD reads a track.
+# Usage: ./run_core_equivalence.sh [-d FILENAME.g64] [-t TICKS]
+
+set -o errexit
+
+disk=../docs/1541_test_demo.g64
+tick_args=()
+while getopts "d:t:" opt; do
+  case $opt in
+    d) disk=$OPTARG ;;
+    t) tick_args=(-t "$OPTARG") ;;
+    *) exit 1 ;;
+  esac
+done
+args=(-d "$disk" "${tick_args[@]}")
+
+. ./fetch_roms.sh
+
+gcc -O2 -o c64_core_equivalence_ref c64_core_equivalence.c $BUILDPARMS
+gcc -O2 -DUSE_CONNOMORE_M6502 -o c64_core_equivalence_fast c64_core_equivalence.c $BUILDPARMS
+gcc -O2 -DUSE_FAST_M6522 -o c64_core_equivalence_via c64_core_equivalence.c $BUILDPARMS
+gcc -O2 -DUSE_ROTOR_CORE -pthread -o c64_core_equivalence_rotor c64_core_equivalence.c $BUILDPARMS
+gcc -O2 -o c1541_core_equivalence_ref c1541_core_equivalence.c $BUILDPARMS
+gcc -O2 -DUSE_C1541_CORE -o c1541_core_equivalence_c1541 c1541_core_equivalence.c $BUILDPARMS
+
+./c64_core_equivalence_ref "${args[@]}" -i core_equivalence_iec.bin > core_equivalence_ref.txt
+./c64_core_equivalence_ref "${args[@]}" -p > core_equivalence_ref_plain.txt
+if [ "$(tail -n 1 core_equivalence_ref.txt)" != "$(tail -n 1 core_equivalence_ref_plain.txt)" ]; then
+  echo "FAIL (plain): c64_exec() without the debug callback ends in another state"
+  tail -n 1 core_equivalence_ref.txt core_equivalence_ref_plain.txt
+  exit 1
+fi
+
+for variant in fast via rotor; do
+  for mode in "" _plain; do
+    if [ -z "$mode" ]; then
+      ./c64_core_equivalence_$variant "${args[@]}" > core_equivalence_$variant.txt
+    else
+      ./c64_core_equivalence_$variant "${args[@]}" -p > core_equivalence_${variant}_plain.txt
+    fi
+    if cmp -s core_equivalence_ref$mode.txt core_equivalence_$variant$mode.txt; then
+      echo "OK ($variant$mode): $(tail -n 1 core_equivalence_ref$mode.txt)"
+    else
+      echo "FAIL ($variant$mode): diverges, first differing report:"
+      diff core_equivalence_ref$mode.txt core_equivalence_$variant$mode.txt | head -n 4
+      exit 1
+    fi
+  done
+done
+
+# the drive alone must end like the drive of the C64 run
+./c1541_core_equivalence_ref -i core_equivalence_iec.bin -d "$disk" > core_equivalence_drive_ref.txt
+drive_ram=$(grep "^ram c64" core_equivalence_ref.txt | awk '{ print $5 }')
+if ! grep -q "^ram 1541 $drive_ram\$" core_equivalence_drive_ref.txt; then
+  echo "FAIL (drive alone): doesn't replay the drive of the C64 run"
+  exit 1
+fi
+./c1541_core_equivalence_c1541 -i core_equivalence_iec.bin -d "$disk" > core_equivalence_drive_c1541.txt
+if cmp -s core_equivalence_drive_ref.txt core_equivalence_drive_c1541.txt; then
+  echo "OK (m6502_c1541): $(grep '^ram 1541' core_equivalence_drive_ref.txt)"
+else
+  echo "FAIL (m6502_c1541): diverges, first differing report:"
+  diff core_equivalence_drive_ref.txt core_equivalence_drive_c1541.txt | head -n 4
+  exit 1
+fi
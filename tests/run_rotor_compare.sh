@@ -0,0 +1,69 @@
+#!/bin/bash
+
+# Measures what running the disk rotor on core 1 (C1541_DUAL_CORE) saves
+# core 0 of the RP2040 firmware. Builds the firmware with the cycle_trace()
+# markers once without and once with C1541_DUAL_CORE, runs both in rp2040js
+# for the same number of drive µs (boot and the LOAD"$",8 of
+# c64_emulation_wrapper.c, on the given disk) and compares the RP2040
+# cycles of core 0 per drive cycle (`tick` markers) and per c1541_tick()
+# (`drive` region). Both builds run the drive cycle for cycle the same
+# (see run_core_equivalence.sh), so both runs do the same drive work.
+# Fails if the split doesn't save core 0 any cycles per drive cycle.
+# Usage: ./run_rotor_compare.sh [-d FILENAME.g64] [-t DRIVE_US]
+
+set -o errexit
+
+disk=../docs/1541_test_demo.g64
+drive_us=3000000
+while getopts "d:t:" opt; do
+  case $opt in
+    d) disk=$OPTARG ;;
+    t) drive_us=$OPTARG ;;
+    *) exit 1 ;;
+  esac
+done
+
+. ./fetch_roms.sh
+
+if [[ ! -d rp2040js ]]; then
+  git clone --depth 1 https://github.com/c1570/rp2040js.git
+  cd rp2040js/
+  npm install
+  npx tsc demo/bootrom.ts --skipLibCheck
+  cd ..
+fi
+npm install
+
+make libc64_emulation.so c1541_gcrimg
+./c1541_gcrimg -u "$disk" rotor_compare.uf2
+
+for cores in single dual; do
+  dual=OFF
+  [ "$cores" = dual ] && dual=ON
+  (cd ../rp2040 && C1541_CYCLE_TRACE=ON C1541_DUAL_CORE=$dual ./build.sh > /dev/null)
+  C1541_PROF=rotor_compare_$cores.jsonl C1541_RUN_US=$drive_us C1541_IMAGE=rotor_compare.uf2 \
+    node rp2_test_runner.js > rotor_compare_$cores.txt
+done
+
+# mean RP2040 cycles of core 0 per drive cycle and per c1541_tick()
+node -e '
+const fs = require("fs");
+const mean = (cores, kind, name) => {
+  const line = fs.readFileSync(`rotor_compare_${cores}.jsonl`, "utf-8").split("\n")
+    .filter((l) => l).map((l) => JSON.parse(l)).find((h) => (h.kind === kind) && (h.name === name));
+  if (!line) throw new Error(`no ${kind} ${name} in the ${cores} core profile`);
+  return line.mean;
+};
+const rows = [["tick", "interval", "tick"], ["drive", "region", "drive"]].map(([label, kind, name]) => {
+  const single = mean("single", kind, name);
+  const dual = mean("dual", kind, name);
+  console.log(`${label.padEnd(6)} single core ${single.toFixed(1).padStart(7)}  dual core ${dual.toFixed(1).padStart(7)}  ` +
+    `saved ${(single - dual).toFixed(1).padStart(6)} cycles (${(100 * (single - dual) / single).toFixed(1)}%)`);
+  return single - dual;
+});
+if (rows[0] <= 0) {
+  console.log("FAIL: the rotor on core 1 saves core 0 no cycles per drive cycle");
+  process.exit(1);
+}
+console.log("OK");
+'
@@ -0,0 +1,950 @@
+/*
+    trace_diff.c
+
+    Streaming replacement for convert_to_canonical_trace.py and
+    gist_trace.py which also compares two traces.
+
+    Reads binary traces (systems/trace.h), RP2 text traces (`.C:`/`.8:`),
+    VICE text traces and canonical traces, everything is processed line by
+    line in constant memory.
+
+    With one trace, prints it in canonical format (or its gist with -g).
+    With two traces, reports the first difference with context lines.
+    Instructions are compared by address, opcode bytes and A/X/Y/SP (the
+    mnemonic text differs between disassemblers, cycles between emulators,
+    use -y to compare cycles too), gists are compared by their event text.
+    Stashes (ENTER/LEAVE) longer than MAX_ENTRY are shown truncated but
+    compared by a hash of their full text. More than GIST_MAX_DEPTH nested
+    stashes are an error, as is printing a truncated stash.
+
+    Build: make tools (in tests)
+    Usage: trace_diff [options] TRACE [TRACE]
+        -g      use the gist (address->event map of gist_trace.py)
+        -d DEV  only use instructions of device C (C64) or 8 (1541)
+        -n N    number of context lines (default 10)
+        -y      also compare cycles
+        -l      gist: include line numbers
+        -c      gist: include cycles
+        -a      gist: annotate events with cycles in C++ style comments
+        -G N    gist: insert marker after N instructions with no events
+
+    Returns 0 if the traces match, 1 if they differ, 2 on errors.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#define CHIPS_IMPL
+#include "../../systems/trace.h"
+#include "../../systems/disass.h"
+
+#define C64_FREQUENCY (985248)
+#define MAX_LINE (512)
+#define MAX_TOKENS (32)
+#define MAX_ENTRY (1024)
+#define GIST_MAX_DEPTH (32)
+
+typedef enum {
+    FORMAT_UNKNOWN,
+    FORMAT_BINARY,
+    FORMAT_RP2,
+    FORMAT_VICE,
+    FORMAT_CANON,
+} format_t;
+
+// one instruction, normalized from any trace format
+typedef struct {
+    char device;            // 'C', '8' or 0 if unknown
+    char addr[8];           // uppercase hex as in the trace
+    uint16_t pc;
+    uint8_t bytes[3];
+    int num_bytes;
+    uint8_t a, x, y, sp;
+    char opcodes[16];
+    char mnemonic[32];
+    char cycle[24];
+} instr_t;
+
+typedef enum {
+    READ_EOF,
+    READ_INSTR,
+    READ_UNPARSED,          // line which isn't an instruction (see reader_t.raw)
+} read_result_t;
+
+typedef struct {
+    const char* name;
+    FILE* fp;
+    format_t format;
+    uint64_t line;          // line (or record) number of the last instruction
+    char raw[MAX_LINE];
+    char work[MAX_LINE];
+} reader_t;
+
+// stash of the gist (ENTER/LEAVE events)
+typedef struct {
+    const char* enter_event;
+    const char* matching_leave;
+    char cycle[24];
+    char events[MAX_ENTRY];
+    size_t len;
+    size_t full_len;        // untruncated length of events
+    uint64_t hash;          // of the untruncated events
+} gist_frame_t;
+
+typedef struct {
+    bool show_line;
+    bool show_cycle;
+    bool annotate;
+    bool compare;           // leave out line numbers in gap markers
+    uint64_t gap;
+    uint64_t since_last_event;
+    int depth;
+    bool overflow;          // more than GIST_MAX_DEPTH nested stashes
+    bool flushed;           // unresolved stashes emitted at the end
+    uint64_t num_truncated; // emitted stashes longer than MAX_ENTRY
+    gist_frame_t stack[GIST_MAX_DEPTH];
+} gist_t;
+
+// one line of output (canonical instruction or gist event)
+typedef struct {
+    char text[MAX_ENTRY];
+    uint64_t line;
+    bool has_instr;
+    instr_t instr;
+    size_t full_len;        // gist stash: untruncated text length, 0 otherwise
+    uint64_t hash;          // gist stash: hash of the untruncated text
+} entry_t;
+
+typedef struct {
+    reader_t reader;
+    bool use_gist;
+    gist_t gist;
+    entry_t pending[GIST_MAX_DEPTH + 2];    // gist lines from one instruction, unresolved stashes at the end
+    int num_pending;
+    int pending_pos;
+    uint64_t num_entries;
+} source_t;
+
+static char device_filter = 0;
+static bool compare_cycles = false;
+
+/*-- address -> event map of gist_trace.py ----------------------------------*/
+typedef struct {
+    uint16_t addr;
+    const char* event;
+    bool stash;             // ENTER/LEAVE event
+    const char* leave;      // matching leave event of an ENTER event
+} gist_event_t;
+
+static const gist_event_t gist_events[] = {
+    { 0x0718, "TRANSWARP_READ_1800_1_ACCU" },
+    { 0x071E, "TRANSWARP_READ_1800_2_ACCU" },
+    { 0x0724, "TRANSWARP_READ_1800_3_ACCU" },
+    { 0x072B, "TRANSWARP_READ_1800_4_ACCU" },
+    { 0x0754, "TRANSWARP_READ_1C01_1_YREG" },
+    { 0x0756, "TRANSWARP_WRITE_TO_DRIVEMEM_1_ACCU" },
+    { 0x0768, "TRANSWARP_READ_1C01_2_YREG" },
+    { 0x075E, "TRANSWARP_WRITE_TO_DRIVEMEM_2_ACCU" },
+    { 0x077C, "TRANSWARP_READ_1C01_3_ACCU" },
+    { 0x0770, "TRANSWARP_WRITE_TO_DRIVEMEM_3_ACCU" },
+    { 0x0776, "TRANSWARP_WRITE_TO_DRIVEMEM_4_ACCU" },
+    { 0x078B, "TRANSWARP_READ_1C01_4_ACCU" },
+    { 0x0785, "TRANSWARP_WRITE_TO_DRIVEMEM_5_ACCU" },
+    { 0x0798, "TRANSWARP_READ_1C01_5_ACCU" },
+    { 0x078C, "TRANSWARP_WRITE_TO_DRIVEMEM_6_ACCU" },
+    { 0x0792, "TRANSWARP_WRITE_TO_DRIVEMEM_7_ACCU" },
+    { 0x079A, "TRANSWARP_WRITE_TO_DRIVEMEM_8_ACCU" },
+    { 0xF363, "EXECUTE_JOB_ACCU" },
+    { 0xF502, "CHECKSUM_FAIL" },
+    { 0xF505, "CHECKSUM_OK" },
+    { 0xF54D, "TRACK_AND_SECTOR_FOUND_FOR_READ" },
+    { 0xF553, "ERROR" },
+    { 0xF556, "WAIT_FOR_SYNC" },
+    { 0xF6FB, "DECODE_GCR_BYTE_1_ACCU" },
+    { 0xF722, "DECODE_GCR_BYTE_2_ACCU" },
+    { 0xF766, "DECODE_GCR_BYTE_3_ACCU" },
+    { 0xF779, "DECODE_GCR_BYTE_4_ACCU" },
+    { 0xFE73, "NOTE_ATNRQ_IN_IRQ" },
+    { 0xFE7C, "DISK_CTRL_TIMER_FIRED" },
+    { 0xEBE7, "IDLE" },
+    { 0xEC04, "IDLE_TO_ATNSRV" },
+    { 0xEBFC, "IDLE_TO_PARSECMD" },
+    { 0xEC1D, "IDLE_HAVE_ACTIVE_FILE" },
+    { 0xEA2D, "GOT_IEC_BYTE_ACPTR_ACCU" },
+    { 0xEA2E, "LISTEN" },
+    { 0xD09B, "STRRD_START_READING_AHEAD" },
+    { 0xD0AE, "STRRD_FINISHED_READING_AHEAD" },
+    { 0xD585, "JOB_SET_UP" },
+    { 0xD586, "DOREAD_JOB" },
+    { 0xD58A, "DOWRITE_JOB" },
+    { 0xD5A5, "WAITJOB_DONE" },
+    { 0xD155, "GETBYT_FROM_BUFFER_DONE_ACCU" },
+    { 0xC160, "OPEN_SEC_ADDR_15" },
+    { 0xC191, "JUMP_INDIR_TO_COMMAND" },
+    { 0xCB1D, "MEMORY_EXECUTE_COMMAND" },
+    { 0xCB20, "MEMORY_READ_COMMAND" },
+    { 0xCB50, "MEMORY_WRITE_COMMAND" },
+    { 0xDC46, "OPNRCH_OPEN_READ_CHANNEL" },
+    { 0xDCB5, "DONE_OPNRCH_OPEN_READ_CHANNEL" },
+    { 0xD7CB, "LOADLASTPROGRAM" },
+    { 0xD7F7, "LOADDIR" },
+    { 0xD819, "OPENBLK" },
+    { 0xD82B, "UNKNOWN_TODOXXX" },
+    { 0xE85B, "SERVICE_ATN" },
+    // stash entries: event at this address, matching leave event
+    { 0xFE67, "ENTER_SYSIRQ", true, "LEAVE_SYSIRQ" },
+    { 0xFE84, "LEAVE_SYSIRQ", true, 0 },
+    { 0xE95A, "ENTER_START_SEND_IEC_BYTE", true, "LEAVE_START_SEND_IEC_BYTE_ACCU" },
+    { 0xE968, "LEAVE_START_SEND_IEC_BYTE_ACCU", true, 0 },
+};
+
+// index+1 into gist_events by address
+static uint8_t gist_map[0x10000];
+
+static void gist_init_map(void) {
+    for (size_t i = 0; i < sizeof(gist_events) / sizeof(gist_events[0]); i++) {
+        gist_map[gist_events[i].addr] = (uint8_t)(i + 1);
+    }
+}
+
+/*-- trace parsing -----------------------------------------------------------*/
+static inline bool is_blank(char c) {
+    return (c == ' ') || (c == '\t');
+}
+
+static int tokenize(char* str, char* tokens[]) {
+    int num = 0;
+    char* p = str;
+    while (num < MAX_TOKENS) {
+        while (is_blank(*p)) {
+            p++;
+        }
+        if (!*p) {
+            break;
+        }
+        tokens[num++] = p;
+        while (*p && !is_blank(*p)) {
+            p++;
+        }
+        if (*p) {
+            *p++ = 0;
+        }
+    }
+    return num;
+}
+
+static bool is_hex(const char* str, size_t len) {
+    if (strlen(str) != len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (!isxdigit((unsigned char)str[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline int hex_digit(char c) {
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+    if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    return -1;
+}
+
+// 1 or 2 hex digits
+static bool parse_hex8(const char* str, uint8_t* val) {
+    int hi = hex_digit(str[0]);
+    if (hi < 0) {
+        return false;
+    } else if (!str[1]) {
+        *val = (uint8_t)hi;
+        return true;
+    }
+    int lo = hex_digit(str[1]);
+    if ((lo < 0) || str[2]) {
+        return false;
+    }
+    *val = (uint8_t)((hi << 4) | lo);
+    return true;
+}
+
+static void copy_str(char* dst, size_t size, const char* src) {
+    size_t len = strlen(src);
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(dst, src, len);
+    dst[len] = 0;
+}
+
+static void set_addr(instr_t* instr, const char* str) {
+    copy_str(instr->addr, sizeof(instr->addr), str);
+    instr->pc = 0;
+    for (char* p = instr->addr; *p; p++) {
+        *p = (char)toupper((unsigned char)*p);
+        instr->pc = (uint16_t)((instr->pc << 4) | (hex_digit(*p) & 0xF));
+    }
+}
+
+// ASL/LSR/ROL/ROR/INC/DEC/LDA without operand -> "ASL A" etc
+static void canonicalize_mnemonic(char* mnemonic, size_t size) {
+    static const char* acc_ops[] = { "ASL", "LSR", "ROL", "ROR", "INC", "DEC", "LDA" };
+    for (size_t i = 0; i < sizeof(acc_ops) / sizeof(acc_ops[0]); i++) {
+        if (0 == strcmp(mnemonic, acc_ops[i])) {
+            snprintf(mnemonic, size, "%s A", acc_ops[i]);
+            return;
+        }
+    }
+}
+
+// append a space separated word, truncates
+static size_t append_word(char* buf, size_t len, size_t size, const char* word) {
+    if (len && (len < size - 1)) {
+        buf[len++] = ' ';
+    }
+    while (*word && (len < size - 1)) {
+        buf[len++] = *word++;
+    }
+    buf[len] = 0;
+    return len;
+}
+
+// opcode bytes followed by the mnemonic
+static void parse_opcodes(instr_t* instr, char* tokens[], int num) {
+    int i = 0;
+    size_t len = 0;
+    instr->opcodes[0] = 0;
+    instr->num_bytes = 0;
+    for (; (i < num) && is_hex(tokens[i], 2); i++) {
+        if (instr->num_bytes < 3) {
+            parse_hex8(tokens[i], &instr->bytes[instr->num_bytes++]);
+        }
+        len = append_word(instr->opcodes, len, sizeof(instr->opcodes), tokens[i]);
+    }
+    len = 0;
+    instr->mnemonic[0] = 0;
+    for (; i < num; i++) {
+        len = append_word(instr->mnemonic, len, sizeof(instr->mnemonic), tokens[i]);
+    }
+    canonicalize_mnemonic(instr->mnemonic, sizeof(instr->mnemonic));
+}
+
+// cycle count, optionally with one decimal point
+static bool is_cycle(const char* str) {
+    bool dot = false;
+    if (!*str) {
+        return false;
+    }
+    for (; *str; str++) {
+        if (*str == '.' && !dot) {
+            dot = true;
+        } else if ((*str < '0') || (*str > '9')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// .C:ed24  20 97 EE    JSR $EE97      A:28 X:01 Y:01 SP:f3 ..-..I.C       199047
+static bool parse_rp2(char* line, instr_t* instr) {
+    if ((line[0] != '.') || ((line[1] != 'C') && (line[1] != '8')) || (line[2] != ':')) {
+        return false;
+    }
+    char* a_pos = strstr(line, " A:");
+    if (!a_pos) {
+        return false;
+    }
+    *a_pos = 0;
+    char* tokens[MAX_TOKENS];
+    int num = tokenize(line + 3, tokens);
+    if (num < 2) {
+        return false;
+    }
+    instr->device = line[1];
+    set_addr(instr, tokens[0]);
+    parse_opcodes(instr, tokens + 1, num - 1);
+    num = tokenize(a_pos + 3, tokens);
+    if ((num < 5) || !parse_hex8(tokens[0], &instr->a)) {
+        return false;
+    }
+    instr->x = instr->y = instr->sp = 0;
+    instr->cycle[0] = 0;
+    for (int i = 1; i < num; i++) {
+        if (0 == strncmp(tokens[i], "X:", 2)) {
+            parse_hex8(tokens[i] + 2, &instr->x);
+        } else if (0 == strncmp(tokens[i], "Y:", 2)) {
+            parse_hex8(tokens[i] + 2, &instr->y);
+        } else if (0 == strncmp(tokens[i], "SP:", 3)) {
+            parse_hex8(tokens[i] + 3, &instr->sp);
+        } else if (is_cycle(tokens[i])) {
+            copy_str(instr->cycle, sizeof(instr->cycle), tokens[i]);
+        }
+    }
+    return true;
+}
+
+// .ED24 191 029    3137366  20 97 EE    JSR $EE97  280101f3
+static bool parse_vice(char* line, instr_t* instr) {
+    char tmp[MAX_LINE];
+    instr->device = 'C';
+    if (0 == strncmp(line, "Drive  8:", 9)) {
+        const size_t len = strlen(line);
+        snprintf(tmp, sizeof(tmp), "%.6s 0 0 %s", line + 9, (len > 16) ? line + 16 : "");
+        strcpy(line, tmp);
+        instr->device = '8';
+    }
+    if (line[0] != '.') {
+        return false;
+    }
+    line++;
+    char* packed = strrchr(line, ' ');
+    if (!packed) {
+        return false;
+    }
+    *packed++ = 0;
+    if (!is_hex(packed, 8)) {
+        return false;
+    }
+    uint8_t regs[4];
+    for (int i = 0; i < 4; i++) {
+        regs[i] = (uint8_t)((hex_digit(packed[i * 2]) << 4) | hex_digit(packed[i * 2 + 1]));
+    }
+    char* tokens[MAX_TOKENS];
+    int num = tokenize(line, tokens);
+    if (num < 5) {
+        return false;
+    }
+    set_addr(instr, tokens[0]);
+    // tokens 1 and 2 are raster line and cycle in line
+    copy_str(instr->cycle, sizeof(instr->cycle), tokens[3]);
+    parse_opcodes(instr, tokens + 4, num - 4);
+    instr->a = regs[0];
+    instr->x = regs[1];
+    instr->y = regs[2];
+    instr->sp = regs[3];
+    return true;
+}
+
+// ED24  20 97 EE      JSR $EE97      A:28 X:01 Y:01 SP:F3 CYC:199047
+static bool parse_canon(char* line, instr_t* instr) {
+    char* tokens[MAX_TOKENS];
+    int num = tokenize(line, tokens);
+    if ((num < 2) || !is_hex(tokens[0], 4)) {
+        return false;
+    }
+    int a_idx = 1;
+    while ((a_idx < num) && strncmp(tokens[a_idx], "A:", 2)) {
+        a_idx++;
+    }
+    if ((a_idx + 4) > num) {
+        return false;
+    }
+    instr->device = 0;
+    set_addr(instr, tokens[0]);
+    parse_opcodes(instr, tokens + 1, a_idx - 1);
+    instr->cycle[0] = 0;
+    bool ok = parse_hex8(tokens[a_idx] + 2, &instr->a);
+    for (int i = a_idx + 1; i < num; i++) {
+        if (0 == strncmp(tokens[i], "X:", 2)) {
+            ok &= parse_hex8(tokens[i] + 2, &instr->x);
+        } else if (0 == strncmp(tokens[i], "Y:", 2)) {
+            ok &= parse_hex8(tokens[i] + 2, &instr->y);
+        } else if (0 == strncmp(tokens[i], "SP:", 3)) {
+            ok &= parse_hex8(tokens[i] + 3, &instr->sp);
+        } else if (0 == strncmp(tokens[i], "CYC:", 4)) {
+            copy_str(instr->cycle, sizeof(instr->cycle), tokens[i] + 4);
+        }
+    }
+    return ok;
+}
+
+static format_t detect_text_format(const char* line) {
+    if ((0 == strncmp(line, ".C:", 3)) || (0 == strncmp(line, ".8:", 3))) {
+        return FORMAT_RP2;
+    } else if ((line[0] == '.') || (0 == strncmp(line, "Drive", 5))) {
+        return FORMAT_VICE;
+    } else if ((strlen(line) > 4) && is_hex((char[5]){ line[0], line[1], line[2], line[3], 0 }, 4) && isspace((unsigned char)line[4])) {
+        return FORMAT_CANON;
+    }
+    return FORMAT_UNKNOWN;
+}
+
+/*-- trace reader ------------------------------------------------------------*/
+static bool reader_open(reader_t* r, const char* name) {
+    memset(r, 0, sizeof(*r));
+    r->name = name;
+    r->fp = fopen(name, "rb");
+    if (!r->fp) {
+        fprintf(stderr, "Failed to open %s\n", name);
+        return false;
+    }
+    setvbuf(r->fp, 0, _IOFBF, 1 << 20);
+    char magic[8];
+    if ((1 == fread(magic, sizeof(magic), 1, r->fp)) && (0 == memcmp(magic, TRACE_FILE_MAGIC, sizeof(magic)))) {
+        rewind(r->fp);
+        if (!trace_read_header(r->fp)) {
+            fprintf(stderr, "%s: wrong trace file version\n", name);
+            return false;
+        }
+        r->format = FORMAT_BINARY;
+    } else {
+        // text format is detected on the first non-empty line
+        rewind(r->fp);
+    }
+    return true;
+}
+
+static void reader_close(reader_t* r) {
+    if (r->fp) {
+        fclose(r->fp);
+        r->fp = 0;
+    }
+}
+
+static bool read_line(reader_t* r) {
+    if (!fgets(r->raw, sizeof(r->raw), r->fp)) {
+        return false;
+    }
+    size_t len = strlen(r->raw);
+    if ((len > 0) && (r->raw[len - 1] != '\n')) {
+        // skip the rest of an overlong line
+        int c;
+        while (((c = fgetc(r->fp)) != EOF) && (c != '\n'));
+    }
+    while ((len > 0) && ((r->raw[len - 1] == '\n') || (r->raw[len - 1] == '\r'))) {
+        r->raw[--len] = 0;
+    }
+    r->line++;
+    return true;
+}
+
+static read_result_t reader_next(reader_t* r, instr_t* instr) {
+    while (true) {
+        if (r->format == FORMAT_BINARY) {
+            trace_record_t rec;
+            if (1 != fread(&rec, sizeof(rec), 1, r->fp)) {
+                return READ_EOF;
+            }
+            r->line++;
+            double timestamp = (double)rec.cycle;
+            if (rec.device == TRACE_DEVICE_C64) {
+                timestamp = (double)rec.cycle * 1000000.0 / C64_FREQUENCY;
+            }
+            // same text as trace_format, parsed back like an RP2 trace
+            _disass_trace_line(r->raw, sizeof(r->raw), (char)rec.device, rec.pc, rec.a, rec.x, rec.y, rec.s, rec.p,
+                rec.bytes[0], rec.bytes[1], rec.bytes[2], timestamp);
+            r->raw[strcspn(r->raw, "\n")] = 0;
+        } else if (!read_line(r)) {
+            return READ_EOF;
+        } else if (r->format == FORMAT_UNKNOWN) {
+            // lines in front of the first trace line are kept as unparsed
+            r->format = detect_text_format(r->raw);
+            if (r->format == FORMAT_UNKNOWN) {
+                return READ_UNPARSED;
+            }
+        }
+        strcpy(r->work, r->raw);
+        bool ok = false;
+        switch (r->format) {
+            case FORMAT_BINARY:
+            case FORMAT_RP2:    ok = parse_rp2(r->work, instr); break;
+            case FORMAT_VICE:   ok = parse_vice(r->work, instr); break;
+            case FORMAT_CANON:  ok = parse_canon(r->work, instr); break;
+            default: break;
+        }
+        if (!ok) {
+            return READ_UNPARSED;
+        }
+        if (device_filter && instr->device && (instr->device != device_filter)) {
+            continue;
+        }
+        return READ_INSTR;
+    }
+}
+
+static void format_canon(char* buf, size_t size, const instr_t* instr) {
+    snprintf(buf, size, "%s  %-12s  %-13s  A:%02X X:%02X Y:%02X SP:%02X CYC:%s",
+        instr->addr, instr->opcodes, instr->mnemonic, instr->a, instr->x, instr->y, instr->sp, instr->cycle);
+}
+
+/*-- gist --------------------------------------------------------------------*/
+static void gist_format_event(const gist_t* g, char* buf, size_t size, const char* event, const instr_t* instr, uint64_t line) {
+    size_t len = strlen(event);
+    int n;
+    if ((len > 5) && (0 == strcmp(event + len - 5, "_ACCU"))) {
+        n = snprintf(buf, size, "%s:0x%02X (%s)", event, instr->a, instr->addr);
+    } else if ((len > 5) && (0 == strcmp(event + len - 5, "_YREG"))) {
+        n = snprintf(buf, size, "%s:0x%02X (%s)", event, instr->y, instr->addr);
+    } else if ((len > 5) && (0 == strcmp(event + len - 5, "_XREG"))) {
+        n = snprintf(buf, size, "%s:0x%02X (%s)", event, instr->x, instr->addr);
+    } else {
+        n = snprintf(buf, size, "%s (%s)", event, instr->addr);
+    }
+    if (g->show_line && (n < (int)size)) {
+        n += snprintf(buf + n, size - n, " line:%llu", (unsigned long long)line);
+    }
+    if (g->show_cycle && (n < (int)size)) {
+        snprintf(buf + n, size - n, " cycle:%s", instr->cycle);
+    }
+}
+
+// FNV-1a
+static uint64_t hash_str(uint64_t hash, const char* str) {
+    for (; *str; str++) {
+        hash = (hash ^ (uint8_t)*str) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static void gist_frame_append(gist_frame_t* frame, const char* str) {
+    if (frame->full_len) {
+        frame->hash = hash_str(frame->hash, ", ");
+        frame->full_len += 2;
+    }
+    frame->hash = hash_str(frame->hash, str);
+    frame->full_len += strlen(str);
+    if (frame->len >= sizeof(frame->events) - 1) {
+        return;
+    }
+    int n = snprintf(frame->events + frame->len, sizeof(frame->events) - frame->len, "%s%s", frame->len ? ", " : "", str);
+    frame->len += n;
+    if (frame->len >= sizeof(frame->events) - 1) {
+        // truncated, mark it
+        frame->len = sizeof(frame->events) - 1;
+        memcpy(frame->events + frame->len - 3, "...", 3);
+    }
+}
+
+static entry_t* gist_emit(source_t* src, uint64_t line) {
+    entry_t* e = &src->pending[src->num_pending++];
+    e->line = line;
+    e->has_instr = false;
+    e->full_len = 0;
+    e->hash = 0;
+    return e;
+}
+
+// complete stash text, counts truncated ones
+static void gist_emit_frame(source_t* src, const gist_frame_t* frame, uint64_t line) {
+    entry_t* e = gist_emit(src, line);
+    snprintf(e->text, sizeof(e->text), "%s", frame->events);
+    e->full_len = frame->full_len;
+    e->hash = frame->hash;
+    if (frame->full_len >= sizeof(frame->events) - 1) {
+        src->gist.num_truncated++;
+    }
+}
+
+// unresolved stashes at the end of the trace
+static void gist_flush(source_t* src) {
+    gist_t* g = &src->gist;
+    g->flushed = true;
+    if (!g->depth) {
+        return;
+    }
+    snprintf(gist_emit(src, src->reader.line)->text, MAX_ENTRY, "%s!!! Unresolved stack entries!", g->compare ? "" : "\n\n");
+    for (int i = 0; i < g->depth; i++) {
+        gist_emit_frame(src, &g->stack[i], src->reader.line);
+    }
+}
+
+// feed one instruction into the gist, adds 0..2 pending entries
+static void gist_step(source_t* src, const instr_t* instr, uint64_t line) {
+    gist_t* g = &src->gist;
+    char event_str[MAX_ENTRY];
+    g->since_last_event++;
+    const int idx = gist_map[instr->pc];
+    if (!is_hex(instr->addr, 4) || !idx) {
+        if (g->gap && (g->since_last_event >= g->gap)) {
+            entry_t* e = gist_emit(src, line);
+            if (g->compare) {
+                snprintf(e->text, sizeof(e->text), "// (%llu instructions with no events)", (unsigned long long)g->gap);
+            } else {
+                snprintf(e->text, sizeof(e->text), "// (%llu instructions with no events) line:%llu cycle:%s",
+                    (unsigned long long)g->gap, (unsigned long long)line, instr->cycle);
+            }
+            g->since_last_event = 0;
+        }
+        return;
+    }
+    g->since_last_event = 0;
+    const gist_event_t* ev = &gist_events[idx - 1];
+    gist_format_event(g, event_str, sizeof(event_str), ev->event, instr, line);
+    gist_frame_t* top = g->depth ? &g->stack[g->depth - 1] : 0;
+    if (ev->stash) {
+        if (!ev->leave && top && (0 == strcmp(top->matching_leave, ev->event))) {
+            // leave event of the newest stash entry, close it
+            gist_frame_append(top, event_str);
+            g->depth--;
+            if (g->annotate) {
+                snprintf(gist_emit(src, line)->text, MAX_ENTRY, "// cycle %s", top->cycle);
+            }
+            gist_emit_frame(src, top, line);
+        } else if (ev->leave && (!top || strcmp(top->enter_event, ev->event))) {
+            if (g->depth == GIST_MAX_DEPTH) {
+                // ENTER without LEAVE too often, the gist can't follow gist_trace.py
+                g->overflow = true;
+                return;
+            }
+            // open new stash
+            gist_frame_t* frame = &g->stack[g->depth++];
+            frame->enter_event = ev->event;
+            frame->matching_leave = ev->leave;
+            snprintf(frame->cycle, sizeof(frame->cycle), "%s", instr->cycle);
+            frame->len = 0;
+            frame->full_len = 0;
+            frame->hash = 0xCBF29CE484222325ULL;
+            frame->events[0] = 0;
+            gist_frame_append(frame, event_str);
+        }
+    } else if (top) {
+        gist_frame_append(top, event_str);
+    } else {
+        if (g->annotate) {
+            snprintf(gist_emit(src, line)->text, MAX_ENTRY, "// cycle %s", instr->cycle);
+        }
+        snprintf(gist_emit(src, line)->text, MAX_ENTRY, "%s", event_str);
+    }
+}
+
+/*-- sources of entries ------------------------------------------------------*/
+// keep_unparsed: return non-instruction lines as "# line" (canonical output only)
+static bool source_next(source_t* src, entry_t* e, bool keep_unparsed) {
+    while (true) {
+        if (src->pending_pos < src->num_pending) {
+            *e = src->pending[src->pending_pos++];
+            src->num_entries++;
+            return true;
+        }
+        src->num_pending = src->pending_pos = 0;
+        instr_t instr;
+        read_result_t res = reader_next(&src->reader, &instr);
+        if (res == READ_EOF) {
+            if (src->use_gist && !src->gist.flushed) {
+                gist_flush(src);
+                continue;
+            }
+            if (src->reader.format == FORMAT_UNKNOWN) {
+                fprintf(stderr, "%s: could not detect trace format\n", src->reader.name);
+            }
+            return false;
+        } else if (res == READ_UNPARSED) {
+            if (keep_unparsed && !src->use_gist) {
+                snprintf(e->text, sizeof(e->text), "# %s", src->reader.raw);
+                e->line = src->reader.line;
+                e->has_instr = false;
+                src->num_entries++;
+                return true;
+            }
+        } else if (src->use_gist) {
+            gist_step(src, &instr, src->reader.line);
+        } else {
+            // text is formatted on output
+            e->line = src->reader.line;
+            e->has_instr = true;
+            e->instr = instr;
+            src->num_entries++;
+            return true;
+        }
+    }
+}
+
+static bool entries_equal(const entry_t* a, const entry_t* b) {
+    if (a->has_instr && b->has_instr) {
+        const instr_t* ia = &a->instr;
+        const instr_t* ib = &b->instr;
+        return (0 == strcmp(ia->addr, ib->addr)) &&
+               (ia->num_bytes == ib->num_bytes) &&
+               (0 == memcmp(ia->bytes, ib->bytes, ia->num_bytes)) &&
+               (ia->a == ib->a) && (ia->x == ib->x) && (ia->y == ib->y) && (ia->sp == ib->sp) &&
+               (!compare_cycles || (0 == strcmp(ia->cycle, ib->cycle)));
+    }
+    return (a->full_len == b->full_len) && (a->hash == b->hash) && (0 == strcmp(a->text, b->text));
+}
+
+static void print_differences(const entry_t* a, const entry_t* b) {
+    if (!a->has_instr && !b->has_instr && (0 == strcmp(a->text, b->text))) {
+        printf("differs in: stash text after the first %d characters\n", MAX_ENTRY - 1);
+        return;
+    }
+    if (!a->has_instr || !b->has_instr) {
+        return;
+    }
+    const instr_t* ia = &a->instr;
+    const instr_t* ib = &b->instr;
+    printf("differs in:");
+    if (strcmp(ia->addr, ib->addr)) printf(" PC");
+    if ((ia->num_bytes != ib->num_bytes) || memcmp(ia->bytes, ib->bytes, ia->num_bytes)) printf(" opcodes");
+    if (ia->a != ib->a) printf(" A");
+    if (ia->x != ib->x) printf(" X");
+    if (ia->y != ib->y) printf(" Y");
+    if (ia->sp != ib->sp) printf(" SP");
+    if (compare_cycles && strcmp(ia->cycle, ib->cycle)) printf(" cycle");
+    printf("\n");
+}
+
+static const char* entry_text(entry_t* e) {
+    if (e->has_instr) {
+        format_canon(e->text, sizeof(e->text), &e->instr);
+    }
+    return e->text;
+}
+
+static void print_entry(char prefix, entry_t* e) {
+    printf("%c %8llu: %s\n", prefix, (unsigned long long)e->line, entry_text(e));
+}
+
+/*-- main --------------------------------------------------------------------*/
+// gist errors which make the output differ from gist_trace.py
+static bool gist_failed(const source_t* src) {
+    if (src->gist.overflow) {
+        fprintf(stderr, "%s: more than %d nested gist stashes\n", src->reader.name, GIST_MAX_DEPTH);
+        return true;
+    }
+    return false;
+}
+
+static int print_trace(source_t* src) {
+    entry_t e;
+    while (source_next(src, &e, true)) {
+        puts(entry_text(&e));
+        if (gist_failed(src)) {
+            return 2;
+        }
+    }
+    if (src->gist.num_truncated) {
+        fprintf(stderr, "%s: %llu gist stashes truncated to %d characters\n",
+            src->reader.name, (unsigned long long)src->gist.num_truncated, MAX_ENTRY - 1);
+        return 2;
+    }
+    return 0;
+}
+
+static int diff_traces(source_t* a, source_t* b, int context) {
+    // ring buffer of the last matching entries of trace A
+    entry_t* ring = (entry_t*) calloc(context + 1, sizeof(entry_t));
+    entry_t ea, eb;
+    uint64_t num = 0;
+    while (true) {
+        bool has_a = source_next(a, &ea, false);
+        bool has_b = source_next(b, &eb, false);
+        if (gist_failed(a) || gist_failed(b)) {
+            free(ring);
+            return 2;
+        }
+        if (!has_a && !has_b) {
+            printf("no differences in %llu entries\n", (unsigned long long)num);
+            free(ring);
+            return 0;
+        }
+        if (has_a && has_b && entries_equal(&ea, &eb)) {
+            if (context > 0) {
+                ring[num % context] = ea;
+            }
+            num++;
+            continue;
+        }
+        printf("first difference at entry %llu\n", (unsigned long long)(num + 1));
+        if (has_a && has_b) {
+            print_differences(&ea, &eb);
+        }
+        printf("--- %s\n+++ %s\n", a->reader.name, b->reader.name);
+        const uint64_t first = (num > (uint64_t)context) ? (num - context) : 0;
+        for (uint64_t i = first; i < num; i++) {
+            print_entry(' ', &ring[i % context]);
+        }
+        if (has_a) {
+            print_entry('-', &ea);
+            for (int i = 0; (i < context) && source_next(a, &ea, false); i++) {
+                print_entry('-', &ea);
+            }
+        } else {
+            printf("- <end of trace>\n");
+        }
+        if (has_b) {
+            print_entry('+', &eb);
+            for (int i = 0; (i < context) && source_next(b, &eb, false); i++) {
+                print_entry('+', &eb);
+            }
+        } else {
+            printf("+ <end of trace>\n");
+        }
+        free(ring);
+        return 1;
+    }
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+        "Usage: %s [options] TRACE [TRACE]\n"
+        "  one trace: print it in canonical format (or its gist)\n"
+        "  two traces: report the first difference\n"
+        "  -g      use the gist (address->event map of gist_trace.py)\n"
+        "  -d DEV  only use instructions of device C (C64) or 8 (1541)\n"
+        "  -n N    number of context lines (default 10)\n"
+        "  -y      also compare cycles\n"
+        "  -l      gist: include line numbers\n"
+        "  -c      gist: include cycles\n"
+        "  -a      gist: annotate events with cycles in C++ style comments\n"
+        "  -G N    gist: insert marker after N instructions with no events\n",
+        name);
+}
+
+static source_t sources[2];
+
+int main(int argc, char* argv[]) {
+    const char* filenames[2] = { 0 };
+    int num_files = 0;
+    int context = 10;
+    bool use_gist = false;
+    gist_t gist = { 0 };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-g") == 0) {
+            use_gist = true;
+        } else if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc)) {
+            device_filter = argv[++i][0];
+        } else if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) {
+            context = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-y") == 0) {
+            compare_cycles = true;
+        } else if (strcmp(argv[i], "-l") == 0) {
+            gist.show_line = true;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            gist.show_cycle = true;
+        } else if (strcmp(argv[i], "-a") == 0) {
+            gist.annotate = true;
+        } else if ((strcmp(argv[i], "-G") == 0) && (i + 1 < argc)) {
+            gist.gap = strtoull(argv[++i], 0, 10);
+        } else if ((argv[i][0] != '-') && (num_files < 2)) {
+            filenames[num_files++] = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if ((num_files == 0) || (context < 0)) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (num_files == 2) {
+        // compared gists must not contain per-trace positions
+        gist.show_line = gist.show_cycle = gist.annotate = false;
+        gist.compare = true;
+    }
+    gist_init_map();
+    for (int i = 0; i < num_files; i++) {
+        if (!reader_open(&sources[i].reader, filenames[i])) {
+            return 2;
+        }
+        sources[i].use_gist = use_gist;
+        sources[i].gist = gist;
+    }
+    int res = (num_files == 1) ? print_trace(&sources[0]) : diff_traces(&sources[0], &sources[1], context);
+    for (int i = 0; i < num_files; i++) {
+        reader_close(&sources[i].reader);
+    }
+    return res;
+}
@@ -0,0 +1,65 @@
+/*
+    trace_format.c
+
+    Converts a binary trace (systems/trace.h) into the `.C:`/`.8:` text
+    format of the C64_ENABLE_DEBUG/C1541_ENABLE_DEBUG traces, which
+    convert_to_canonical_trace.py and gist_trace.py understand.
+
+    Build: make tools (in tests)
+    Usage: trace_format [-c] [FILENAME.trace]
+        -c  print the raw device cycle instead of microseconds
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#define CHIPS_IMPL
+#include "../../systems/trace.h"
+#include "../../systems/disass.h"
+
+#define C64_FREQUENCY (985248)
+#define NUM_RECORDS (4096)
+
+static trace_record_t records[NUM_RECORDS];
+
+int main(int argc, char* argv[]) {
+    const char* filename = NULL;
+    bool raw_cycles = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0) {
+            raw_cycles = true;
+        } else if (!filename && (argv[i][0] != '-')) {
+            filename = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s [-c] [FILENAME.trace]\n", argv[0]);
+            return 1;
+        }
+    }
+    FILE* fp = filename ? fopen(filename, "rb") : stdin;
+    if (!fp) {
+        fprintf(stderr, "Failed to open %s\n", filename);
+        return 1;
+    }
+    if (!trace_read_header(fp)) {
+        fprintf(stderr, "Not a trace file (or wrong version)\n");
+        return 1;
+    }
+    char line[128];
+    size_t num;
+    while ((num = fread(records, sizeof(trace_record_t), NUM_RECORDS, fp)) > 0) {
+        for (size_t i = 0; i < num; i++) {
+            const trace_record_t* r = &records[i];
+            double timestamp = (double)r->cycle;
+            if (!raw_cycles && (r->device == TRACE_DEVICE_C64)) {
+                timestamp = (double)r->cycle * 1000000.0 / C64_FREQUENCY;
+            }
+            _disass_trace_line(line, sizeof(line), (char)r->device, r->pc, r->a, r->x, r->y, r->s, r->p,
+                r->bytes[0], r->bytes[1], r->bytes[2], timestamp);
+            fputs(line, stdout);
+        }
+    }
+    if (fp != stdin) {
+        fclose(fp);
+    }
+    return 0;
+}
@@ -250,15 +250,15 @@ static uint8_t _ui_c64_mem_read(int layer, uint16_t addr, void* user_data) {
         case _UI_C64_MEMLAYER_ROM:
             if ((addr >= 0xA000) && (addr < 0xC000)) {
                 /* BASIC ROM */
-                return c64->rom_basic[addr - 0xA000];
+                return c64->roms.basic[addr - 0xA000];
             }
             else if ((addr >= 0xD000) && (addr < 0xE000)) {
                 /* Character ROM */
-                return c64->rom_char[addr - 0xD000];
+                return c64->roms.chars[addr - 0xD000];
             }
             else if (addr >= 0xE000) {
                 /* Kernal ROM */
-                return c64->rom_kernal[addr - 0xE000];
+                return c64->roms.kernal[addr - 0xE000];
             }
             else {
                 return 0xFF;
@@ -299,7 +299,10 @@ static void _ui_c64_mem_write(int layer, uint16_t addr, uint8_t data, void* user
             c64->ram[addr] = data;
             break;
         case _UI_C64_MEMLAYER_ROM:
-            if ((addr >= 0xA000) && (addr < 0xC000)) {
+            if (c64->roms.basic != c64->rom_basic) {
+                /* shared ROM images are read-only */
+            }
+            else if ((addr >= 0xA000) && (addr < 0xC000)) {
                 /* BASIC ROM */
                 c64->rom_basic[addr - 0xA000] = data;
             }